@@ -542,7 +542,15 @@ public:
     std::vector<SharedValue> sharedValues() const override { return _._sharedValues; }
 
     bool userDefined() const override { return _.userDefined; }
-    IAttribute& setUserDefined(bool userDefined) override { _.userDefined = userDefined; return *this; }
+    IAttribute& setUserDefined(bool userDefined) override
+    {
+        _.userDefined = userDefined;
+
+        if(userDefined)
+            _.flags.set(AttributeFlag::StructureIndependent);
+
+        return *this;
+    }
 
     bool editable() const override;
 
@@ -33,6 +33,7 @@
 #include "attributes/attribute.h"
 
 #include "transform/transformedgraph.h"
+#include "transform/deferredresult.h"
 #include "transform/transforminfo.h"
 #include "transform/transforms/filtertransform.h"
 #include "transform/transforms/edgecontractiontransform.h"
@@ -83,6 +84,7 @@
 #include <map>
 #include <vector>
 #include <utility>
+#include <mutex>
 
 using NodeVisuals = NodeArray<ElementVisual>;
 using EdgeVisuals = EdgeArray<ElementVisual>;
@@ -129,6 +131,10 @@ private:
 
     std::map<QString, Attribute> _attributes;
 
+    std::mutex _deferredResultsMutex;
+    std::vector<std::weak_ptr<IDeferredResult>> _deferredResults;
+    bool _deferredResultsCancelled = false;
+
     struct AttributeIdentity
     {
         QString _name;
@@ -310,7 +316,9 @@ GraphModel::GraphModel(const QString& name, IPlugin* plugin) :
     _->_graphTransformFactories.emplace(tr("Keep Components"),          std::make_unique<FilterTransformFactory>(this, ElementType::Component, true));
     _->_graphTransformFactories.emplace(tr("Contract Edges"),           std::make_unique<EdgeContractionTransformFactory>(this));
     _->_graphTransformFactories.emplace(tr("MCL Cluster"),              std::make_unique<MCLTransformFactory>(this));
+    _->_graphTransformFactories.emplace(tr("MCL Cluster Sweep"),        std::make_unique<MCLSweepTransformFactory>(this));
     _->_graphTransformFactories.emplace(tr("Louvain Cluster"),          std::make_unique<LouvainTransformFactory>(this));
+    _->_graphTransformFactories.emplace(tr("Louvain Cluster Sweep"),    std::make_unique<LouvainSweepTransformFactory>(this));
     _->_graphTransformFactories.emplace(tr("Weighted Louvain Cluster"), std::make_unique<WeightedLouvainTransformFactory>(this));
     _->_graphTransformFactories.emplace(tr("PageRank"),                 std::make_unique<PageRankTransformFactory>(this));
     _->_graphTransformFactories.emplace(tr("Eccentricity"),             std::make_unique<EccentricityTransformFactory>(this));
@@ -337,7 +345,25 @@ GraphModel::GraphModel(const QString& name, IPlugin* plugin) :
 
 GraphModel::~GraphModel() // NOLINT
 {
-    // Only here so that we can have a unique_ptr to GraphModelImpl
+    // Lazy calculations report back to the model from their own threads, so
+    // any that are still outstanding must be stopped before it goes away
+    std::vector<std::shared_ptr<IDeferredResult>> deferredResults;
+
+    {
+        const std::unique_lock<std::mutex> lock(_->_deferredResultsMutex);
+        _->_deferredResultsCancelled = true;
+
+        for(const auto& weakDeferredResult : _->_deferredResults)
+        {
+            if(auto deferredResult = weakDeferredResult.lock())
+                deferredResults.push_back(deferredResult);
+        }
+
+        _->_deferredResults.clear();
+    }
+
+    for(const auto& deferredResult : deferredResults)
+        deferredResult->cancel();
 }
 
 void GraphModel::removeDynamicAttributes()
@@ -485,7 +511,11 @@ QStringList GraphModel::transformsWithMissingParametersSetToDefault(const QStrin
 
 void GraphModel::buildTransforms(const QStringList& transforms, ICommand* command)
 {
-    _->_transformedGraph.clearTransforms();
+    // Transforms whose preceding transforms are unchanged are reused, so that any
+    // results they've retained from their previous application remain available
+    auto previousTransforms = _->_transformedGraph.removeTransforms();
+    size_t numReusable = 0;
+
     _->_transformedGraph.setCommand(command);
     _->_transformInfos.clear();
     for(int index = 0; index < transforms.size(); index++)
@@ -506,7 +536,23 @@ void GraphModel::buildTransforms(const QStringList& transforms, ICommand* comman
             continue;
 
         const auto& factory = _->_graphTransformFactories.at(action);
-        auto graphTransform = factory->create(graphTransformConfig);
+        std::unique_ptr<GraphTransform> graphTransform;
+
+        if(numReusable < previousTransforms.size())
+        {
+            auto& previousTransform = previousTransforms.at(numReusable);
+
+            if(previousTransform->index() == index && previousTransform->config().equals(graphTransformConfig))
+            {
+                graphTransform = std::move(previousTransform);
+                numReusable++;
+            }
+            else
+                numReusable = previousTransforms.size();
+        }
+
+        if(graphTransform == nullptr)
+            graphTransform = factory->create(graphTransformConfig);
 
         Q_ASSERT(graphTransform != nullptr);
         if(graphTransform != nullptr)
@@ -514,6 +560,8 @@ void GraphModel::buildTransforms(const QStringList& transforms, ICommand* comman
             graphTransform->setIndex(index);
             graphTransform->setConfig(graphTransformConfig);
             graphTransform->setRepeating(graphTransformConfig.isFlagSet(QStringLiteral("repeating")));
+            graphTransform->setLazy(factory->supportsLazyEvaluation() &&
+                graphTransformConfig.isFlagSet(QStringLiteral("lazy")));
             graphTransform->setInfo(&_->_transformInfos[index]);
             _->_transformedGraph.addTransform(std::move(graphTransform));
         }
@@ -1357,8 +1405,8 @@ void GraphModel::onAttributesChanged(const QStringList& addedNames, const QStrin
         changed << addedNames << removedNames << changedValuesNames;
         u::removeDuplicates(changed);
 
-        bool transformRebuildRequired =
-            _->_transformedGraph.onAttributeValuesChangedExternally(changed);
+        bool transformRebuildRequired = _->_transformedGraph.onAttributeValuesChangedExternally(
+            changed, _deferredAttributeValuesBecameReady);
 
         bool visualisationRebuildRequired = !u::setIntersection(
             static_cast<const QList<QString>&>(_->_visualisedAttributeNames),
@@ -1369,6 +1417,38 @@ void GraphModel::onAttributesChanged(const QStringList& addedNames, const QStrin
     }
 }
 
+void GraphModel::onDeferredAttributeValuesReady(const QStringList& attributeNames)
+{
+    QMetaObject::invokeMethod(this, [this, attributeNames]
+    {
+        // Any transforms that depend on the attributes will need to be reapplied,
+        // but the transforms that create them remain valid, so flag this
+        _deferredAttributeValuesBecameReady = true;
+        emit attributesChanged({}, {}, attributeNames);
+        _deferredAttributeValuesBecameReady = false;
+    }, Qt::QueuedConnection);
+}
+
+void GraphModel::addDeferredResult(const std::shared_ptr<IDeferredResult>& deferredResult)
+{
+    {
+        const std::unique_lock<std::mutex> lock(_->_deferredResultsMutex);
+
+        if(!_->_deferredResultsCancelled)
+        {
+            std::erase_if(_->_deferredResults, [](const auto& weakDeferredResult)
+            {
+                return weakDeferredResult.expired();
+            });
+
+            _->_deferredResults.push_back(deferredResult);
+            return;
+        }
+    }
+
+    deferredResult->cancel();
+}
+
 AttributeChangesTracker::AttributeChangesTracker(GraphModel* graphModel, bool emitOnDestruct) :
     _graphModel(graphModel), _emitOnDestruct(emitOnDestruct)
 {
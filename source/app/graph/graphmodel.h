@@ -52,6 +52,8 @@ class IPlugin;
 
 struct ElementVisual;
 
+class IDeferredResult;
+
 class TransformInfo;
 class VisualisationInfo;
 
@@ -76,6 +78,7 @@ private:
     bool _visualUpdatesEnabled = false;
 
     std::atomic_bool _transformedGraphIsChanging;
+    bool _deferredAttributeValuesBecameReady = false;
     QString _name;
     IPlugin* _plugin;
 
@@ -125,6 +128,14 @@ public:
     int pluginDataVersion() const;
     QString pluginQmlPath() const;
 
+    // May be called from any thread, when the values of lazily evaluated
+    // attributes, which were previously pending, become available
+    void onDeferredAttributeValuesReady(const QStringList& attributeNames);
+
+    // Registers a lazy calculation that reports back to the model, so that it can
+    // be cancelled before the model is destroyed; may be called from any thread
+    void addDeferredResult(const std::shared_ptr<IDeferredResult>& deferredResult);
+
     bool graphTransformIsValid(const QString& transform) const;
     QStringList transformsWithMissingParametersSetToDefault(const QStringList& transforms) const;
     void buildTransforms(const QStringList& transforms, ICommand* command = nullptr);
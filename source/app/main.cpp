@@ -351,6 +351,8 @@ int start(int argc, char *argv[])
 
     u::definePref(QStringLiteral("misc/autoBackgroundUpdateCheck"),         true);
 
+    u::definePref(QStringLiteral("misc/correlationEdgesMemoryLimit"),       1024);
+
     u::definePref(QStringLiteral("screenshot/width"),                       1920);
     u::definePref(QStringLiteral("screenshot/height"),                      1080);
     u::definePref(QStringLiteral("screenshot/path"),
@@ -0,0 +1,146 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEFERREDRESULT_H
+#define DEFERREDRESULT_H
+
+#include "graph/mutablegraph.h"
+
+#include "shared/utils/cancellable.h"
+#include "shared/utils/thread.h"
+
+#include <QString>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+// Allows an outstanding calculation to be stopped without knowledge of its result type
+class IDeferredResult
+{
+public:
+    virtual ~IDeferredResult() = default;
+
+    // Cancels the calculation, if it is in progress, and waits for it to stop; once this
+    // has returned, the calculation is never started and readyFn is never called
+    virtual void cancel() = 0;
+};
+
+// Postpones an expensive calculation until its result is first requested. Since
+// the graph will likely have changed by then, the calculation is performed against
+// a snapshot of the graph taken at the point of construction. The first request
+// starts the calculation on a thread of its own, and returns immediately; until it
+// completes, there is no result and requesters should treat the values as pending.
+// Once complete, readyFn is called (from the calculating thread), and the result is
+// retained for the lifetime of the object. Destruction cancels any calculation that
+// is still in progress.
+template<typename Result>
+class DeferredResult : public IDeferredResult
+{
+public:
+    using CalculateFn = std::function<Result(MutableGraph&, const Cancellable&)>;
+    using ReadyFn = std::function<void()>;
+
+    DeferredResult(const QString& name, const MutableGraph& graph,
+        CalculateFn calculateFn, ReadyFn readyFn) :
+        _name(name),
+        _graph(std::make_unique<MutableGraph>(graph)),
+        _calculateFn(std::move(calculateFn)),
+        _readyFn(std::move(readyFn))
+    {}
+
+    ~DeferredResult() override
+    {
+        cancel();
+    }
+
+    DeferredResult(const DeferredResult&) = delete;
+    DeferredResult& operator=(const DeferredResult&) = delete;
+
+    // Returns nullptr while the result is pending
+    const Result* result()
+    {
+        std::call_once(_startFlag, [this]
+        {
+            _thread = std::thread([this]
+            {
+                u::setCurrentThreadName(_name);
+
+                auto result = _calculateFn(*_graph, _cancellable);
+
+                _calculateFn = nullptr;
+
+                if(_cancellable.cancelled())
+                    return;
+
+                _result.emplace(std::move(result));
+                _ready = true;
+
+                if(_readyFn != nullptr)
+                    _readyFn();
+            });
+        });
+
+        return _ready ? &*_result : nullptr;
+    }
+
+    bool pending() { return result() == nullptr; }
+
+    void cancel() override
+    {
+        _cancellable.cancel();
+
+        // Prevent the calculation from starting, if it hasn't already
+        std::call_once(_startFlag, []{});
+
+        const std::unique_lock<std::mutex> lock(_joinMutex);
+        if(_thread.joinable())
+            _thread.join();
+    }
+
+private:
+    QString _name;
+
+    // The result may well contain GraphArrays that refer to _graph,
+    // so it must be declared first, in order to be destroyed last
+    std::unique_ptr<MutableGraph> _graph;
+    CalculateFn _calculateFn;
+    ReadyFn _readyFn;
+
+    Cancellable _cancellable;
+    std::once_flag _startFlag;
+    std::thread _thread;
+    std::mutex _joinMutex;
+
+    std::atomic_bool _ready{false};
+    std::optional<Result> _result;
+};
+
+template<typename Result>
+auto makeDeferredResult(const QString& name, const MutableGraph& graph,
+    typename DeferredResult<Result>::CalculateFn calculateFn,
+    typename DeferredResult<Result>::ReadyFn readyFn)
+{
+    return std::make_shared<DeferredResult<Result>>(name, graph,
+        std::move(calculateFn), std::move(readyFn));
+}
+
+#endif // DEFERREDRESULT_H
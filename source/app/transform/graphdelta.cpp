@@ -0,0 +1,112 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "graphdelta.h"
+
+#include "attributes/attribute.h"
+
+#include "shared/utils/container.h"
+
+void GraphDelta::changeAttribute(const QString& attributeName)
+{
+    if(!u::contains(_changedAttributeNames, attributeName))
+        _changedAttributeNames.push_back(attributeName);
+}
+
+bool GraphDelta::empty() const
+{
+    return _addedNodeIds.empty() && _removedNodeIds.empty() &&
+        _addedEdgeIds.empty() && _removedEdgeIds.empty() &&
+        _changedAttributeNames.empty();
+}
+
+bool GraphDelta::attributeChanged(const QString& attributeName) const
+{
+    return u::contains(_changedAttributeNames,
+        Attribute::parseAttributeName(attributeName)._name);
+}
+
+void GraphDelta::clear()
+{
+    _addedNodeIds.clear();
+    _removedNodeIds.clear();
+    _addedEdgeIds.clear();
+    _removedEdgeIds.clear();
+    _changedAttributeNames.clear();
+}
+
+template<typename Set>
+static void propagate(const Set& added, const Set& removed,
+    const Set& previouslyRemoved, const Set& currentlyRemoved,
+    const Set& previouslyAdded, const Set& currentlyAdded,
+    Set& outputAdded, Set& outputRemoved)
+{
+    // Removed from the input, having previously made it to the output
+    for(auto id : removed)
+    {
+        if(!u::contains(previouslyRemoved, id))
+            outputRemoved.insert(id);
+    }
+
+    // Newly removed by the transform, having previously made it to the output
+    for(auto id : currentlyRemoved)
+    {
+        if(!u::contains(previouslyRemoved, id) && !u::contains(added, id))
+            outputRemoved.insert(id);
+    }
+
+    // Added to the input, and not removed by the transform
+    for(auto id : added)
+    {
+        if(!u::contains(currentlyRemoved, id))
+            outputAdded.insert(id);
+    }
+
+    // Previously removed by the transform, but still in the input and no longer removed
+    for(auto id : previouslyRemoved)
+    {
+        if(!u::contains(currentlyRemoved, id) && !u::contains(removed, id))
+            outputAdded.insert(id);
+    }
+
+    // Elements the transform adds are created anew on each application, so whatever it
+    // added previously is gone, and whatever it adds now is new; where an ID appears in
+    // both, it's a replacement, as far as downstream transforms are concerned
+    outputRemoved.insert(previouslyAdded.begin(), previouslyAdded.end());
+    outputAdded.insert(currentlyAdded.begin(), currentlyAdded.end());
+}
+
+GraphDelta GraphDelta::propagatedThrough(const TransformChanges& previousChanges,
+    const TransformChanges& currentChanges) const
+{
+    GraphDelta outputDelta;
+
+    propagate(_addedNodeIds, _removedNodeIds,
+        previousChanges._removed._nodeIds, currentChanges._removed._nodeIds,
+        previousChanges._added._nodeIds, currentChanges._added._nodeIds,
+        outputDelta._addedNodeIds, outputDelta._removedNodeIds);
+
+    propagate(_addedEdgeIds, _removedEdgeIds,
+        previousChanges._removed._edgeIds, currentChanges._removed._edgeIds,
+        previousChanges._added._edgeIds, currentChanges._added._edgeIds,
+        outputDelta._addedEdgeIds, outputDelta._removedEdgeIds);
+
+    outputDelta._changedAttributeNames = _changedAttributeNames;
+
+    return outputDelta;
+}
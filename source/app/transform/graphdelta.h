@@ -0,0 +1,85 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GRAPHDELTA_H
+#define GRAPHDELTA_H
+
+#include "shared/graph/elementid.h"
+#include "shared/graph/elementid_containers.h"
+
+#include <QString>
+
+#include <vector>
+
+struct ElementIds
+{
+    NodeIdSet _nodeIds;
+    EdgeIdSet _edgeIds;
+};
+
+// The elements removed from and added to the graph by the application of a transform
+struct TransformChanges
+{
+    ElementIds _removed;
+    ElementIds _added;
+};
+
+// Describes the changes that have been made to a graph since some earlier point;
+// an element ID that appears as both added and removed refers to an element that
+// was removed, and then replaced by a different element with the same ID
+class GraphDelta
+{
+public:
+    NodeIdSet _addedNodeIds;
+    NodeIdSet _removedNodeIds;
+    EdgeIdSet _addedEdgeIds;
+    EdgeIdSet _removedEdgeIds;
+
+    std::vector<QString> _changedAttributeNames;
+
+    void addNode(NodeId nodeId) { _addedNodeIds.insert(nodeId); }
+    void removeNode(NodeId nodeId) { remove(_addedNodeIds, _removedNodeIds, nodeId); }
+    void addEdge(EdgeId edgeId) { _addedEdgeIds.insert(edgeId); }
+    void removeEdge(EdgeId edgeId) { remove(_addedEdgeIds, _removedEdgeIds, edgeId); }
+    void changeAttribute(const QString& attributeName);
+
+    bool empty() const;
+    bool hasAdditions() const { return !_addedNodeIds.empty() || !_addedEdgeIds.empty(); }
+    bool attributeChanged(const QString& attributeName) const;
+
+    void clear();
+
+    // Given the changes to the input of a transform and the elements it removed and
+    // added, both previously and currently, determine the changes to its output
+    GraphDelta propagatedThrough(const TransformChanges& previousChanges,
+        const TransformChanges& currentChanges) const;
+
+private:
+    template<typename Set, typename Id>
+    static void remove(Set& added, Set& removed, Id id)
+    {
+        // If the element was added after the delta began, it's as if it never existed,
+        // unless it was a replacement for an element that existed previously
+        if(added.erase(id) > 0)
+            return;
+
+        removed.insert(id);
+    }
+};
+
+#endif // GRAPHDELTA_H
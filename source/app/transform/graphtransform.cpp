@@ -87,6 +87,49 @@ bool GraphTransform::applyAndUpdate(TransformedGraph& target, const GraphModel&
     return anyChange;
 }
 
+bool GraphTransform::applyDeltaAndUpdate(TransformedGraph& target, const GraphModel& graphModel,
+    const GraphDelta& delta, bool& graphChanged) const
+{
+    // A repeating transform's result depends on its own output, which a delta doesn't describe
+    if(repeating() || !_previousChanges)
+        return false;
+
+    target.resetChangeOccurred({});
+    target.clearPhase();
+
+    auto attributeNames = config().referencedAttributeNames();
+
+    // Let the full application report any problems with attributes
+    if(std::any_of(attributeNames.begin(), attributeNames.end(),
+        [&graphModel](const auto& attributeName) { return !graphModel.attributeIsValid(attributeName); }))
+    {
+        return false;
+    }
+
+    if(!applyDelta(target, delta))
+        return false;
+
+    target.update();
+    graphChanged = target.changeOccurred({});
+
+    return true;
+}
+
+bool GraphTransform::attributesUnchangedBy(const std::vector<QString>& attributeNames,
+    const GraphModel& graphModel, const GraphDelta& delta) const
+{
+    return std::all_of(attributeNames.begin(), attributeNames.end(),
+    [&graphModel, &delta](const auto& attributeName)
+    {
+        if(!graphModel.attributeExists(attributeName) || delta.attributeChanged(attributeName))
+            return false;
+
+        // Other attributes may be a function of the graph structure
+        // (e.g. degree), so could change even if they haven't been recreated
+        return graphModel.attributeValueByName(attributeName).testFlag(AttributeFlag::StructureIndependent);
+    });
+}
+
 QString GraphTransformFactory::image() const
 {
     if(category() == QObject::tr("Attributes"))
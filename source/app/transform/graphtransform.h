@@ -28,6 +28,7 @@
 #include "shared/utils/cancellable.h"
 
 #include "transforminfo.h"
+#include "graphdelta.h"
 #include "graphtransformattributeparameter.h"
 #include "graphtransformparameter.h"
 #include "graphtransformconfig.h"
@@ -36,6 +37,7 @@
 
 #include <vector>
 #include <memory>
+#include <optional>
 
 class Graph;
 class GraphComponent;
@@ -46,6 +48,7 @@ class Attribute;
 class GraphTransform : public Cancellable
 {
     friend class GraphModel;
+    friend class TransformedGraph;
 
 public:
     GraphTransform() = default;
@@ -54,9 +57,26 @@ public:
     virtual void apply(TransformedGraph&) const {}
     bool applyAndUpdate(TransformedGraph& target, const GraphModel& graphModel) const;
 
+    // Transforms may optionally bring the result of their previous application up to
+    // date incrementally, given target, which is the new input, and delta, which
+    // describes how it differs from the previous input; if this is not possible, false
+    // is returned and the transform will be fully reapplied instead
+    virtual bool applyDelta(TransformedGraph&, const GraphDelta&) const { return false; }
+    bool applyDeltaAndUpdate(TransformedGraph& target, const GraphModel& graphModel,
+        const GraphDelta& delta, bool& graphChanged) const;
+
+    // Transforms that alter existing elements, rather than only adding or removing
+    // them (e.g. contraction), produce output that a delta can't describe
+    virtual bool modifiesElements() const { return false; }
+
     bool repeating() const { return _repeating; }
     void setRepeating(bool repeating) { _repeating = repeating; }
 
+    // A lazy transform defers its calculation until
+    // the attributes it creates are first accessed
+    bool lazy() const { return _lazy; }
+    void setLazy(bool lazy) { _lazy = lazy; }
+
     template<typename... Args>
     void addAlert(Args&&... args) const
     {
@@ -64,6 +84,12 @@ public:
             _info->addAlert(std::forward<Args>(args)...);
     }
 
+    void setStatistics(const TransformStatistics& statistics) const
+    {
+        if(_info != nullptr)
+            _info->setStatistics(statistics);
+    }
+
     const TransformInfo* info() const { return _info; }
     void setInfo(TransformInfo* info) { _info = info; }
 
@@ -73,6 +99,18 @@ public:
     // Specifically, it is not a means to reconfigure an existing transform
     const GraphTransformConfig& config() const { return _config; }
 
+protected:
+    // The elements removed from the graph by the previous application of the transform
+    const ElementIds* previouslyRemoved() const
+    {
+        return _previousChanges ? &_previousChanges->_removed : nullptr;
+    }
+
+    // True if none of the given attributes' values could have changed since the transform
+    // was last applied, i.e. they are independent of structure and unaffected by delta
+    bool attributesUnchangedBy(const std::vector<QString>& attributeNames,
+        const GraphModel& graphModel, const GraphDelta& delta) const;
+
 private:
     void setIndex(int index) { _index = index; }
     void setConfig(const GraphTransformConfig& config) { _config = config; }
@@ -80,8 +118,13 @@ private:
 private:
     mutable TransformInfo* _info = nullptr;
     bool _repeating = false;
+    bool _lazy = false;
     int _index = -1;
     GraphTransformConfig _config;
+
+    // Set if the previous application of the transform did nothing besides add and remove
+    // elements, in which case its output can be described purely in terms of its input
+    mutable std::optional<TransformChanges> _previousChanges;
 };
 
 struct DefaultVisualisation
@@ -116,6 +159,7 @@ public:
     virtual GraphTransformAttributeParameters attributeParameters() const { return {}; }
     GraphTransformAttributeParameter attributeParameter(const QString& parameterName) const;
     virtual bool requiresCondition() const { return false; }
+    virtual bool supportsLazyEvaluation() const { return false; }
     virtual GraphTransformParameters parameters() const { return {}; }
     GraphTransformParameter parameter(const QString& parameterName) const;
     virtual DefaultVisualisations defaultVisualisations() const { return {}; }
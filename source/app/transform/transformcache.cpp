@@ -76,12 +76,13 @@ void TransformCache::add(TransformCache::Result&& result)
     _cache.back().emplace_back(std::move(result));
 }
 
-void TransformCache::attributeAddedOrChanged(const QString& attributeName)
+void TransformCache::attributeAddedOrChanged(const QString& attributeName, bool onlyValuesChanged)
 {
     // When an attribute is added its values may differ to previous incarnations, so
     // invalidate any subsequent entries that depend on it
     // Furthermore, if any entries are /creating/ the same attribute that we're adding,
-    // invalidate those too as their names will need to be regenerated
+    // invalidate those too as their names will need to be regenerated, unless it's
+    // only the values that have changed, in which case the creating entry still holds
     auto resultSetIt = _cache.begin();
     auto resultSetEnd = _cache.end();
     for(; resultSetIt != resultSetEnd; ++resultSetIt)
@@ -98,7 +99,7 @@ void TransformCache::attributeAddedOrChanged(const QString& attributeName)
             }
 
             // Creates attributeName
-            if(u::contains(resultIt->_newAttributes, attributeName))
+            if(!onlyValuesChanged && u::contains(resultIt->_newAttributes, attributeName))
             {
                 resultSetIt->erase(resultIt, resultEnd);
                 break;
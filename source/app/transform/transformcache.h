@@ -96,7 +96,7 @@ public:
     bool empty() const { return _cache.empty(); }
     void clear() { _cache.clear(); }
     void add(Result&& result);
-    void attributeAddedOrChanged(const QString& attributeName);
+    void attributeAddedOrChanged(const QString& attributeName, bool onlyValuesChanged = false);
     Result apply(int index, const GraphTransformConfig& config, TransformedGraph& graph);
 
     const MutableGraph* graph() const;
@@ -25,8 +25,12 @@
 #include "shared/utils/container.h"
 #include "shared/utils/container_combine.h"
 #include "shared/utils/string.h"
+#include "shared/utils/resourceusage.h"
+
+#include <QElapsedTimer>
 
 #include <functional>
+#include <algorithm>
 
 TransformedGraph::TransformedGraph(GraphModel& graphModel, const MutableGraph& source) :
     _graphModel(&graphModel),
@@ -50,15 +54,73 @@ TransformedGraph::TransformedGraph(GraphModel& graphModel, const MutableGraph& s
 
     // These connections allow us to track what changes, so we can then
     // re-emit a canonical set of signals once the transform is complete
-    connect(_source, &Graph::nodeRemoved,  [this](const Graph*, NodeId nodeId) { _nodesState[nodeId].remove(); });
-    connect(_source, &Graph::nodeAdded,    [this](const Graph*, NodeId nodeId) { _nodesState[nodeId].add(); });
-    connect(_source, &Graph::edgeRemoved,  [this](const Graph*, EdgeId edgeId) { _edgesState[edgeId].remove(); });
-    connect(_source, &Graph::edgeAdded,    [this](const Graph*, EdgeId edgeId) { _edgesState[edgeId].add(); });
+    connect(_source, &Graph::nodeRemoved,  [this](const Graph*, NodeId nodeId)
+    {
+        _nodesState[nodeId].remove();
+
+        if(_trackingDelta)
+            _pendingDelta.removeNode(nodeId);
+    });
+
+    connect(_source, &Graph::nodeAdded,    [this](const Graph*, NodeId nodeId)
+    {
+        _nodesState[nodeId].add();
+
+        if(_trackingDelta)
+            _pendingDelta.addNode(nodeId);
+    });
+
+    connect(_source, &Graph::edgeRemoved,  [this](const Graph*, EdgeId edgeId)
+    {
+        _edgesState[edgeId].remove();
+
+        if(_trackingDelta)
+            _pendingDelta.removeEdge(edgeId);
+    });
+
+    connect(_source, &Graph::edgeAdded,    [this](const Graph*, EdgeId edgeId)
+    {
+        _edgesState[edgeId].add();
 
-    connect(&_target, &Graph::nodeRemoved, [this](const Graph*, NodeId nodeId) { _nodesState[nodeId].remove(); });
-    connect(&_target, &Graph::nodeAdded,   [this](const Graph*, NodeId nodeId) { _nodesState[nodeId].add(); });
-    connect(&_target, &Graph::edgeRemoved, [this](const Graph*, EdgeId edgeId) { _edgesState[edgeId].remove(); });
-    connect(&_target, &Graph::edgeAdded,   [this](const Graph*, EdgeId edgeId) { _edgesState[edgeId].add(); });
+        if(_trackingDelta)
+            _pendingDelta.addEdge(edgeId);
+    });
+
+    connect(&_target, &Graph::nodeRemoved, [this](const Graph*, NodeId nodeId)
+    {
+        _nodesState[nodeId].remove();
+        _numNodesRemoved++;
+
+        if(_recordingTransformChanges)
+            _transformChanges._removed._nodeIds.insert(nodeId);
+    });
+
+    connect(&_target, &Graph::nodeAdded,   [this](const Graph*, NodeId nodeId)
+    {
+        _nodesState[nodeId].add();
+        _numNodesAdded++;
+
+        if(_recordingTransformChanges)
+            _transformChanges._added._nodeIds.insert(nodeId);
+    });
+
+    connect(&_target, &Graph::edgeRemoved, [this](const Graph*, EdgeId edgeId)
+    {
+        _edgesState[edgeId].remove();
+        _numEdgesRemoved++;
+
+        if(_recordingTransformChanges)
+            _transformChanges._removed._edgeIds.insert(edgeId);
+    });
+
+    connect(&_target, &Graph::edgeAdded,   [this](const Graph*, EdgeId edgeId)
+    {
+        _edgesState[edgeId].add();
+        _numEdgesAdded++;
+
+        if(_recordingTransformChanges)
+            _transformChanges._added._edgeIds.insert(edgeId);
+    });
 
     addTransform(std::make_unique<IdentityTransform>());
 }
@@ -72,7 +134,8 @@ void TransformedGraph::cancelRebuild()
         _currentTransform->cancel();
 }
 
-bool TransformedGraph::onAttributeValuesChangedExternally(const QStringList& changedAttributeNames)
+bool TransformedGraph::onAttributeValuesChangedExternally(const QStringList& changedAttributeNames,
+    bool onlyValuesChanged)
 {
     std::vector<QString> referencedAttributeNames;
 
@@ -85,6 +148,12 @@ bool TransformedGraph::onAttributeValuesChangedExternally(const QStringList& cha
 
     u::removeDuplicates(referencedAttributeNames);
 
+    if(_trackingDelta)
+    {
+        for(const auto& attributeName : changedAttributeNames)
+            _pendingDelta.changeAttribute(attributeName);
+    }
+
     auto affectedAttributeNames = u::setIntersection(referencedAttributeNames,
         u::toQStringVector(changedAttributeNames));
 
@@ -93,7 +162,7 @@ bool TransformedGraph::onAttributeValuesChangedExternally(const QStringList& cha
 
     // Invalidate any cache entries affected by the changing attributes
     for(const auto& attributeName : affectedAttributeNames)
-        _cache.attributeAddedOrChanged(attributeName);
+        _cache.attributeAddedOrChanged(attributeName, onlyValuesChanged);
 
     return true;
 }
@@ -133,6 +202,139 @@ std::vector<QString> TransformedGraph::createdAttributeNamesAtTransformIndex(int
     return {};
 }
 
+void TransformedGraph::resetChangeCounts()
+{
+    _numNodesAdded = 0;
+    _numNodesRemoved = 0;
+    _numEdgesAdded = 0;
+    _numEdgesRemoved = 0;
+}
+
+bool TransformedGraph::revertTargetToSource(const GraphDelta& sourceDelta)
+{
+    // Reverting is only possible if each transform has recorded what it did to the target
+    if(!_targetIsOutput || !std::all_of(_transforms.begin(), _transforms.end(),
+        [](const auto& transform) { return transform->_previousChanges.has_value(); }))
+    {
+        return false;
+    }
+
+    // Elements not mentioned here were unaffected by both the source changes and
+    // the transforms, so are already the same in the target as they are in the source
+    NodeIdSet nodeIds(sourceDelta._addedNodeIds.begin(), sourceDelta._addedNodeIds.end());
+    nodeIds.insert(sourceDelta._removedNodeIds.begin(), sourceDelta._removedNodeIds.end());
+    EdgeIdSet edgeIds(sourceDelta._addedEdgeIds.begin(), sourceDelta._addedEdgeIds.end());
+    edgeIds.insert(sourceDelta._removedEdgeIds.begin(), sourceDelta._removedEdgeIds.end());
+
+    NodeIdSet transformAddedNodeIds;
+    EdgeIdSet transformAddedEdgeIds;
+
+    for(const auto& transform : _transforms)
+    {
+        const auto& changes = *transform->_previousChanges;
+
+        nodeIds.insert(changes._removed._nodeIds.begin(), changes._removed._nodeIds.end());
+        edgeIds.insert(changes._removed._edgeIds.begin(), changes._removed._edgeIds.end());
+        transformAddedNodeIds.insert(changes._added._nodeIds.begin(), changes._added._nodeIds.end());
+        transformAddedEdgeIds.insert(changes._added._edgeIds.begin(), changes._added._edgeIds.end());
+    }
+
+    nodeIds.insert(transformAddedNodeIds.begin(), transformAddedNodeIds.end());
+    edgeIds.insert(transformAddedEdgeIds.begin(), transformAddedEdgeIds.end());
+
+    // Adding elements individually is several times the cost of copying them in bulk, so
+    // when the transforms have removed a large part of the graph (e.g. k-NN), copying wins
+    const size_t RelativeCost = 4;
+    if((nodeIds.size() + edgeIds.size()) * RelativeCost >
+        static_cast<size_t>(_source->numNodes() + _source->numEdges()))
+    {
+        return false;
+    }
+
+    // Elements which have been replaced in the source, or are not from the source at all
+    auto isStale = [](auto elementId, const auto& transformAddedIds,
+        const auto& sourceAddedIds, bool inSource)
+    {
+        return !inSource || u::contains(transformAddedIds, elementId) ||
+            u::contains(sourceAddedIds, elementId);
+    };
+
+    for(auto edgeId : edgeIds)
+    {
+        if(_target.containsEdgeId(edgeId) && isStale(edgeId, transformAddedEdgeIds,
+            sourceDelta._addedEdgeIds, _source->containsEdgeId(edgeId)))
+        {
+            _target.removeEdge(edgeId);
+        }
+    }
+
+    for(auto nodeId : nodeIds)
+    {
+        if(_target.containsNodeId(nodeId) && isStale(nodeId, transformAddedNodeIds,
+            sourceDelta._addedNodeIds, _source->containsNodeId(nodeId)))
+        {
+            _target.removeNode(nodeId);
+        }
+    }
+
+    reserve(*_source);
+
+    for(auto nodeId : nodeIds)
+    {
+        if(_source->containsNodeId(nodeId) && !_target.containsNodeId(nodeId))
+            _target.addNode(nodeId);
+    }
+
+    for(auto edgeId : edgeIds)
+    {
+        if(_source->containsEdgeId(edgeId) && !_target.containsEdgeId(edgeId))
+        {
+            const auto& edge = _source->edgeById(edgeId);
+            _target.addEdge(edgeId, edge.sourceId(), edge.targetId());
+        }
+    }
+
+    return true;
+}
+
+class TransformStatisticsRecorder
+{
+private:
+    QElapsedTimer _elapsedTimer;
+    int64_t _initialProcessCpuTime = u::processCpuTime();
+    uint64_t _initialMemoryUsage = u::currentMemoryUsage();
+    uint64_t _initialPeakMemoryUsage = u::peakMemoryUsage();
+
+public:
+    TransformStatisticsRecorder() { _elapsedTimer.start(); }
+
+    TransformStatistics finish(bool cacheHit, int nodesAdded, int nodesRemoved,
+        int edgesAdded, int edgesRemoved) const
+    {
+        TransformStatistics statistics;
+
+        statistics._cacheHit = cacheHit;
+        statistics._wallTime = _elapsedTimer.nsecsElapsed();
+        statistics._processCpuTime = std::max(u::processCpuTime() - _initialProcessCpuTime, int64_t{0});
+
+        // If the process' high water mark has been exceeded, we know the
+        // transform's peak; otherwise, all we have is the net growth
+        auto peakMemoryUsage = u::peakMemoryUsage();
+        auto memoryUsage = peakMemoryUsage > _initialPeakMemoryUsage ?
+            peakMemoryUsage : u::currentMemoryUsage();
+
+        statistics._peakAdditionalMemory = memoryUsage > _initialMemoryUsage ?
+            memoryUsage - _initialMemoryUsage : 0;
+
+        statistics._nodesAdded = nodesAdded;
+        statistics._nodesRemoved = nodesRemoved;
+        statistics._edgesAdded = edgesAdded;
+        statistics._edgesRemoved = edgesRemoved;
+
+        return statistics;
+    }
+};
+
 void TransformedGraph::rebuild()
 {
     if(!_autoRebuild)
@@ -156,7 +358,15 @@ void TransformedGraph::rebuild()
 
         TransformCache newCache(*_graphModel);
         CreatedAttributeNamesMap newCreatedAttributeNames;
-        *this = *_source;
+
+        // The changes to the source since the last rebuild, which, for as long as
+        // each transform can account for them, are propagated down the pipeline
+        auto delta = std::exchange(_pendingDelta, {});
+        bool deltaIsValid = _trackingDelta;
+
+        if(!deltaIsValid || !revertTargetToSource(delta))
+            *this = *_source;
+
         _target.update();
 
         // Save previous state in case we get cancelled
@@ -170,12 +380,18 @@ void TransformedGraph::rebuild()
         {
             setProgress(-1); // Indeterminate by default
 
+            TransformStatisticsRecorder statisticsRecorder;
+            resetChangeCounts();
+
             TransformCache::Result result;
             result._config = transform->config();
 
             result = _cache.apply(transform->index(), result._config, *this);
             if(result.wasApplied())
             {
+                transform->setStatistics(statisticsRecorder.finish(true,
+                    _numNodesAdded, _numNodesRemoved, _numEdgesAdded, _numEdgesRemoved));
+
                 auto newAttributeNames = u::keysFor(result._newAttributes);
                 auto changedAttributeNames = u::keysFor(result._changedAttributes);
 
@@ -184,6 +400,8 @@ void TransformedGraph::rebuild()
 
                 newCreatedAttributeNames[transform->index()] = newAttributeNames;
                 newCache.add(std::move(result));
+
+                // The input is unchanged, so the delta passes through untouched
                 continue;
             }
 
@@ -192,7 +410,19 @@ void TransformedGraph::rebuild()
             setCurrentTransform(transform.get());
             transform->uncancel();
 
-            if(transform->applyAndUpdate(*this, *_graphModel))
+            _transformChanges = {};
+            _recordingTransformChanges = true;
+
+            bool graphChanged = false;
+            bool deltaApplied = deltaIsValid &&
+                transform->applyDeltaAndUpdate(*this, *_graphModel, delta, graphChanged);
+
+            if(!deltaApplied)
+                graphChanged = transform->applyAndUpdate(*this, *_graphModel);
+
+            _recordingTransformChanges = false;
+
+            if(graphChanged)
             {
                 result._graph = std::make_unique<MutableGraph>(_target);
 
@@ -205,6 +435,25 @@ void TransformedGraph::rebuild()
             if(_cancelled)
                 break;
 
+            if(!transform->modifiesElements())
+            {
+                if(deltaIsValid && transform->_previousChanges)
+                    delta = delta.propagatedThrough(*transform->_previousChanges, _transformChanges);
+                else
+                    deltaIsValid = false;
+
+                transform->_previousChanges = std::move(_transformChanges);
+            }
+            else
+            {
+                // The output of transforms that alter elements can't be described relative to their input
+                transform->_previousChanges.reset();
+                deltaIsValid = false;
+            }
+
+            transform->setStatistics(statisticsRecorder.finish(false,
+                _numNodesAdded, _numNodesRemoved, _numEdgesAdded, _numEdgesRemoved));
+
             const auto& addedAttributeNames = tracker.added();
             const auto& changedAttributeNames = tracker.changed();
             const auto& addedOrChangedAttributeNames = tracker.addedOrChanged();
@@ -219,6 +468,7 @@ void TransformedGraph::rebuild()
             {
                 _cache.attributeAddedOrChanged(attributeName);
                 updatedAttributeNames.append(attributeName);
+                delta.changeAttribute(attributeName);
             }
 
             result._index = transform->index();
@@ -232,6 +482,11 @@ void TransformedGraph::rebuild()
 
         if(_cancelled)
         {
+            // The transforms' previous results no longer reflect the state of
+            // the graph, so the next rebuild must be done from scratch
+            for(auto& transform : _transforms)
+                transform->_previousChanges.reset();
+
             // We've been cancelled so rollback to our previous state
             _cache = std::move(oldCache);
             _createdAttributeNames = std::move(oldCreatedAttributeNames);
@@ -252,6 +507,12 @@ void TransformedGraph::rebuild()
             _cache = std::move(newCache);
             _createdAttributeNames = std::move(newCreatedAttributeNames);
         }
+
+        // Only bother tracking changes if a subsequent rebuild can make use of them
+        _trackingDelta = std::any_of(_transforms.begin(), _transforms.end(),
+            [](const auto& transform) { return transform->_previousChanges.has_value(); });
+
+        _targetIsOutput = !_cancelled;
     });
 
     emit attributeValuesChanged(updatedAttributeNames);
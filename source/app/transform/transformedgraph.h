@@ -37,6 +37,7 @@
 #include <functional>
 #include <atomic>
 #include <mutex>
+#include <utility>
 
 class GraphModel;
 class ICommand;
@@ -50,11 +51,13 @@ public:
 
     void enableAutoRebuild() { _autoRebuild = true; rebuild(); }
     void cancelRebuild();
-    void addTransform(std::unique_ptr<GraphTransform> t) { _transforms.emplace_back(std::move(t)); }
-    void clearTransforms() { _transforms.clear(); }
+    void addTransform(std::unique_ptr<GraphTransform> t) { _transforms.emplace_back(std::move(t)); _targetIsOutput = false; }
+    void clearTransforms() { _transforms.clear(); _targetIsOutput = false; }
+    std::vector<std::unique_ptr<GraphTransform>> removeTransforms() { _targetIsOutput = false; return std::exchange(_transforms, {}); }
     int numTransforms() const { return static_cast<int>(_transforms.size()); }
 
-    bool onAttributeValuesChangedExternally(const QStringList& changedAttributeNames);
+    bool onAttributeValuesChangedExternally(const QStringList& changedAttributeNames,
+        bool onlyValuesChanged = false);
 
     void setCommand(ICommand* command) { _command = command; }
 
@@ -146,6 +149,27 @@ private:
     NodeArray<State> _previousNodesState;
     EdgeArray<State> _previousEdgesState;
 
+    // Counts of changes made to the target, reset before each transform is applied
+    int _numNodesAdded = 0;
+    int _numNodesRemoved = 0;
+    int _numEdgesAdded = 0;
+    int _numEdgesRemoved = 0;
+
+    void resetChangeCounts();
+
+    // Changes made to the source since the last rebuild; only tracked when there
+    // are transforms that are able to make use of them
+    GraphDelta _pendingDelta;
+    bool _trackingDelta = false;
+
+    // The elements removed from and added to the target by the transform currently being applied
+    TransformChanges _transformChanges;
+    bool _recordingTransformChanges = false;
+
+    // Set when the target is the output of a complete application of the current transforms
+    bool _targetIsOutput = false;
+
+    bool revertTargetToSource(const GraphDelta& sourceDelta);
     void rebuild();
 
     void setCurrentTransform(GraphTransform* currentTransform);
@@ -22,12 +22,38 @@
 #include "ui/alert.h"
 
 #include <vector>
+#include <map>
+#include <cstdint>
+
+struct TransformStatistics
+{
+    // True if the result came from the TransformCache, rather than the transform itself
+    bool _cacheHit = false;
+
+    int64_t _wallTime = 0; // ns
+    // CPU time consumed by the whole process while the transform ran, so this includes
+    // anything else that happened concurrently, such as the UI or other calculations
+    int64_t _processCpuTime = 0; // ns
+
+    // Growth in resident memory over the course of the transform; note that
+    // this is a lower bound, since the process' previous high water mark can
+    // mask transient allocations
+    uint64_t _peakAdditionalMemory = 0; // bytes
+
+    int _nodesAdded = 0;
+    int _nodesRemoved = 0;
+    int _edgesAdded = 0;
+    int _edgesRemoved = 0;
+};
 
 class TransformInfo
 {
 private:
     std::vector<Alert> _alerts;
 
+    bool _hasStatistics = false;
+    TransformStatistics _statistics;
+
 public:
     template<typename... Args>
     void addAlert(Args&&... args)
@@ -36,6 +62,15 @@ public:
     }
 
     auto alerts() const { return _alerts; }
+
+    void setStatistics(const TransformStatistics& statistics)
+    {
+        _statistics = statistics;
+        _hasStatistics = true;
+    }
+
+    bool hasStatistics() const { return _hasStatistics; }
+    const TransformStatistics& statistics() const { return _statistics; }
 };
 
 using TransformInfosMap = std::map<int, TransformInfo>;
@@ -24,6 +24,10 @@
 #include "shared/utils/typeidentity.h"
 
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
 
 #include <QObject>
 #include <QRegularExpression>
@@ -44,10 +48,73 @@ static Alert attributeSynthesisTransformConfigIsValid(const GraphTransformConfig
     return {AlertType::None, {}};
 }
 
+template<typename ElementIds, typename Values>
+static void synthesiseValues(const Attribute& sourceAttribute, const QRegularExpression& regex,
+    const QString& attributeValue, const ElementIds& elementIds, Values& newValues)
+{
+    for(auto elementId : elementIds)
+    {
+        QString value = sourceAttribute.stringValueOf(elementId);
+
+        auto match = regex.match(value); // clazy:exclude=use-static-qregularexpression
+        newValues[elementId] = match.hasMatch() ?
+            value.replace(regex, attributeValue) : QString(); // clazy:exclude=use-static-qregularexpression
+    }
+}
+
+template<typename ElementIds, typename Values>
+static void createSynthesisedAttribute(GraphModel& graphModel, const TransformedGraph& target,
+    const QString& newAttributeName, const ElementIds& elementIds, const Values& newValues)
+{
+    using E = typename ElementIds::value_type;
+
+    TypeIdentity typeIdentity;
+
+    for(auto elementId : elementIds)
+        typeIdentity.updateType(newValues[elementId]);
+
+    auto& attribute = graphModel.createAttribute(newAttributeName)
+        .setDescription(QObject::tr("An attribute synthesised by the Attribute Synthesis transform."));
+
+    switch(typeIdentity.type())
+    {
+    default:
+    case TypeIdentity::Type::String:
+    case TypeIdentity::Type::Unknown:
+        attribute.setStringValueFn([newValues](E elementId) { return newValues[elementId]; })
+            .setFlag(AttributeFlag::FindShared)
+            .setFlag(AttributeFlag::Searchable);
+        break;
+
+    case TypeIdentity::Type::Int:
+    {
+        ElementIdArray<E, int> newIntValues(target);
+        for(auto elementId : elementIds)
+            newIntValues[elementId] = newValues[elementId].toInt();
+
+        attribute.setIntValueFn([newIntValues](E elementId) { return newIntValues[elementId]; });
+        break;
+    }
+
+    case TypeIdentity::Type::Float:
+    {
+        ElementIdArray<E, double> newFloatValues(target);
+        for(auto elementId : elementIds)
+            newFloatValues[elementId] = newValues[elementId].toDouble();
+
+        attribute.setFloatValueFn([newFloatValues](E elementId) { return newFloatValues[elementId]; });
+        break;
+    }
+    }
+}
+
 void AttributeSynthesisTransform::apply(TransformedGraph& target) const
 {
     target.setPhase(QObject::tr("Attribute Synthesis"));
 
+    _nodeValues.reset();
+    _edgeValues.reset();
+
     auto alert = attributeSynthesisTransformConfigIsValid(config());
     if(alert._type != AlertType::None)
     {
@@ -61,65 +128,69 @@ void AttributeSynthesisTransform::apply(TransformedGraph& target) const
     QRegularExpression regex(config().parameterByName(QStringLiteral("Regular Expression"))->valueAsString());
     auto attributeValue = config().parameterByName(QStringLiteral("Attribute Value"))->valueAsString();
 
-    auto synthesise =
-    [&](const auto& elementIds)
+    if(sourceAttribute.elementType() == ElementType::Node)
     {
-        using E = typename std::remove_reference<decltype(elementIds)>::type::value_type;
+        NodeArray<QString> newValues(target);
+        synthesiseValues(sourceAttribute, regex, attributeValue, target.nodeIds(), newValues);
+        createSynthesisedAttribute(*_graphModel, target, newAttributeName, target.nodeIds(), newValues);
+        _nodeValues = newValues;
+    }
+    else if(sourceAttribute.elementType() == ElementType::Edge)
+    {
+        EdgeArray<QString> newValues(target);
+        synthesiseValues(sourceAttribute, regex, attributeValue, target.edgeIds(), newValues);
+        createSynthesisedAttribute(*_graphModel, target, newAttributeName, target.edgeIds(), newValues);
+        _edgeValues = newValues;
+    }
+}
 
-        ElementIdArray<E, QString> newValues(target);
-        TypeIdentity typeIdentity;
+bool AttributeSynthesisTransform::applyDelta(TransformedGraph& target, const GraphDelta& delta) const
+{
+    if(attributeSynthesisTransformConfigIsValid(config())._type != AlertType::None)
+        return false;
 
-        for(auto elementId : elementIds)
-        {
-            QString value = sourceAttribute.stringValueOf(elementId);
-
-            auto match = regex.match(value); // clazy:exclude=use-static-qregularexpression
-            if(match.hasMatch())
-            {
-                newValues[elementId] = value.replace(regex, attributeValue); // clazy:exclude=use-static-qregularexpression
-                typeIdentity.updateType(newValues[elementId]);
-            }
-        }
-
-        auto& attribute = _graphModel->createAttribute(newAttributeName)
-            .setDescription(QObject::tr("An attribute synthesised by the Attribute Synthesis transform."));
-
-        switch(typeIdentity.type())
-        {
-        default:
-        case TypeIdentity::Type::String:
-        case TypeIdentity::Type::Unknown:
-            attribute.setStringValueFn([newValues](E elementId) { return newValues[elementId]; })
-                .setFlag(AttributeFlag::FindShared)
-                .setFlag(AttributeFlag::Searchable);
-            break;
-
-        case TypeIdentity::Type::Int:
-        {
-            ElementIdArray<E, int> newIntValues(target);
-            for(auto elementId : elementIds)
-                newIntValues[elementId] = newValues[elementId].toInt();
-
-            attribute.setIntValueFn([newIntValues](E elementId) { return newIntValues[elementId]; });
-            break;
-        }
-
-        case TypeIdentity::Type::Float:
-        {
-            ElementIdArray<E, double> newFloatValues(target);
-            for(auto elementId : elementIds)
-                newFloatValues[elementId] = newValues[elementId].toDouble();
-
-            attribute.setFloatValueFn([newFloatValues](E elementId) { return newFloatValues[elementId]; });
-            break;
-        }
-        }
+    if(!attributesUnchangedBy(config().attributeNames(), *_graphModel, delta))
+        return false;
+
+    auto sourceAttribute = _graphModel->attributeValueByName(config().attributeNames().front());
+
+    auto newAttributeName = config().parameterByName(QStringLiteral("Name"))->valueAsString();
+    QRegularExpression regex(config().parameterByName(QStringLiteral("Regular Expression"))->valueAsString());
+    auto attributeValue = config().parameterByName(QStringLiteral("Attribute Value"))->valueAsString();
+
+    // Only elements that are new to the graph need their values synthesising
+    auto addedElementIds = [](const auto& elementIds, const auto& containsFn)
+    {
+        std::vector<typename std::remove_reference_t<decltype(elementIds)>::value_type> addedIds;
+        std::copy_if(elementIds.begin(), elementIds.end(), std::back_inserter(addedIds), containsFn);
+        return addedIds;
     };
 
-    if(sourceAttribute.elementType() == ElementType::Node)
-        synthesise(target.nodeIds());
-    else if(sourceAttribute.elementType() == ElementType::Edge)
-        synthesise(target.edgeIds());
+    if(sourceAttribute.elementType() == ElementType::Node && _nodeValues)
+    {
+        target.setPhase(QObject::tr("Attribute Synthesis"));
+
+        auto nodeIds = addedElementIds(delta._addedNodeIds,
+            [&target](NodeId nodeId) { return target.containsNodeId(nodeId); });
+
+        synthesiseValues(sourceAttribute, regex, attributeValue, nodeIds, *_nodeValues);
+        createSynthesisedAttribute(*_graphModel, target, newAttributeName, target.nodeIds(), *_nodeValues);
+        return true;
+    }
+
+    if(sourceAttribute.elementType() == ElementType::Edge && _edgeValues)
+    {
+        target.setPhase(QObject::tr("Attribute Synthesis"));
+
+        auto edgeIds = addedElementIds(delta._addedEdgeIds,
+            [&target](EdgeId edgeId) { return target.containsEdgeId(edgeId); });
+
+        synthesiseValues(sourceAttribute, regex, attributeValue, edgeIds, *_edgeValues);
+        createSynthesisedAttribute(*_graphModel, target, newAttributeName, target.edgeIds(), *_edgeValues);
+        return true;
+    }
+
+    return false;
 }
 
 bool AttributeSynthesisTransformFactory::configIsValid(const GraphTransformConfig& graphTransformConfig) const
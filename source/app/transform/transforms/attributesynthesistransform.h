@@ -22,8 +22,13 @@
 #include "transform/graphtransform.h"
 #include "attributes/attribute.h"
 
+#include "shared/graph/grapharray.h"
 #include "shared/utils/redirects.h"
 
+#include <QString>
+
+#include <optional>
+
 class AttributeSynthesisTransform : public GraphTransform
 {
 public:
@@ -32,9 +37,15 @@ public:
     {}
 
     void apply(TransformedGraph& target) const override;
+    bool applyDelta(TransformedGraph& target, const GraphDelta& delta) const override;
 
 private:
     GraphModel* _graphModel = nullptr;
+
+    // The synthesised values from the previous application, retained so that
+    // subsequently the regular expression need only be evaluated for new elements
+    mutable std::optional<NodeArray<QString>> _nodeValues;
+    mutable std::optional<EdgeArray<QString>> _edgeValues;
 };
 
 class AttributeSynthesisTransformFactory : public GraphTransformFactory
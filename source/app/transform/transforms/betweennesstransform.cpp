@@ -19,53 +19,57 @@
 #include "betweennesstransform.h"
 
 #include "transform/transformedgraph.h"
+#include "transform/deferredresult.h"
 #include "graph/graphmodel.h"
 
 #include "shared/graph/grapharray.h"
 #include "shared/utils/threadpool.h"
+#include "shared/utils/progressable.h"
 
 #include <cstdint>
 #include <stack>
 #include <queue>
 #include <map>
 #include <thread>
+#include <functional>
+#include <memory>
 
-void BetweennessTransform::apply(TransformedGraph& target) const
+struct Betweenness
 {
-    target.setPhase(QStringLiteral("Betweenness"));
-    target.setProgress(0);
+    explicit Betweenness(const Graph& graph) :
+        _nodeBetweenness(graph, 0.0),
+        _edgeBetweenness(graph, 0.0)
+    {}
 
-    const auto& nodeIds = target.nodeIds();
-    const auto& edgeIds = target.edgeIds();
-    std::atomic_int progress(0);
+    NodeArray<double> _nodeBetweenness;
+    EdgeArray<double> _edgeBetweenness;
+};
 
-    struct BetweennessArrays
-    {
-        explicit BetweennessArrays(TransformedGraph& graph) :
-            nodeBetweenness(graph, 0.0),
-            edgeBetweenness(graph, 0.0)
-        {}
+static Betweenness betweenness(const Graph& graph, ThreadPool& threadPool,
+    const Cancellable& cancellable, const ProgressFn& progressFn)
+{
+    progressFn(0);
 
-        NodeArray<double> nodeBetweenness;
-        EdgeArray<double> edgeBetweenness;
-    };
+    const auto& nodeIds = graph.nodeIds();
+    const auto& edgeIds = graph.edgeIds();
+    std::atomic_int progress(0);
 
-    std::vector<BetweennessArrays> betweennessArrays(
+    std::vector<Betweenness> betweennessArrays(
         std::thread::hardware_concurrency(),
-        BetweennessArrays{target});
+        Betweenness{graph});
 
-    parallel_for(nodeIds.begin(), nodeIds.end(),
+    threadPool.parallel_for(nodeIds.begin(), nodeIds.end(),
     [&](NodeId nodeId, size_t threadIndex)
     {
         auto& arrays = betweennessArrays.at(threadIndex);
-        auto& _nodeBetweenness = arrays.nodeBetweenness;
-        auto& _edgeBetweenness = arrays.edgeBetweenness;
+        auto& _nodeBetweenness = arrays._nodeBetweenness;
+        auto& _edgeBetweenness = arrays._edgeBetweenness;
 
         // Brandes algorithm
-        NodeArray<std::vector<NodeId>> predecessors(target);
-        NodeArray<int64_t> sigma(target, 0);
-        NodeArray<int64_t> distance(target, -1);
-        NodeArray<double> delta(target, 0.0);
+        NodeArray<std::vector<NodeId>> predecessors(graph);
+        NodeArray<int64_t> sigma(graph, 0);
+        NodeArray<int64_t> distance(graph, -1);
+        NodeArray<double> delta(graph, 0.0);
 
         std::stack<NodeId> stack;
         std::queue<NodeId> queue;
@@ -74,13 +78,13 @@ void BetweennessTransform::apply(TransformedGraph& target) const
         distance[nodeId] = 0;
         queue.push(nodeId);
 
-        while(!queue.empty() && !cancelled())
+        while(!queue.empty() && !cancellable.cancelled())
         {
             auto other = queue.front();
             queue.pop();
             stack.push(other);
 
-            for(auto neighbour : target.neighboursOf(other))
+            for(auto neighbour : graph.neighboursOf(other))
             {
                 if(distance[neighbour] < 0)
                 {
@@ -96,7 +100,7 @@ void BetweennessTransform::apply(TransformedGraph& target) const
             }
         }
 
-        while(!stack.empty() && !cancelled())
+        while(!stack.empty() && !cancellable.cancelled())
         {
             auto other = stack.top();
             stack.pop();
@@ -106,7 +110,7 @@ void BetweennessTransform::apply(TransformedGraph& target) const
                 auto d = (static_cast<double>(sigma[predecessor]) /
                     static_cast<double>(sigma[other])) * (1.0 + delta[other]);
 
-                for(auto edgeId : target.edgeIdsBetween(predecessor, other))
+                for(auto edgeId : graph.edgeIdsBetween(predecessor, other))
                     _edgeBetweenness[edgeId] += d;
 
                 delta[predecessor] += d;
@@ -117,37 +121,100 @@ void BetweennessTransform::apply(TransformedGraph& target) const
         }
 
         progress++;
-        target.setProgress(progress.load() * 100 / static_cast<int>(target.numNodes()));
-
-        if(cancelled())
-            return;
+        progressFn(progress.load() * 100 / static_cast<int>(graph.numNodes()));
     });
 
-    target.setProgress(-1);
+    progressFn(-1);
+
+    Betweenness result(graph);
 
-    if(cancelled())
-        return;
+    if(cancellable.cancelled())
+        return result;
 
-    NodeArray<double> nodeBetweenness(target, 0.0);
-    EdgeArray<double> edgeBetweenness(target, 0.0);
     for(const auto& arrays : betweennessArrays)
     {
         for(auto nodeId : nodeIds)
-            nodeBetweenness[nodeId] += arrays.nodeBetweenness[nodeId];
+            result._nodeBetweenness[nodeId] += arrays._nodeBetweenness[nodeId];
 
         for(auto edgeId : edgeIds)
-            edgeBetweenness[edgeId] += arrays.edgeBetweenness[edgeId];
+            result._edgeBetweenness[edgeId] += arrays._edgeBetweenness[edgeId];
+    }
+
+    return result;
+}
+
+void BetweennessTransform::apply(TransformedGraph& target) const
+{
+    target.setPhase(QStringLiteral("Betweenness"));
+
+    std::function<double(NodeId)> nodeValueFn;
+    std::function<double(EdgeId)> edgeValueFn;
+    std::function<bool(NodeId)> nodeValueMissingFn;
+    std::function<bool(EdgeId)> edgeValueMissingFn;
+
+    // The names are only known once the attributes have been created
+    auto attributeNames = std::make_shared<QStringList>();
+
+    if(lazy())
+    {
+        auto deferredBetweenness = makeDeferredResult<Betweenness>(QStringLiteral("Betweenness"),
+            target.mutableGraph(), [](MutableGraph& graph, const Cancellable& cancellable)
+        {
+            // A dedicated pool is used, so as not to contend with transforms on the global pool
+            ThreadPool threadPool(QStringLiteral("Betweenness"));
+            return betweenness(graph, threadPool, cancellable, [](int){});
+        },
+        [graphModel = _graphModel, attributeNames] { graphModel->onDeferredAttributeValuesReady(*attributeNames); });
+
+        _graphModel->addDeferredResult(deferredBetweenness);
+
+        nodeValueFn = [deferredBetweenness](NodeId nodeId)
+        {
+            const auto* result = deferredBetweenness->result();
+            return result != nullptr ? result->_nodeBetweenness[nodeId] : 0.0;
+        };
+
+        edgeValueFn = [deferredBetweenness](EdgeId edgeId)
+        {
+            const auto* result = deferredBetweenness->result();
+            return result != nullptr ? result->_edgeBetweenness[edgeId] : 0.0;
+        };
+
+        nodeValueMissingFn = [deferredBetweenness](NodeId) { return deferredBetweenness->pending(); };
+        edgeValueMissingFn = [deferredBetweenness](EdgeId) { return deferredBetweenness->pending(); };
     }
+    else
+    {
+        auto result = betweenness(target, *ThreadPoolSingleton::instance(),
+            *this, [&target](int percentage) { target.setProgress(percentage); });
 
-    _graphModel->createAttribute(QObject::tr("Node Betweenness"))
+        if(cancelled())
+            return;
+
+        nodeValueFn = [nodeBetweenness = result._nodeBetweenness](NodeId nodeId) { return nodeBetweenness[nodeId]; };
+        edgeValueFn = [edgeBetweenness = result._edgeBetweenness](EdgeId edgeId) { return edgeBetweenness[edgeId]; };
+    }
+
+    QString nodeAttributeName;
+    auto& nodeAttribute = _graphModel->createAttribute(QObject::tr("Node Betweenness"), &nodeAttributeName)
         .setDescription(QObject::tr("A node's betweenness is the number of shortest paths that pass through it."))
-        .setFloatValueFn([nodeBetweenness](NodeId nodeId) { return nodeBetweenness[nodeId]; })
+        .setFloatValueFn(nodeValueFn)
         .setFlag(AttributeFlag::VisualiseByComponent);
 
-    _graphModel->createAttribute(QObject::tr("Edge Betweenness"))
+    QString edgeAttributeName;
+    auto& edgeAttribute = _graphModel->createAttribute(QObject::tr("Edge Betweenness"), &edgeAttributeName)
         .setDescription(QObject::tr("An edge's betweenness is the number of shortest paths that pass through it."))
-        .setFloatValueFn([edgeBetweenness](EdgeId edgeId) { return edgeBetweenness[edgeId]; })
+        .setFloatValueFn(edgeValueFn)
         .setFlag(AttributeFlag::VisualiseByComponent);
+
+    // Values are only ever missing while a lazy calculation is pending
+    if(lazy())
+    {
+        nodeAttribute.setValueMissingFn(nodeValueMissingFn);
+        edgeAttribute.setValueMissingFn(edgeValueMissingFn);
+    }
+
+    *attributeNames = {nodeAttributeName, edgeAttributeName};
 }
 
 std::unique_ptr<GraphTransform> BetweennessTransformFactory::create(const GraphTransformConfig&) const
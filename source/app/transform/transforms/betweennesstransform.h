@@ -50,6 +50,7 @@ public:
     }
     QString category() const override { return QObject::tr("Metrics"); }
     ElementType elementType() const override { return ElementType::None; }
+    bool supportsLazyEvaluation() const override { return true; }
     DefaultVisualisations defaultVisualisations() const override
     {
         return
@@ -0,0 +1,161 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "clusteringsweep.h"
+
+#include "graph/graph.h"
+#include "graph/graphmodel.h"
+
+#include "shared/utils/container.h"
+#include "shared/utils/string.h"
+
+#include <QRegularExpression>
+#include <QObject>
+
+#include <algorithm>
+#include <map>
+
+std::vector<double> ClusteringSweep::valuesFrom(const QString& text, double min, double max,
+    QStringList* outOfRange)
+{
+    std::vector<double> values;
+
+    const auto tokens = text.split(QRegularExpression(QStringLiteral(R"([,\s]+)")), Qt::SkipEmptyParts);
+    for(const auto& token : tokens)
+    {
+        bool success = false;
+        auto value = token.toDouble(&success);
+
+        if(!success)
+            continue;
+
+        if(value >= min && value <= max)
+            values.push_back(value);
+        else if(outOfRange != nullptr)
+            outOfRange->append(token);
+    }
+
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+
+    return values;
+}
+
+QString ClusteringSweep::validatorRegex()
+{
+    return QStringLiteral(R"(^\s*\d*\.?\d+(\s*[,\s]\s*\d*\.?\d+)*\s*$)");
+}
+
+ClusteringSummary ClusteringSweep::summaryOf(const Graph& graph,
+    const ClusterNumbers& clusterNumbers, const EdgeArray<double>* weights)
+{
+    ClusteringSummary summary;
+
+    std::map<size_t, double> internalWeights;
+    std::map<size_t, double> totalDegrees;
+    double totalWeight = 0.0;
+
+    for(auto nodeId : graph.nodeIds())
+    {
+        auto clusterNumber = clusterNumbers[nodeId];
+        if(clusterNumber > 0)
+            summary._numClusters = std::max(summary._numClusters, clusterNumber);
+    }
+
+    for(auto edgeId : graph.edgeIds())
+    {
+        const auto& edge = graph.edgeById(edgeId);
+        auto weight = weights != nullptr ? (*weights)[edgeId] : 1.0;
+
+        auto sourceCluster = clusterNumbers[edge.sourceId()];
+        auto targetCluster = clusterNumbers[edge.targetId()];
+
+        totalWeight += weight;
+        totalDegrees[sourceCluster] += weight;
+        totalDegrees[targetCluster] += weight;
+
+        if(sourceCluster == targetCluster)
+            internalWeights[sourceCluster] += weight;
+    }
+
+    if(totalWeight <= 0.0)
+        return summary;
+
+    // Q = ∑c [ (Lc / m) - (dc / 2m)² ]
+    for(const auto& [clusterNumber, degree] : totalDegrees)
+    {
+        // Unclustered nodes don't contribute
+        if(clusterNumber == 0)
+            continue;
+
+        auto internalWeight = u::contains(internalWeights, clusterNumber) ?
+            internalWeights.at(clusterNumber) : 0.0;
+        auto degreeFraction = degree / (2.0 * totalWeight);
+
+        summary._modularity += (internalWeight / totalWeight) - (degreeFraction * degreeFraction);
+    }
+
+    return summary;
+}
+
+QString ClusteringSweep::summaryText(double value, const ClusteringSummary& summary)
+{
+    return QObject::tr("A granularity of %1 results in %2 with a modularity of %3.")
+        .arg(u::formatNumberScientific(value),
+        u::pluralise(summary._numClusters, QObject::tr("cluster"), QObject::tr("clusters")),
+        u::formatNumberScientific(summary._modularity, 3, 3));
+}
+
+void ClusteringSweep::createAttributes(GraphModel& graphModel, const Graph& graph,
+    const ClusterNumbers& clusterNumbers,
+    const QString& clusterAttributeName, const QString& clusterDescription,
+    const QString& sizeAttributeName, const QString& sizeDescription)
+{
+    std::map<size_t, int> clusterSizes;
+    for(auto nodeId : graph.nodeIds())
+    {
+        auto clusterNumber = clusterNumbers[nodeId];
+        if(clusterNumber > 0)
+            clusterSizes[clusterNumber]++;
+    }
+
+    NodeArray<QString> nodeClusterNames(graph);
+    NodeArray<int> nodeClusterSizes(graph);
+
+    for(auto nodeId : graph.nodeIds())
+    {
+        auto clusterNumber = clusterNumbers[nodeId];
+        if(clusterNumber == 0)
+            continue;
+
+        nodeClusterNames[nodeId] = QObject::tr("Cluster %1").arg(clusterNumber);
+        nodeClusterSizes[nodeId] = clusterSizes.at(clusterNumber);
+    }
+
+    graphModel.createAttribute(clusterAttributeName)
+        .setDescription(clusterDescription)
+        .setStringValueFn([nodeClusterNames](NodeId nodeId) { return nodeClusterNames[nodeId]; })
+        .setValueMissingFn([nodeClusterNames](NodeId nodeId) { return nodeClusterNames[nodeId].isEmpty(); })
+        .setFlag(AttributeFlag::FindShared)
+        .setFlag(AttributeFlag::Searchable);
+
+    graphModel.createAttribute(sizeAttributeName)
+        .setDescription(sizeDescription)
+        .setIntValueFn([nodeClusterSizes](NodeId nodeId) { return nodeClusterSizes[nodeId]; })
+        .setFlag(AttributeFlag::AutoRange);
+}
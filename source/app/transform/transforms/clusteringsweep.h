@@ -0,0 +1,101 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLUSTERINGSWEEP_H
+#define CLUSTERINGSWEEP_H
+
+#include "transform/transformedgraph.h"
+
+#include "shared/graph/grapharray.h"
+#include "shared/utils/threadpool.h"
+
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+
+class GraphModel;
+
+// Cluster numbers are assigned in descending order of cluster size, starting
+// at 1; a cluster number of 0 indicates that the node is not in a cluster
+using ClusterNumbers = NodeArray<size_t>;
+
+struct ClusteringSummary
+{
+    size_t _numClusters = 0;
+    double _modularity = 0.0;
+};
+
+namespace ClusteringSweep
+{
+// Extracts a list of parameter values from a comma/space separated string,
+// discarding anything that can't be parsed or lies outside [min, max]; the
+// latter are appended to outOfRange, if given, so they can be reported
+std::vector<double> valuesFrom(const QString& text, double min, double max,
+    QStringList* outOfRange = nullptr);
+
+QString validatorRegex();
+
+ClusteringSummary summaryOf(const Graph& graph, const ClusterNumbers& clusterNumbers,
+    const EdgeArray<double>* weights = nullptr);
+
+QString summaryText(double value, const ClusteringSummary& summary);
+
+void createAttributes(GraphModel& graphModel, const Graph& graph,
+    const ClusterNumbers& clusterNumbers,
+    const QString& clusterAttributeName, const QString& clusterDescription,
+    const QString& sizeAttributeName, const QString& sizeDescription);
+
+// Runs fn for each of values, concurrently, returning the results in the same
+// order as the values; progress reflects the proportion of values completed
+template<typename Fn>
+auto run(const std::vector<double>& values, TransformedGraph& target, Fn&& fn)
+{
+    std::atomic<size_t> numCompleted(0);
+
+    // A dedicated pool is used here as fn will most likely make use of the
+    // global pool itself, and blocking on it from within it would deadlock; it
+    // is bounded by the core count, as each value holds its own clustering state
+    auto numThreads = std::clamp(static_cast<unsigned int>(values.size()),
+        1u, std::max(std::thread::hardware_concurrency(), 1u));
+
+    auto results = ThreadPool(QStringLiteral("Sweep"), numThreads)
+        .parallel_for(values.begin(), values.end(),
+    [&](double value)
+    {
+        auto result = fn(value);
+        target.setProgress(static_cast<int>((++numCompleted * 100) / values.size()));
+
+        return result;
+    });
+
+    std::vector<std::invoke_result_t<Fn, double>> orderedResults;
+    orderedResults.reserve(values.size());
+
+    for(auto& result : results)
+        orderedResults.emplace_back(std::move(result));
+
+    return orderedResults;
+}
+} // namespace ClusteringSweep
+
+#endif // CLUSTERINGSWEEP_H
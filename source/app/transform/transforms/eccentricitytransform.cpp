@@ -18,47 +18,38 @@
 
 #include "eccentricitytransform.h"
 #include "transform/transformedgraph.h"
+#include "transform/deferredresult.h"
 #include "graph/graphmodel.h"
 #include "shared/utils/threadpool.h"
+#include "shared/utils/progressable.h"
 
 #include <map>
 #include <queue>
+#include <functional>
+#include <memory>
 
-void EccentricityTransform::apply(TransformedGraph& target) const
-{
-    target.setPhase(QStringLiteral("Eccentricity"));
-    calculateDistances(target);
-}
-
-void EccentricityTransform::calculateDistances(TransformedGraph& target) const
+static NodeArray<int> maxDistances(const Graph& graph, ThreadPool& threadPool,
+    const Cancellable& cancellable, const ProgressFn& progressFn)
 {
-    // Setup the contiguous ids
-    NodeIdMap<int> nodeIdToMatrixIndex;
-    for(auto nodeId : target.nodeIds())
-    {
-        auto size = static_cast<int>(nodeIdToMatrixIndex.size());
-        nodeIdToMatrixIndex[nodeId] = size;
-    }
-
-    NodeArray<int> maxDistances(target);
+    NodeArray<int> maxDistances(graph);
 
-    target.setProgress(0);
+    progressFn(0);
 
-    const auto& nodeIds = target.nodeIds();
+    const auto& nodeIds = graph.nodeIds();
     std::atomic_int progress(0);
-    parallel_for(nodeIds.begin(), nodeIds.end(),
-    [this, &maxDistances, &progress, &target](NodeId source)
+    threadPool.parallel_for(nodeIds.begin(), nodeIds.end(),
+    [&maxDistances, &progress, &graph, &cancellable, &progressFn](NodeId source)
     {
-        if(cancelled())
+        if(cancellable.cancelled())
             return;
 
-        NodeArray<int> distance(target);
-        NodeArray<bool> visited(target);
+        NodeArray<int> distance(graph);
+        NodeArray<bool> visited(graph);
 
         auto comparator = [&distance](NodeId a, NodeId b){ return distance[a] > distance[b]; };
         std::priority_queue<NodeId, std::vector<NodeId>, decltype(comparator)> queue(comparator);
 
-        for(auto nodeId : target.nodeIds())
+        for(auto nodeId : graph.nodeIds())
             distance[nodeId] = std::numeric_limits<int>::max();
 
         queue.push(source);
@@ -66,7 +57,7 @@ void EccentricityTransform::calculateDistances(TransformedGraph& target) const
 
         while(!queue.empty())
         {
-            if(cancelled())
+            if(cancellable.cancelled())
                 return;
 
             auto nodeId = queue.top();
@@ -78,9 +69,9 @@ void EccentricityTransform::calculateDistances(TransformedGraph& target) const
             visited.set(nodeId, true);
 
             auto nodeWeight = distance[nodeId];
-            for(EdgeId edgeId : target.edgeIdsForNodeId(nodeId))
+            for(EdgeId edgeId : graph.edgeIdsForNodeId(nodeId))
             {
-                NodeId adjacentNodeId = target.edgeById(edgeId).oppositeId(nodeId);
+                NodeId adjacentNodeId = graph.edgeById(edgeId).oppositeId(nodeId);
                 const int adjacentNodeWeight = 1;
                 if(!visited.get(adjacentNodeId) && (nodeWeight + adjacentNodeWeight < distance[adjacentNodeId]))
                 {
@@ -91,7 +82,7 @@ void EccentricityTransform::calculateDistances(TransformedGraph& target) const
         }
 
         int maxDistance = 0;
-        for(auto nodeId : target.nodeIds())
+        for(auto nodeId : graph.nodeIds())
         {
             if(distance[nodeId] != std::numeric_limits<int>::max())
                 maxDistance = std::max(distance[nodeId], maxDistance);
@@ -99,18 +90,67 @@ void EccentricityTransform::calculateDistances(TransformedGraph& target) const
 
         maxDistances[source] = maxDistance;
         progress++;
-        target.setProgress(progress.load() * 100 / static_cast<int>(target.numNodes()));
+        progressFn(progress.load() * 100 / static_cast<int>(graph.numNodes()));
     });
 
-    target.setProgress(-1);
+    progressFn(-1);
+
+    return maxDistances;
+}
+
+void EccentricityTransform::apply(TransformedGraph& target) const
+{
+    target.setPhase(QStringLiteral("Eccentricity"));
+
+    std::function<int(NodeId)> valueFn;
+    std::function<bool(NodeId)> valueMissingFn;
 
-    if(cancelled())
-        return;
+    // The name is only known once the attribute has been created
+    auto attributeNames = std::make_shared<QStringList>();
 
-    _graphModel->createAttribute(QObject::tr("Node Eccentricity"))
+    if(lazy())
+    {
+        auto deferredMaxDistances = makeDeferredResult<NodeArray<int>>(QStringLiteral("Eccentricity"),
+            target.mutableGraph(), [](MutableGraph& graph, const Cancellable& cancellable)
+        {
+            // A dedicated pool is used, so as not to contend with transforms on the global pool
+            ThreadPool threadPool(QStringLiteral("Eccentricity"));
+            return maxDistances(graph, threadPool, cancellable, [](int){});
+        },
+        [graphModel = _graphModel, attributeNames] { graphModel->onDeferredAttributeValuesReady(*attributeNames); });
+
+        _graphModel->addDeferredResult(deferredMaxDistances);
+
+        valueFn = [deferredMaxDistances](NodeId nodeId)
+        {
+            const auto* result = deferredMaxDistances->result();
+            return result != nullptr ? (*result)[nodeId] : 0;
+        };
+
+        valueMissingFn = [deferredMaxDistances](NodeId) { return deferredMaxDistances->pending(); };
+    }
+    else
+    {
+        auto nodeMaxDistances = maxDistances(target, *ThreadPoolSingleton::instance(),
+            *this, [&target](int percentage) { target.setProgress(percentage); });
+
+        if(cancelled())
+            return;
+
+        valueFn = [nodeMaxDistances](NodeId nodeId) { return nodeMaxDistances[nodeId]; };
+    }
+
+    QString attributeName;
+    auto& attribute = _graphModel->createAttribute(QObject::tr("Node Eccentricity"), &attributeName)
         .setDescription(QObject::tr("A node's eccentricity is the length of the shortest path to the furthest node."))
-        .setIntValueFn([maxDistances](NodeId nodeId) { return maxDistances[nodeId]; })
+        .setIntValueFn(valueFn)
         .setFlag(AttributeFlag::VisualiseByComponent);
+
+    // Values are only ever missing while a lazy calculation is pending
+    if(lazy())
+        attribute.setValueMissingFn(valueMissingFn);
+
+    *attributeNames = {attributeName};
 }
 
 std::unique_ptr<GraphTransform> EccentricityTransformFactory::create(const GraphTransformConfig&) const
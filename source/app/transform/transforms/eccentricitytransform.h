@@ -30,7 +30,6 @@ public:
 
 private:
     GraphModel* _graphModel = nullptr;
-    void calculateDistances(TransformedGraph& target) const;
 };
 
 class EccentricityTransformFactory : public GraphTransformFactory
@@ -49,6 +48,7 @@ public:
     }
     QString category() const override { return QObject::tr("Metrics"); }
     ElementType elementType() const override { return ElementType::None; }
+    bool supportsLazyEvaluation() const override { return true; }
     DefaultVisualisations defaultVisualisations() const override
     {
         return {{"Node Eccentricity", ValueType::Float, {AttributeFlag::VisualiseByComponent}, QObject::tr("Colour")}};
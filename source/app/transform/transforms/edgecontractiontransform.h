@@ -34,6 +34,7 @@ public:
     {}
 
     void apply(TransformedGraph& target) const override;
+    bool modifiesElements() const override { return true; }
 
 private:
     const GraphModel* _graphModel;
@@ -26,6 +26,7 @@
 
 #include "shared/utils/utils.h"
 #include "shared/utils/string.h"
+#include "shared/utils/container.h"
 
 #include <algorithm>
 
@@ -131,6 +132,76 @@ void FilterTransform::apply(TransformedGraph& target) const
     }
 }
 
+template<typename ElementId, typename ConditionFn, typename ContainsFn, typename RemoveFn>
+static void removeDelta(TransformedGraph& target, const ConditionFn& conditionFn, bool invert,
+    const ElementIdSet<ElementId>& previouslyRemoved, const ElementIdSet<ElementId>& added,
+    const ContainsFn& containsFn, const RemoveFn& removeFn)
+{
+    std::vector<ElementId> removees;
+
+    // Elements that haven't been replaced will evaluate the same as they did previously...
+    for(auto elementId : previouslyRemoved)
+    {
+        if(containsFn(elementId) && !u::contains(added, elementId))
+            removees.push_back(elementId);
+    }
+
+    // ...so it's only the new ones that need to be tested
+    for(auto elementId : added)
+    {
+        if(containsFn(elementId) && u::exclusiveOr(conditionFn(elementId), invert))
+            removees.push_back(elementId);
+    }
+
+    auto numRemovees = static_cast<uint64_t>(removees.size());
+    uint64_t progress = 0;
+    for(auto elementId : removees)
+    {
+        removeFn(elementId);
+        target.setProgress(static_cast<int>((progress++ * 100) / numRemovees));
+    }
+}
+
+bool FilterTransform::applyDelta(TransformedGraph& target, const GraphDelta& delta) const
+{
+    // Component membership is a function of the whole graph, so can't be updated locally
+    if(_elementType != ElementType::Node && _elementType != ElementType::Edge)
+        return false;
+
+    if(!attributesUnchangedBy(config().referencedAttributeNames(), *_graphModel, delta))
+        return false;
+
+    const auto* previouslyRemoved = this->previouslyRemoved();
+    Q_ASSERT(previouslyRemoved != nullptr);
+
+    target.setPhase(QObject::tr("Filtering"));
+
+    if(_elementType == ElementType::Node)
+    {
+        auto conditionFn = CreateConditionFnFor::node(*_graphModel, config()._condition);
+        if(conditionFn == nullptr)
+            return false;
+
+        removeDelta<NodeId>(target, conditionFn, _invert,
+            previouslyRemoved->_nodeIds, delta._addedNodeIds,
+            [&target](NodeId nodeId) { return target.containsNodeId(nodeId); },
+            [&target](NodeId nodeId) { target.mutableGraph().removeNode(nodeId); });
+    }
+    else
+    {
+        auto conditionFn = CreateConditionFnFor::edge(*_graphModel, config()._condition);
+        if(conditionFn == nullptr)
+            return false;
+
+        removeDelta<EdgeId>(target, conditionFn, _invert,
+            previouslyRemoved->_edgeIds, delta._addedEdgeIds,
+            [&target](EdgeId edgeId) { return target.containsEdgeId(edgeId); },
+            [&target](EdgeId edgeId) { target.mutableGraph().removeEdge(edgeId); });
+    }
+
+    return true;
+}
+
 std::unique_ptr<GraphTransform> FilterTransformFactory::create(const GraphTransformConfig&) const
 {
     return std::make_unique<FilterTransform>(elementType(), *graphModel(), _invert);
@@ -36,6 +36,7 @@ public:
     {}
 
     void apply(TransformedGraph& target) const override;
+    bool applyDelta(TransformedGraph& target, const GraphDelta& delta) const override;
 
 private:
     ElementType _elementType;
@@ -21,6 +21,7 @@
 #include "transform/transformedgraph.h"
 #include "graph/graphmodel.h"
 #include "shared/utils/container.h"
+#include "shared/graph/elementid_containers.h"
 
 #include <algorithm>
 #include <functional>
@@ -28,10 +29,79 @@
 
 #include <QObject>
 
+void KNNTransform::rankEdgesOf(NodeId nodeId, const TransformedGraph& target,
+    const Attribute& attribute, size_t k, bool ascending, EdgeArray<KnnRank>& ranks)
+{
+    auto edgeIds = target.nodeById(nodeId).edgeIds();
+    auto kthPlus1 = edgeIds.begin() + static_cast<std::ptrdiff_t>(std::min(k, edgeIds.size()));
+
+    if(ascending)
+    {
+        std::partial_sort(edgeIds.begin(), kthPlus1, edgeIds.end(),
+            [&attribute](auto a, auto b) { return attribute.numericValueOf(a) < attribute.numericValueOf(b); });
+    }
+    else
+    {
+        std::partial_sort(edgeIds.begin(), kthPlus1, edgeIds.end(),
+            [&attribute](auto a, auto b) { return attribute.numericValueOf(a) > attribute.numericValueOf(b); });
+    }
+
+    for(auto it = edgeIds.begin(); it != kthPlus1; ++it)
+    {
+        auto position = static_cast<size_t>(std::distance(edgeIds.begin(), it) + 1);
+
+        if(target.edgeById(*it).sourceId() == nodeId)
+            ranks[*it]._source = position;
+        else
+            ranks[*it]._target = position;
+    }
+}
+
+void KNNTransform::removeUnrankedEdges(TransformedGraph& target, EdgeArray<KnnRank>& ranks)
+{
+    uint64_t progress = 0;
+
+    for(const auto& edgeId : target.edgeIds())
+    {
+        auto& rank = ranks[edgeId];
+
+        if(rank._source == 0 && rank._target == 0)
+            target.mutableGraph().removeEdge(edgeId);
+        else if(rank._source == 0)
+            rank._mean = static_cast<double>(rank._target);
+        else if(rank._target == 0)
+            rank._mean = static_cast<double>(rank._source);
+        else
+            rank._mean = static_cast<double>(rank._source + rank._target) * 0.5;
+
+        target.setProgress(static_cast<int>((progress++ * 100u) /
+            static_cast<uint64_t>(target.numEdges())));
+    }
+
+    target.setProgress(-1);
+}
+
+void KNNTransform::createAttributes(const EdgeArray<KnnRank>& ranks) const
+{
+    _graphModel->createAttribute(QObject::tr("k-NN Source Rank"))
+        .setDescription(QObject::tr("The ranking given by k-NN, relative to its source node."))
+        .setIntValueFn([ranks](EdgeId edgeId) { return static_cast<int>(ranks[edgeId]._source); });
+
+    _graphModel->createAttribute(QObject::tr("k-NN Target Rank"))
+        .setDescription(QObject::tr("The ranking given by k-NN, relative to its target node."))
+        .setIntValueFn([ranks](EdgeId edgeId) { return static_cast<int>(ranks[edgeId]._target); });
+
+    _graphModel->createAttribute(QObject::tr("k-NN Mean Rank"))
+        .setDescription(QObject::tr("The mean ranking given by k-NN."))
+        .setFloatValueFn([ranks](EdgeId edgeId) { return ranks[edgeId]._mean; });
+}
+
 void KNNTransform::apply(TransformedGraph& target) const
 {
     target.setPhase(QObject::tr("k-NN"));
 
+    _ranks.reset();
+
     if(config().attributeNames().empty())
     {
         addAlert(AlertType::Error, QObject::tr("Invalid parameter"));
@@ -43,86 +113,99 @@ void KNNTransform::apply(TransformedGraph& target) const
     auto k = static_cast<size_t>(std::get<int>(config().parameterByName(QStringLiteral("k"))->_value));
     bool ascending = config().parameterHasValue(QStringLiteral("Rank Order"), QStringLiteral("Ascending"));
 
-    struct KnnRank
-    {
-        size_t _source = 0;
-        size_t _target = 0;
-        double _mean = 0.0;
-    };
-
     EdgeArray<KnnRank> ranks(target);
-    EdgeArray<bool> removees(target, true);
+
+    for(auto edgeId : target.edgeIds())
+    {
+        const auto& edge = target.edgeById(edgeId);
+        ranks[edgeId]._sourceId = edge.sourceId();
+        ranks[edgeId]._targetId = edge.targetId();
+    }
 
     uint64_t progress = 0;
     for(auto nodeId : target.nodeIds())
     {
-        auto edgeIds = target.nodeById(nodeId).edgeIds();
-        auto kthPlus1 = edgeIds.begin() + static_cast<std::ptrdiff_t>(std::min(k, edgeIds.size()));
+        rankEdgesOf(nodeId, target, attribute, k, ascending, ranks);
 
-        if(ascending)
-        {
-            std::partial_sort(edgeIds.begin(), kthPlus1, edgeIds.end(),
-                [&attribute](auto a, auto b) { return attribute.numericValueOf(a) < attribute.numericValueOf(b); });
-        }
-        else
-        {
-            std::partial_sort(edgeIds.begin(), kthPlus1, edgeIds.end(),
-                [&attribute](auto a, auto b) { return attribute.numericValueOf(a) > attribute.numericValueOf(b); });
-        }
+        target.setProgress(static_cast<int>((progress++ * 100u) /
+            static_cast<uint64_t>(target.numNodes())));
+    }
 
-        for(auto it = edgeIds.begin(); it != kthPlus1; ++it)
-        {
-            auto position = std::distance(edgeIds.begin(), it) + 1;
+    removeUnrankedEdges(target, ranks);
+    createAttributes(ranks);
 
-            if(target.edgeById(*it).sourceId() == nodeId)
-                ranks[*it]._source = position;
-            else
-                ranks[*it]._target = position;
+    _ranks = ranks;
+}
 
-            removees.set(*it, false);
-        }
+bool KNNTransform::applyDelta(TransformedGraph& target, const GraphDelta& delta) const
+{
+    if(!_ranks || config().attributeNames().empty())
+        return false;
 
-        target.setProgress(static_cast<int>((progress++ * 100u) /
-            static_cast<uint64_t>(target.numNodes())));
-    }
+    if(!attributesUnchangedBy(config().attributeNames(), *_graphModel, delta))
+        return false;
 
-    progress = 0;
+    target.setPhase(QObject::tr("k-NN"));
 
-    for(const auto& edgeId : target.edgeIds())
+    auto attribute = _graphModel->attributeValueByName(config().attributeNames().front());
+
+    auto k = static_cast<size_t>(std::get<int>(config().parameterByName(QStringLiteral("k"))->_value));
+    bool ascending = config().parameterHasValue(QStringLiteral("Rank Order"), QStringLiteral("Ascending"));
+    auto& ranks = *_ranks;
+
+    // A node's ranking of its edges only changes if its set of edges changes
+    NodeIdSet affectedNodeIds;
+
+    for(auto edgeId : delta._removedEdgeIds)
     {
-        if(removees.get(edgeId))
+        // The edge is no longer in the graph, hence the need to have retained its nodes
+        if(!ranks[edgeId]._sourceId.isNull())
         {
-            target.mutableGraph().removeEdge(edgeId);
+            affectedNodeIds.insert(ranks[edgeId]._sourceId);
+            affectedNodeIds.insert(ranks[edgeId]._targetId);
         }
-        else
-        {
-            auto& rank = ranks[edgeId];
+    }
 
-            if(rank._source == 0)
-                rank._mean = static_cast<double>(rank._target);
-            else if(rank._target == 0)
-                rank._mean = static_cast<double>(rank._source);
+    for(auto edgeId : delta._addedEdgeIds)
+    {
+        if(!target.containsEdgeId(edgeId))
+            continue;
+
+        const auto& edge = target.edgeById(edgeId);
+        ranks[edgeId] = {edge.sourceId(), edge.targetId()};
+
+        affectedNodeIds.insert(edge.sourceId());
+        affectedNodeIds.insert(edge.targetId());
+    }
+
+    for(auto nodeId : affectedNodeIds)
+    {
+        if(!target.containsNodeId(nodeId))
+            continue;
+
+        for(auto edgeId : target.nodeById(nodeId).edgeIds())
+        {
+            if(ranks[edgeId]._sourceId == nodeId)
+                ranks[edgeId]._source = 0;
             else
-                rank._mean = static_cast<double>(rank._source + rank._target) * 0.5;
+                ranks[edgeId]._target = 0;
         }
-
-        target.setProgress(static_cast<int>((progress++ * 100u) /
-            static_cast<uint64_t>(target.numEdges())));
     }
 
-    target.setProgress(-1);
+    uint64_t progress = 0;
+    for(auto nodeId : affectedNodeIds)
+    {
+        if(target.containsNodeId(nodeId))
+            rankEdgesOf(nodeId, target, attribute, k, ascending, ranks);
 
-    _graphModel->createAttribute(QObject::tr("k-NN Source Rank"))
-        .setDescription(QObject::tr("The ranking given by k-NN, relative to its source node."))
-        .setIntValueFn([ranks](EdgeId edgeId) { return static_cast<int>(ranks[edgeId]._source); });
+        target.setProgress(static_cast<int>((progress++ * 100u) /
+            static_cast<uint64_t>(affectedNodeIds.size())));
+    }
 
-    _graphModel->createAttribute(QObject::tr("k-NN Target Rank"))
-        .setDescription(QObject::tr("The ranking given by k-NN, relative to its target node."))
-        .setIntValueFn([ranks](EdgeId edgeId) { return static_cast<int>(ranks[edgeId]._target); });
+    removeUnrankedEdges(target, ranks);
+    createAttributes(ranks);
 
-    _graphModel->createAttribute(QObject::tr("k-NN Mean Rank"))
-        .setDescription(QObject::tr("The mean ranking given by k-NN."))
-        .setFloatValueFn([ranks](EdgeId edgeId) { return ranks[edgeId]._mean; });
+    return true;
 }
 
 std::unique_ptr<GraphTransform> KNNTransformFactory::create(const GraphTransformConfig&) const
@@ -22,9 +22,11 @@
 #include "transform/graphtransform.h"
 #include "attributes/attribute.h"
 
+#include "shared/graph/grapharray.h"
 #include "shared/utils/redirects.h"
 
 #include <vector>
+#include <optional>
 
 class KNNTransform : public GraphTransform
 {
@@ -34,9 +36,28 @@ public:
     {}
 
     void apply(TransformedGraph& target) const override;
+    bool applyDelta(TransformedGraph& target, const GraphDelta& delta) const override;
 
 private:
     GraphModel* _graphModel = nullptr;
+
+    struct KnnRank
+    {
+        NodeId _sourceId;
+        NodeId _targetId;
+        size_t _source = 0;
+        size_t _target = 0;
+        double _mean = 0.0;
+    };
+
+    // The ranks from the previous application, retained so that subsequently only
+    // those nodes whose edges have changed need to be reranked
+    mutable std::optional<EdgeArray<KnnRank>> _ranks;
+
+    static void rankEdgesOf(NodeId nodeId, const TransformedGraph& target,
+        const Attribute& attribute, size_t k, bool ascending, EdgeArray<KnnRank>& ranks);
+    static void removeUnrankedEdges(TransformedGraph& target, EdgeArray<KnnRank>& ranks);
+    void createAttributes(const EdgeArray<KnnRank>& ranks) const;
 };
 
 class KNNTransformFactory : public GraphTransformFactory
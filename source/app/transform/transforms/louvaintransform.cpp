@@ -18,10 +18,13 @@
 
 #include "louvaintransform.h"
 
+#include "clusteringsweep.h"
+
 #include "transform/transformedgraph.h"
 
 #include "shared/graph/grapharray.h"
 #include "shared/utils/container.h"
+#include "shared/utils/string.h"
 
 #include "graph/graphmodel.h"
 
@@ -32,10 +35,9 @@
 
 // https://arxiv.org/abs/0803.0476
 
-void LouvainTransform::apply(TransformedGraph& target) const
+static double resolutionFor(double granularity)
 {
-    auto resolution = 1.0 - std::get<double>(
-        config().parameterByName(QStringLiteral("Granularity"))->_value);
+    auto resolution = 1.0 - granularity;
 
     const auto minResolution = 0.5;
     const auto maxResolution = 30.0;
@@ -44,11 +46,11 @@ void LouvainTransform::apply(TransformedGraph& target) const
     const auto logMax = std::log10(maxResolution);
     const auto logRange = logMax - logMin;
 
-    resolution = std::pow(10.0f, logMin + (resolution * logRange));
-
-    using CommunityId = NodeId; // Slight Hack, be careful with this
+    return std::pow(10.0f, logMin + (resolution * logRange));
+}
 
-    const auto& edgeIds = target.edgeIds();
+void LouvainTransform::apply(TransformedGraph& target) const
+{
     EdgeArray<double> weights(target, 1.0);
 
     if(_weighted)
@@ -62,10 +64,89 @@ void LouvainTransform::apply(TransformedGraph& target) const
         auto attribute = _graphModel->attributeValueByName(
             config().attributeNames().front());
 
-        for(auto edgeId : edgeIds)
+        for(auto edgeId : target.edgeIds())
             weights[edgeId] = attribute.numericValueOf(edgeId);
     }
 
+    if(_sweep)
+    {
+        QStringList outOfRange;
+        auto granularities = ClusteringSweep::valuesFrom(config().parameterByName(
+            QStringLiteral("Granularities"))->valueAsString(), 0.0, 1.0, &outOfRange);
+
+        if(!outOfRange.empty())
+        {
+            addAlert(AlertType::Error, QObject::tr("Granularities outside the range 0 to 1: %1")
+                .arg(outOfRange.join(QStringLiteral(", "))));
+            return;
+        }
+
+        if(granularities.empty())
+        {
+            addAlert(AlertType::Error, QObject::tr("No valid granularities"));
+            return;
+        }
+
+        target.setPhase(QStringLiteral("Louvain Sweep"));
+        target.setProgress(0);
+
+        auto results = ClusteringSweep::run(granularities, target,
+        [&](double granularity)
+        {
+            return clusterNumbers(target, weights, granularity, false);
+        });
+
+        target.setProgress(-1);
+
+        if(cancelled())
+            return;
+
+        for(size_t i = 0; i < granularities.size(); i++)
+        {
+            auto granularity = granularities.at(i);
+            const auto& result = results.at(i);
+            auto summary = ClusteringSweep::summaryOf(target, result, &weights);
+            auto postfix = QStringLiteral(" (%1)").arg(u::formatNumberScientific(granularity));
+
+            ClusteringSweep::createAttributes(*_graphModel, target, result,
+                QObject::tr("Louvain Cluster") + postfix,
+                QObject::tr("The Louvain cluster in which the node resides. %1")
+                    .arg(ClusteringSweep::summaryText(granularity, summary)),
+                QObject::tr("Louvain Cluster Size") + postfix,
+                QObject::tr("The size of the Louvain cluster in which the node resides."));
+        }
+
+        return;
+    }
+
+    auto granularity = std::get<double>(
+        config().parameterByName(QStringLiteral("Granularity"))->_value);
+
+    auto result = clusterNumbers(target, weights, granularity, true);
+
+    if(cancelled())
+        return;
+
+    ClusteringSweep::createAttributes(*_graphModel, target, result,
+        QObject::tr(_weighted ? "Weighted Louvain Cluster" : "Louvain Cluster"), // clazy:exclude=tr-non-literal
+        QObject::tr("The Louvain cluster in which the node resides."),
+        QObject::tr(_weighted ? "Weighted Louvain Cluster Size" : "Louvain Cluster Size"), // clazy:exclude=tr-non-literal
+        QObject::tr("The size of the Louvain cluster in which the node resides."));
+}
+
+ClusterNumbers LouvainTransform::clusterNumbers(TransformedGraph& target,
+    const EdgeArray<double>& initialWeights, double granularity, bool reportProgress) const
+{
+    auto resolution = resolutionFor(granularity);
+
+    auto setPhase = [&](const QString& phase) { if(reportProgress) target.setPhase(phase); };
+    auto setProgress = [&](int progress) { if(reportProgress) target.setProgress(progress); };
+
+    using CommunityId = NodeId; // Slight Hack, be careful with this
+
+    const auto& edgeIds = target.edgeIds();
+    EdgeArray<double> weights(initialWeights);
+
     double totalWeight = std::accumulate(edgeIds.begin(), edgeIds.end(), 0.0,
     [&weights](double d, EdgeId edgeId)
     {
@@ -74,7 +155,7 @@ void LouvainTransform::apply(TransformedGraph& target) const
 
     std::vector<NodeArray<CommunityId>> iterations;
     size_t progressIteration = 1;
-    target.setPhase(QStringLiteral("Louvain Initialising"));
+    setPhase(QStringLiteral("Louvain Initialising"));
 
     NodeArray<CommunityId> communities(target);
     NodeArray<double> weightedDegrees(target);
@@ -140,7 +221,7 @@ void LouvainTransform::apply(TransformedGraph& target) const
             // pair of connected communities in the base graph
             for(auto edgeId : graph.edgeIds())
             {
-                target.setProgress(static_cast<int>((edgeIndex++ * 100) / graph.numEdges()));
+                setProgress(static_cast<int>((edgeIndex++ * 100) / graph.numEdges()));
 
                 if(cancelled())
                     break;
@@ -185,15 +266,15 @@ void LouvainTransform::apply(TransformedGraph& target) const
         do
         {
             improved = false;
-            target.setProgress(0);
+            setProgress(0);
             uint64_t nodeIndex = 0;
 
-            target.setPhase(QStringLiteral("Louvain Iteration %1.%2")
+            setPhase(QStringLiteral("Louvain Iteration %1.%2")
                 .arg(QString::number(progressIteration), QString::number(subProgressIteration++)));
 
             for(auto nodeId : graph.nodeIds())
             {
-                target.setProgress(static_cast<int>((nodeIndex++ * 100) / graph.numNodes()));
+                setProgress(static_cast<int>((nodeIndex++ * 100) / graph.numNodes()));
 
                 if(graph.typeOf(nodeId) == MultiElementType::Tail)
                     continue;
@@ -245,7 +326,7 @@ void LouvainTransform::apply(TransformedGraph& target) const
                     break;
             }
 
-            target.setProgress(-1);
+            setProgress(-1);
         }
         while(improved && !cancelled());
 
@@ -257,7 +338,7 @@ void LouvainTransform::apply(TransformedGraph& target) const
     bool finished = false;
     do // NOLINT bugprone-infinite-loop
     {
-        target.setProgress(-1);
+        setProgress(-1);
 
         communities.resetElements();
         weightedDegrees.resetElements();
@@ -270,7 +351,7 @@ void LouvainTransform::apply(TransformedGraph& target) const
             relabel(graph);
             iterations.emplace_back(communities);
 
-            target.setPhase(QStringLiteral("Louvain Iteration %1 Coarsening")
+            setPhase(QStringLiteral("Louvain Iteration %1 Coarsening")
                 .arg(QString::number(progressIteration)));
             coarsen(graph);
         }
@@ -279,10 +360,12 @@ void LouvainTransform::apply(TransformedGraph& target) const
     }
     while(!finished && !cancelled());
 
+    ClusterNumbers clusterNumbers(target);
+
     if(cancelled())
-        return;
+        return clusterNumbers;
 
-    target.setPhase(QStringLiteral("Louvain Finalising"));
+    setPhase(QStringLiteral("Louvain Finalising"));
 
     // Set each CommunityId to be the same as the NodeId, initially
     for(auto nodeId : target.nodeIds())
@@ -304,7 +387,7 @@ void LouvainTransform::apply(TransformedGraph& target) const
                 communities[nodeId] = iteration.at(communities[nodeId]);
 
             if(cancelled())
-                return;
+                return clusterNumbers;
         }
     }
 
@@ -319,37 +402,20 @@ void LouvainTransform::apply(TransformedGraph& target) const
         [](const auto& a, const auto& b) { return a.second > b.second; });
 
     // Assign cluster numbers to each community
-    std::map<CommunityId, size_t> clusterNumbers;
+    std::map<CommunityId, size_t> communityClusterNumbers;
     size_t clusterNumber = 1;
     for(auto [communityId, size] : sortedCommunityHistogram)
     {
         if(!communityId.isNull())
-            clusterNumbers[communityId] = clusterNumber++;
+            communityClusterNumbers[communityId] = clusterNumber++;
     }
 
-    NodeArray<QString> clusterNames(target);
-    NodeArray<int> clusterSizes(target);
-
     for(auto nodeId : target.nodeIds())
     {
         auto communityId = communities[nodeId];
-        if(communityId.isNull())
-            continue;
-
-        clusterNumber = clusterNumbers[communityId];
-        clusterNames[nodeId] = QObject::tr("Cluster %1").arg(clusterNumber);
-        clusterSizes[nodeId] = static_cast<int>(communityHistogram.at(communityId));
+        if(!communityId.isNull())
+            clusterNumbers[nodeId] = communityClusterNumbers.at(communityId);
     }
 
-    _graphModel->createAttribute(QObject::tr(_weighted ? "Weighted Louvain Cluster" : "Louvain Cluster")) // clazy:exclude=tr-non-literal
-        .setDescription(QObject::tr("The Louvain cluster in which the node resides."))
-        .setStringValueFn([clusterNames](NodeId nodeId) { return clusterNames[nodeId]; })
-        .setValueMissingFn([clusterNames](NodeId nodeId) { return clusterNames[nodeId].isEmpty(); })
-        .setFlag(AttributeFlag::FindShared)
-        .setFlag(AttributeFlag::Searchable);
-
-    _graphModel->createAttribute(QObject::tr(_weighted ? "Weighted Louvain Cluster Size" : "Louvain Cluster Size")) // clazy:exclude=tr-non-literal
-        .setDescription(QObject::tr("The size of the Louvain cluster in which the node resides."))
-        .setIntValueFn([clusterSizes](NodeId nodeId) { return clusterSizes[nodeId]; })
-        .setFlag(AttributeFlag::AutoRange);
+    return clusterNumbers;
 }
@@ -20,6 +20,7 @@
 #define LOUVAINTRANSFORM_H
 
 #include "transform/graphtransform.h"
+#include "clusteringsweep.h"
 
 #include "shared/utils/flags.h"
 #include "shared/utils/redirects.h"
@@ -27,13 +28,17 @@
 class LouvainTransform : public GraphTransform
 {
 public:
-    explicit LouvainTransform(GraphModel* graphModel, bool weighted) :
-        _graphModel(graphModel), _weighted(weighted) {}
+    explicit LouvainTransform(GraphModel* graphModel, bool weighted, bool sweep = false) :
+        _graphModel(graphModel), _weighted(weighted), _sweep(sweep) {}
     void apply(TransformedGraph& target) const override;
 
 private:
+    ClusterNumbers clusterNumbers(TransformedGraph& target, const EdgeArray<double>& initialWeights,
+        double granularity, bool reportProgress) const;
+
     GraphModel* _graphModel = nullptr;
     bool _weighted = false;
+    bool _sweep = false;
 };
 
 class LouvainTransformFactory : public GraphTransformFactory
@@ -104,4 +109,38 @@ public:
     }
 };
 
+class LouvainSweepTransformFactory : public LouvainTransformFactory
+{
+public:
+    using LouvainTransformFactory::LouvainTransformFactory;
+
+    QString description() const override
+    {
+        return QObject::tr("Find clusters using %1, for each of a list of granularities. "
+            "The clusterings are computed concurrently, and an attribute is created for each, "
+            "allowing them to be compared quickly.")
+            .arg(u::redirectLink("louvain", QObject::tr("Louvain Modularity")));
+    }
+
+    GraphTransformParameters parameters() const override
+    {
+        return
+        {
+            GraphTransformParameter::create("Granularities")
+                .setType(ValueType::String)
+                .setDescription(QObject::tr("A comma separated list of granularities, "
+                    "each in the range 0 to 1."))
+                .setInitialValue("0.25, 0.5, 0.75")
+                .setValidatorRegex(ClusteringSweep::validatorRegex())
+        };
+    }
+
+    DefaultVisualisations defaultVisualisations() const override { return {}; }
+
+    std::unique_ptr<GraphTransform> create(const GraphTransformConfig&) const override
+    {
+        return std::make_unique<LouvainTransform>(graphModel(), false, true);
+    }
+};
+
 #endif // LOUVAINTRANSFORM_H
@@ -17,9 +17,11 @@
  */
 
 #include "mcltransform.h"
+#include "clusteringsweep.h"
 #include "transform/transformedgraph.h"
 #include "graph/graphmodel.h"
 #include "shared/utils/threadpool.h"
+#include "shared/utils/string.h"
 
 #include <blaze/Blaze.h>
 
@@ -284,61 +286,13 @@ static void expandAndPruneRow(MatrixType& mclMatrix, size_t columnId,
     }
 }
 
-void MCLTransform::apply(TransformedGraph& target) const
+static MatrixType initialMCLMatrix(const TransformedGraph& target,
+    std::map<size_t, NodeId>& indexToNodeMap, float pruneLimit)
 {
-    auto granularity = std::get<double>(
-                config().parameterByName(QStringLiteral("Granularity"))->_value);
-
-    if(_debugIteration)
-    {
-        QElapsedTimer mclTimer;
-        mclTimer.start();
-        calculateMCL(static_cast<float>(granularity), target);
-        qDebug() << "MCL Elapsed Time" << mclTimer.elapsed();
-    }
-    else
-        calculateMCL(static_cast<float>(granularity), target);
-}
-
-template<class MatrixType>
-class ColumnsIterator
-{
-public:
-    class iterator
-    {
-    public:
-        using value_type = size_t;
-        using reference = value_type&;
-        using pointer = value_type*;
-        using iterator_category = std::input_iterator_tag;
-        using difference_type = size_t;
-
-    private:
-        size_t _num = 0;
-
-    public:
-        explicit iterator(size_t num = 0) : _num(num) {}
-        iterator& operator++() { _num = _num + 1; return *this; }
-        iterator operator++(int) { iterator retval = *this; ++(*this); return retval; }
-        bool operator==(iterator other) const { return _num == other._num; }
-        bool operator!=(iterator other) const { return !(*this == other); }
-        value_type operator*() const { return _num; }
-    };
-    MatrixType& matrix;
-    explicit ColumnsIterator(MatrixType& _matrix) : matrix(_matrix) {}
-    iterator begin() { return iterator(0); }
-    iterator end() { return iterator(matrix.columns()); }
-};
-
-void MCLTransform::calculateMCL(float inflation, TransformedGraph& target) const
-{
-    target.setPhase(QStringLiteral("MCL Initialising"));
-
-    int nodeCount = target.numNodes();
+    auto nodeCount = static_cast<size_t>(target.numNodes());
 
     // Map NodeIds to Matrix index
     NodeIdMap<size_t> nodeToIndexMap;
-    std::map<size_t, NodeId> indexToNodeMap;
     for(NodeId nodeId : target.nodeIds())
     {
         auto index = nodeToIndexMap.size();
@@ -376,13 +330,6 @@ void MCLTransform::calculateMCL(float inflation, TransformedGraph& target) const
     }
     clusterMatrix.trim();
 
-    std::stringstream matrixStream;
-    if(_debugMatrices)
-    {
-        matrixStream << clusterMatrix;
-        qDebug().noquote() << QString::fromStdString(matrixStream.str());
-    }
-
     // Normalise the columns
     normaliseColumnsColumnMajor(clusterMatrix);
 
@@ -392,32 +339,154 @@ void MCLTransform::calculateMCL(float inflation, TransformedGraph& target) const
     // Normalise again...
     normaliseColumnsColumnMajor(clusterMatrix);
 
-    if(_debugIteration)
-        qDebug() << "Pre nnz" << clusterMatrix.nonZeros();
+    clusterMatrix.erase([pruneLimit](float value){ return value < pruneLimit; } );
 
-    clusterMatrix.erase([this](float value){ return value < MCL_PRUNE_LIMIT; } );
+    return clusterMatrix;
+}
+
+void MCLTransform::apply(TransformedGraph& target) const
+{
+    QElapsedTimer mclTimer;
+    mclTimer.start();
+
+    target.setPhase(QStringLiteral("MCL Initialising"));
+
+    std::map<size_t, NodeId> indexToNodeMap;
+    auto initialMatrix = initialMCLMatrix(target, indexToNodeMap, MCL_PRUNE_LIMIT);
 
     if(_debugIteration)
-        qDebug() << "Pre-prune nnz" << clusterMatrix.nonZeros();
+        qDebug() << "Pre-prune nnz" << initialMatrix.nonZeros();
 
     if(_debugMatrices)
     {
+        std::stringstream matrixStream;
         matrixStream << "Pre-inflated Matrix \n";
-        matrixStream << clusterMatrix;
+        matrixStream << initialMatrix;
         qDebug().noquote() << QString::fromStdString(matrixStream.str());
-        matrixStream.clear();
-        matrixStream.str(std::string());
     }
 
+    if(_sweep)
+    {
+        QStringList outOfRange;
+        auto granularities = ClusteringSweep::valuesFrom(config().parameterByName(
+            QStringLiteral("Granularities"))->valueAsString(), 1.1, 3.5, &outOfRange);
+
+        if(!outOfRange.empty())
+        {
+            addAlert(AlertType::Error, QObject::tr("Granularities outside the range 1.1 to 3.5: %1")
+                .arg(outOfRange.join(QStringLiteral(", "))));
+            return;
+        }
+
+        if(granularities.empty())
+        {
+            addAlert(AlertType::Error, QObject::tr("No valid granularities"));
+            return;
+        }
+
+        target.setPhase(QStringLiteral("MCL Sweep"));
+        target.setProgress(0);
+
+        // The (pre-inflated) initial matrix is independent of the inflation
+        // parameter, so it is computed once and shared between each run
+        auto results = ClusteringSweep::run(granularities, target,
+        [&](double granularity)
+        {
+            return calculateMCL(initialMatrix, indexToNodeMap,
+                static_cast<float>(granularity), target, false);
+        });
+
+        target.setProgress(-1);
+
+        if(cancelled())
+            return;
+
+        for(size_t i = 0; i < granularities.size(); i++)
+        {
+            auto granularity = granularities.at(i);
+            const auto& result = results.at(i);
+            auto summary = ClusteringSweep::summaryOf(target, result);
+            auto postfix = QStringLiteral(" (%1)").arg(u::formatNumberScientific(granularity));
+
+            ClusteringSweep::createAttributes(*_graphModel, target, result,
+                QObject::tr("MCL Cluster") + postfix,
+                QObject::tr("The MCL cluster in which the node resides. %1")
+                    .arg(ClusteringSweep::summaryText(granularity, summary)),
+                QObject::tr("MCL Cluster Size") + postfix,
+                QObject::tr("The size of the MCL cluster in which the node resides."));
+        }
+    }
+    else
+    {
+        auto granularity = std::get<double>(
+            config().parameterByName(QStringLiteral("Granularity"))->_value);
+
+        auto result = calculateMCL(initialMatrix, indexToNodeMap,
+            static_cast<float>(granularity), target, true);
+
+        if(cancelled())
+            return;
+
+        ClusteringSweep::createAttributes(*_graphModel, target, result,
+            QObject::tr("MCL Cluster"), QObject::tr("The MCL cluster in which the node resides."),
+            QObject::tr("MCL Cluster Size"), QObject::tr("The size of the MCL cluster in which the node resides."));
+    }
+
+    if(_debugIteration)
+        qDebug() << "MCL Elapsed Time" << mclTimer.elapsed();
+}
+
+template<class MatrixType>
+class ColumnsIterator
+{
+public:
+    class iterator
+    {
+    public:
+        using value_type = size_t;
+        using reference = value_type&;
+        using pointer = value_type*;
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = size_t;
+
+    private:
+        size_t _num = 0;
+
+    public:
+        explicit iterator(size_t num = 0) : _num(num) {}
+        iterator& operator++() { _num = _num + 1; return *this; }
+        iterator operator++(int) { iterator retval = *this; ++(*this); return retval; }
+        bool operator==(iterator other) const { return _num == other._num; }
+        bool operator!=(iterator other) const { return !(*this == other); }
+        value_type operator*() const { return _num; }
+    };
+    MatrixType& matrix;
+    explicit ColumnsIterator(MatrixType& _matrix) : matrix(_matrix) {}
+    iterator begin() { return iterator(0); }
+    iterator end() { return iterator(matrix.columns()); }
+};
+
+template<typename Matrix>
+ClusterNumbers MCLTransform::calculateMCL(Matrix clusterMatrix,
+    const std::map<size_t, NodeId>& indexToNodeMap, float inflation,
+    TransformedGraph& target, bool reportProgress) const
+{
+    auto setPhase = [&](const QString& phase) { if(reportProgress) target.setPhase(phase); };
+    auto setProgress = [&](int progress) { if(reportProgress) target.setProgress(progress); };
+
+    auto nodeCount = clusterMatrix.columns();
+    std::stringstream matrixStream;
+    ClusterNumbers clusterNumbers(target);
+
     bool isEquiDistrubuted = true;
     // Start the MCL loop
     int iter = 0;
     do
     {
         if(cancelled())
-            return;
+            return clusterNumbers;
 
-        target.setPhase(QStringLiteral("MCL Iteration %1").arg(QString::number(iter + 1)));
+        setPhase(QStringLiteral("MCL Iteration %1").arg(QString::number(iter + 1)));
         if(_debugMatrices)
         {
             matrixStream << "Pre-Expanded Matrix\n";
@@ -446,7 +515,7 @@ void MCLTransform::calculateMCL(float inflation, TransformedGraph& target) const
 
         std::atomic<uint64_t> iteration(0);
         const auto totalIterations = clusterMatrix.columns();
-        target.setProgress(0);
+        setProgress(0);
 
         auto cancelledFn = [this] { return cancelled(); };
 
@@ -457,13 +526,13 @@ void MCLTransform::calculateMCL(float inflation, TransformedGraph& target) const
             expandAndPruneRow(clusterMatrix, iterator, &matrixStorage[iterator],
                 rowData, MCL_PRUNE_LIMIT, cancelledFn);
 
-            target.setProgress(static_cast<int>((iteration++ * 100) / totalIterations));
+            setProgress(static_cast<int>((iteration++ * 100) / totalIterations));
         });
 
-        target.setProgress(-1);
+        setProgress(-1);
 
         if(cancelled())
-            return;
+            return clusterNumbers;
 
         size_t newNNZCount = 0;
         for(const auto& column : matrixStorage)
@@ -552,7 +621,7 @@ void MCLTransform::calculateMCL(float inflation, TransformedGraph& target) const
     if(_debugIteration)
         qDebug() << iter << "iterations";
 
-    target.setPhase(QStringLiteral("MCL Interpreting"));
+    setPhase(QStringLiteral("MCL Interpreting"));
 
     // Interpret the matrix
     std::vector<std::set<size_t>> clusters;
@@ -620,34 +689,19 @@ void MCLTransform::calculateMCL(float inflation, TransformedGraph& target) const
             return a.size() > b.size();
         });
 
-    NodeArray<QString> clusterNames(target);
-    NodeArray<int> clusterSizes(target);
-    int clusterNumber = 1;
+    size_t clusterNumber = 1;
     for(const auto& cluster : clusters)
     {
         for(auto index : cluster)
         {
             auto nodeId = indexToNodeMap.at(index);
-            auto clusterName = QString(QObject::tr("Cluster %1")).arg(QString::number(clusterNumber));
-
-            clusterNames[nodeId] = clusterName;
-            clusterSizes[nodeId] = static_cast<int>(cluster.size());
+            clusterNumbers[nodeId] = clusterNumber;
         }
 
         clusterNumber++;
     }
 
-    _graphModel->createAttribute(QObject::tr("MCL Cluster"))
-        .setDescription(QObject::tr("The MCL cluster in which the node resides."))
-        .setStringValueFn([clusterNames](NodeId nodeId) { return clusterNames[nodeId]; })
-        .setValueMissingFn([clusterNames](NodeId nodeId) { return clusterNames[nodeId].isEmpty(); })
-        .setFlag(AttributeFlag::FindShared)
-        .setFlag(AttributeFlag::Searchable);
-
-    _graphModel->createAttribute(QObject::tr("MCL Cluster Size"))
-        .setDescription(QObject::tr("The size of the MCL cluster in which the node resides."))
-        .setIntValueFn([clusterSizes](NodeId nodeId) { return clusterSizes[nodeId]; })
-        .setFlag(AttributeFlag::AutoRange);
+    return clusterNumbers;
 }
 
 std::unique_ptr<GraphTransform> MCLTransformFactory::create(const GraphTransformConfig&) const
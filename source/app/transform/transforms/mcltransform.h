@@ -20,14 +20,18 @@
 #define MCLTRANSFORM_H
 
 #include "transform/graphtransform.h"
+#include "clusteringsweep.h"
 
 #include "shared/utils/flags.h"
 #include "shared/utils/redirects.h"
 
+#include <map>
+
 class MCLTransform : public GraphTransform
 {
 public:
-    explicit MCLTransform(GraphModel* graphModel) : _graphModel(graphModel) {}
+    explicit MCLTransform(GraphModel* graphModel, bool sweep = false) :
+        _graphModel(graphModel), _sweep(sweep) {}
     void apply(TransformedGraph& target) const override;
 
 private:
@@ -43,10 +47,14 @@ private:
     bool _debugIteration = false;
     bool _debugMatrices = false;
 
-    void calculateMCL(float inflation, TransformedGraph& target) const;
+    template<typename Matrix>
+    ClusterNumbers calculateMCL(Matrix clusterMatrix,
+        const std::map<size_t, NodeId>& indexToNodeMap, float inflation,
+        TransformedGraph& target, bool reportProgress) const;
 
 private:
     GraphModel* _graphModel = nullptr;
+    bool _sweep = false;
 };
 
 class MCLTransformFactory : public GraphTransformFactory
@@ -85,4 +93,38 @@ public:
     std::unique_ptr<GraphTransform> create(const GraphTransformConfig& graphTransformConfig) const override;
 };
 
+class MCLSweepTransformFactory : public MCLTransformFactory
+{
+public:
+    using MCLTransformFactory::MCLTransformFactory;
+
+    QString description() const override
+    {
+        return QObject::tr("Find clusters using %1, for each of a list of granularities. "
+            "The clusterings are computed concurrently, and an attribute is created for each, "
+            "allowing them to be compared quickly.")
+            .arg(u::redirectLink("mcl", QObject::tr("MCL - Markov Clustering")));
+    }
+
+    GraphTransformParameters parameters() const override
+    {
+        return
+        {
+            GraphTransformParameter::create("Granularities")
+                .setType(ValueType::String)
+                .setDescription(QObject::tr("A comma separated list of granularities, "
+                    "each in the range 1.1 to 3.5."))
+                .setInitialValue("1.5, 2.0, 2.5")
+                .setValidatorRegex(ClusteringSweep::validatorRegex())
+        };
+    }
+
+    DefaultVisualisations defaultVisualisations() const override { return {}; }
+
+    std::unique_ptr<GraphTransform> create(const GraphTransformConfig&) const override
+    {
+        return std::make_unique<MCLTransform>(graphModel(), true);
+    }
+};
+
 #endif // MCLTRANSFORM_H
@@ -19,6 +19,7 @@
 #include "pageranktransform.h"
 
 #include "transform/transformedgraph.h"
+#include "transform/deferredresult.h"
 
 #include "graph/graphcomponent.h"
 #include "graph/graphmodel.h"
@@ -30,15 +31,65 @@
 #include <QDebug>
 
 #include <map>
+#include <functional>
+#include <memory>
 
 using VectorType = blaze::DynamicVector<float>;
 
 void PageRankTransform::apply(TransformedGraph& target) const
 {
-    calculatePageRank(target);
+    std::function<float(NodeId)> valueFn;
+    std::function<bool(NodeId)> valueMissingFn;
+
+    // The name is only known once the attribute has been created
+    auto attributeNames = std::make_shared<QStringList>();
+
+    if(lazy())
+    {
+        auto deferredPageRankScores = makeDeferredResult<NodeArray<float>>(QStringLiteral("PageRank"),
+            target.mutableGraph(), [debug = _debug](MutableGraph& graph, const Cancellable& cancellable)
+        {
+            return calculatePageRank(graph, cancellable, debug);
+        },
+        [graphModel = _graphModel, attributeNames] { graphModel->onDeferredAttributeValuesReady(*attributeNames); });
+
+        _graphModel->addDeferredResult(deferredPageRankScores);
+
+        valueFn = [deferredPageRankScores](NodeId nodeId)
+        {
+            const auto* result = deferredPageRankScores->result();
+            return result != nullptr ? (*result)[nodeId] : 0.0f;
+        };
+
+        valueMissingFn = [deferredPageRankScores](NodeId) { return deferredPageRankScores->pending(); };
+    }
+    else
+    {
+        auto pageRankScores = calculatePageRank(target, *this, _debug);
+
+        if(cancelled())
+            return;
+
+        valueFn = [pageRankScores](NodeId nodeId) { return pageRankScores[nodeId]; };
+    }
+
+    QString attributeName;
+    auto& attribute = _graphModel->createAttribute(QObject::tr("Node PageRank"), &attributeName)
+        .setDescription(QObject::tr("A node's PageRank is a measure of relative importance in the graph."))
+        .floatRange().setMin(0.0f)
+        .floatRange().setMax(1.0f)
+        .setFloatValueFn(valueFn)
+        .setFlag(AttributeFlag::VisualiseByComponent);
+
+    // Values are only ever missing while a lazy calculation is pending
+    if(lazy())
+        attribute.setValueMissingFn(valueMissingFn);
+
+    *attributeNames = {attributeName};
 }
 
-void PageRankTransform::calculatePageRank(TransformedGraph& target) const
+NodeArray<float> PageRankTransform::calculatePageRank(Graph& target,
+    const Cancellable& cancellable, bool debug)
 {
     // Performs an estimated pagerank calculation optimised to
     // not use a matrix. This dramatically lowers the memory footprint.
@@ -67,7 +118,7 @@ void PageRankTransform::calculatePageRank(TransformedGraph& target) const
         }
 
         QElapsedTimer timer;
-        if (_debug)
+        if (debug)
             timer.start();
 
         VectorType pageRankVector(componentNodeCount,
@@ -83,8 +134,8 @@ void PageRankTransform::calculatePageRank(TransformedGraph& target) const
               iterationCount < PAGERANK_ITERATION_LIMIT &&
               pagerankAcceleration > PAGERANK_ACCELERATION_MINIMUM)
         {
-            if(cancelled())
-                return;
+            if(cancellable.cancelled())
+                return pageRankScores;
 
             target.setPhase(QStringLiteral("PageRank Iteration %1").arg(
                                 QString::number(totalIterationCount + 1)));
@@ -139,7 +190,7 @@ void PageRankTransform::calculatePageRank(TransformedGraph& target) const
             iterationCount++;
             totalIterationCount++;
         }
-        if(_debug && iterationCount == PAGERANK_ITERATION_LIMIT)
+        if(debug && iterationCount == PAGERANK_ITERATION_LIMIT)
             qDebug() << "HIT ITERATION LIMIT ON PAGERANK. LIKELY UNSTABLE PAGERANK VECTOR";
 
         float maxValue = blaze::max(blaze::abs(pageRankVector) );
@@ -148,7 +199,7 @@ void PageRankTransform::calculatePageRank(TransformedGraph& target) const
         for(auto nodeId : component->nodeIds())
             pageRankScores[nodeId] = pageRankVector[nodeToIndexMap[nodeId]];
 
-        if (_debug)
+        if (debug)
         {
             std::stringstream matrixStream;
             matrixStream << pageRankVector;
@@ -160,12 +211,7 @@ void PageRankTransform::calculatePageRank(TransformedGraph& target) const
         }
     }
 
-    _graphModel->createAttribute(QObject::tr("Node PageRank"))
-        .setDescription(QObject::tr("A node's PageRank is a measure of relative importance in the graph."))
-        .floatRange().setMin(0.0f)
-        .floatRange().setMax(1.0f)
-        .setFloatValueFn([pageRankScores](NodeId nodeId) { return pageRankScores[nodeId]; })
-        .setFlag(AttributeFlag::VisualiseByComponent);
+    return pageRankScores;
 }
 
 std::unique_ptr<GraphTransform> PageRankTransformFactory::create(const GraphTransformConfig&) const
@@ -21,6 +21,8 @@
 
 #include "transform/graphtransform.h"
 
+#include "shared/graph/grapharray.h"
+
 #include "shared/utils/flags.h"
 #include "shared/utils/redirects.h"
 
@@ -34,15 +36,15 @@ public:
     void disableDebug() { _debug = false; }
 
 private:
-    const float PAGERANK_DAMPING = 0.8f;
-    const float PAGERANK_EPSILON = 1e-6f;
-    const float PAGERANK_ACCELERATION_MINIMUM = 1e-10f;
-    const int PAGERANK_ITERATION_LIMIT = 1000;
-    const int AVG_COUNT = 10;
+    static constexpr float PAGERANK_DAMPING = 0.8f;
+    static constexpr float PAGERANK_EPSILON = 1e-6f;
+    static constexpr float PAGERANK_ACCELERATION_MINIMUM = 1e-10f;
+    static constexpr int PAGERANK_ITERATION_LIMIT = 1000;
+    static constexpr int AVG_COUNT = 10;
 
     bool _debug = false;
 
-    void calculatePageRank(TransformedGraph& target) const;
+    static NodeArray<float> calculatePageRank(Graph& target, const Cancellable& cancellable, bool debug);
     GraphModel* _graphModel = nullptr;
 };
 
@@ -61,6 +63,7 @@ public:
     }
     QString category() const override { return QObject::tr("Metrics"); }
     ElementType elementType() const override { return ElementType::None; }
+    bool supportsLazyEvaluation() const override { return true; }
     DefaultVisualisations defaultVisualisations() const override
     {
         return {{"Node PageRank", ValueType::Float, {AttributeFlag::VisualiseByComponent}, QObject::tr("Colour")}};
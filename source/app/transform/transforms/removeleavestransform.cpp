@@ -73,6 +73,32 @@ void RemoveBranchesTransform::apply(TransformedGraph& target) const
     removeLeaves(target);
 }
 
+bool RemoveBranchesTransform::applyDelta(TransformedGraph& target, const GraphDelta& delta) const
+{
+    // Removing elements from a graph can only ever create more branches, so if
+    // nothing has been added, whatever was removed previously must be removed again
+    if(delta.hasAdditions())
+        return false;
+
+    const auto* previouslyRemoved = this->previouslyRemoved();
+    Q_ASSERT(previouslyRemoved != nullptr);
+
+    target.setPhase(QObject::tr("Branch Removal"));
+
+    for(auto nodeId : previouslyRemoved->_nodeIds)
+    {
+        if(target.containsNodeId(nodeId))
+            target.mutableGraph().removeNode(nodeId);
+    }
+
+    target.update();
+
+    // ...then any branches that have formed since are removed as normal
+    removeLeaves(target);
+
+    return true;
+}
+
 std::unique_ptr<GraphTransform> RemoveLeavesTransformFactory::create(const GraphTransformConfig&) const
 {
     return std::make_unique<RemoveLeavesTransform>();
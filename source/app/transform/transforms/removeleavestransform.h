@@ -31,6 +31,7 @@ class RemoveBranchesTransform : public GraphTransform
 {
 public:
     void apply(TransformedGraph& target) const override;
+    bool applyDelta(TransformedGraph& target, const GraphDelta& delta) const override;
 };
 
 class RemoveLeavesTransformFactory : public GraphTransformFactory
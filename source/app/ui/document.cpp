@@ -1907,6 +1907,7 @@ QVariantMap Document::transform(const QString& transformName) const
         map.insert(QStringLiteral("description"), transformFactory->description());
         map.insert(QStringLiteral("image"), transformFactory->image());
         map.insert(QStringLiteral("requiresCondition"), transformFactory->requiresCondition());
+        map.insert(QStringLiteral("supportsLazyEvaluation"), transformFactory->supportsLazyEvaluation());
 
         QStringList attributeParameterNames;
         QVariantList attributeParameters;
@@ -1952,18 +1953,67 @@ bool Document::hasTransformInfo() const
     return _graphModel != nullptr ? _graphModel->hasTransformInfo() : false;
 }
 
+static double nsToMs(int64_t ns)
+{
+    return static_cast<double>(ns) / 1000000.0;
+}
+
+static QString transformStatisticsText(const TransformStatistics& statistics)
+{
+    auto formatMs = [](int64_t ns) { return u::formatNumberScientific(nsToMs(ns), 1, 1); };
+
+    QString text = statistics._cacheHit ?
+        QObject::tr("Cached (%1 ms)").arg(formatMs(statistics._wallTime)) :
+        QObject::tr("%1 ms, %2 ms process CPU").arg(formatMs(statistics._wallTime), formatMs(statistics._processCpuTime));
+
+    if(statistics._peakAdditionalMemory > 0)
+    {
+        text += QObject::tr(", +%1 MiB").arg(u::formatNumberScientific(
+            static_cast<double>(statistics._peakAdditionalMemory) / (1024.0 * 1024.0), 1, 1));
+    }
+
+    auto nodeChanges = statistics._nodesAdded - statistics._nodesRemoved;
+    auto edgeChanges = statistics._edgesAdded - statistics._edgesRemoved;
+
+    if(nodeChanges != 0 || edgeChanges != 0)
+    {
+        text += QObject::tr(", %1 nodes, %2 edges")
+            .arg(QStringLiteral("%1%2").arg(nodeChanges > 0 ? "+" : "").arg(nodeChanges),
+            QStringLiteral("%1%2").arg(edgeChanges > 0 ? "+" : "").arg(edgeChanges));
+    }
+
+    return text;
+}
+
 QVariantMap Document::transformInfoAtIndex(int index) const
 {
     QVariantMap map;
 
     map.insert(QStringLiteral("alertType"), static_cast<int>(AlertType::None));
     map.insert(QStringLiteral("alertText"), "");
+    map.insert(QStringLiteral("hasStatistics"), false);
 
     if(_graphModel == nullptr)
         return map;
 
     const auto& transformInfo = _graphModel->transformInfoAtIndex(index);
 
+    if(transformInfo.hasStatistics())
+    {
+        const auto& statistics = transformInfo.statistics();
+
+        map.insert(QStringLiteral("hasStatistics"), true);
+        map.insert(QStringLiteral("cacheHit"), statistics._cacheHit);
+        map.insert(QStringLiteral("wallTime"), nsToMs(statistics._wallTime));
+        map.insert(QStringLiteral("processCpuTime"), nsToMs(statistics._processCpuTime));
+        map.insert(QStringLiteral("peakAdditionalMemory"), static_cast<qulonglong>(statistics._peakAdditionalMemory));
+        map.insert(QStringLiteral("nodesAdded"), statistics._nodesAdded);
+        map.insert(QStringLiteral("nodesRemoved"), statistics._nodesRemoved);
+        map.insert(QStringLiteral("edgesAdded"), statistics._edgesAdded);
+        map.insert(QStringLiteral("edgesRemoved"), statistics._edgesRemoved);
+        map.insert(QStringLiteral("statisticsText"), transformStatisticsText(statistics));
+    }
+
     auto alerts = transformInfo.alerts();
 
     if(alerts.empty())
@@ -2906,6 +2956,54 @@ void Document::removeEnrichmentResults(int index)
     emit enrichmentTableModelsChanged();
 }
 
+void Document::saveTransformStatisticsToFile(const QUrl& fileUrl)
+{
+    if(_graphModel == nullptr)
+        return;
+
+    json transforms = json::array();
+
+    for(int index = 0; index < _graphTransforms.size(); index++)
+    {
+        const auto& transformInfo = _graphModel->transformInfoAtIndex(index);
+
+        json transform =
+        {
+            {"index", index},
+            {"expression", _graphTransforms.at(index).toStdString()}
+        };
+
+        if(transformInfo.hasStatistics())
+        {
+            const auto& statistics = transformInfo.statistics();
+
+            transform["cacheHit"] = statistics._cacheHit;
+            transform["wallTimeMs"] = nsToMs(statistics._wallTime);
+            transform["processCpuTimeMs"] = nsToMs(statistics._processCpuTime);
+            transform["peakAdditionalMemoryBytes"] = statistics._peakAdditionalMemory;
+            transform["nodesAdded"] = statistics._nodesAdded;
+            transform["nodesRemoved"] = statistics._nodesRemoved;
+            transform["edgesAdded"] = statistics._edgesAdded;
+            transform["edgesRemoved"] = statistics._edgesRemoved;
+        }
+
+        transforms.push_back(transform);
+    }
+
+    QString localFileName = fileUrl.toLocalFile();
+    QFile file(localFileName);
+
+    if(!file.open(QIODevice::ReadWrite|QIODevice::Truncate))
+    {
+        QMessageBox::critical(nullptr, tr("File Error"),
+            QString(tr("The file '%1' cannot be opened for writing. Please ensure "
+            "it is not open in another application and try again.")).arg(localFileName));
+        return;
+    }
+
+    file.write(QByteArray::fromStdString(transforms.dump(4)));
+}
+
 void Document::saveNodePositionsToFile(const QUrl& fileUrl)
 {
     QString localFileName = fileUrl.toLocalFile();
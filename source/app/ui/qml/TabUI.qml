@@ -555,6 +555,32 @@ Item
         fileDialog.open();
     }
 
+    SaveFileDialogComponent { id: exportTransformStatisticsFileDialogComponent }
+
+    function exportTransformStatistics()
+    {
+        let folder = misc.fileSaveInitialFolder !== undefined ?
+            misc.fileSaveInitialFolder : "";
+        let path = Utils.format(qsTr("{0}/{1}-transform-statistics"), QmlUtils.fileNameForUrl(folder),
+            root.baseFileNameNoExtension);
+
+        let fileDialog = exportTransformStatisticsFileDialogComponent.createObject(root,
+        {
+            "title": qsTr("Export Transform Statistics"),
+            "folder": folder,
+            "nameFilters": [qsTr("JSON File (*.json)")],
+            "currentFile": QmlUtils.urlForFileName(path)
+        });
+
+        fileDialog.accepted.connect(function()
+        {
+            misc.fileSaveInitialFolder = fileDialog.folder.toString();
+            _document.saveTransformStatisticsToFile(fileDialog.file);
+        });
+
+        fileDialog.open();
+    }
+
     function searchWebForNode(nodeId)
     {
         let nodeName = _document.nodeName(nodeId);
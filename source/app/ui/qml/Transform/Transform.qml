@@ -84,6 +84,14 @@ Item
             Rectangle { height: dummyField.height }
         }
 
+        Label
+        {
+            id: statisticsLabel
+            visible: text.length > 0
+            color: disabledTextColor
+            font.italic: true
+        }
+
         Hamburger
         {
             id: hamburger
@@ -138,6 +146,21 @@ Item
                     }
                 }
 
+                PlatformMenuItem
+                {
+                    id: lazyMenuItem
+
+                    text: qsTr("Evaluate Lazily")
+                    checkable: true
+                    hidden: true
+
+                    onCheckedChanged:
+                    {
+                        setFlag("lazy", checked);
+                        updateExpression();
+                    }
+                }
+
                 PlatformMenuItem
                 {
                     id: pinnedMenuItem
@@ -288,12 +311,17 @@ Item
                 {
                     let transformInfo = document.transformInfoAtIndex(index);
                     setAlertIcon(transformInfo);
+
+                    statisticsLabel.text = transformInfo.hasStatistics ?
+                        transformInfo.statisticsText : "";
                 }
 
                 let transformConfig = new TransformConfig.Create(index, document.parseGraphTransform(value));
                 flags = transformConfig.flags;
                 template = transformConfig.template;
 
+                lazyMenuItem.hidden = !document.transform(transformConfig.action).supportsLazyEvaluation;
+
                 transformConfig.toComponents(document, expression, isFlagSet("locked"), updateExpression);
                 _parameterComponents = transformConfig.parameters;
             }
@@ -322,6 +350,7 @@ Item
             enabledMenuItem.checked = !isFlagSet("disabled");
             lockedMenuItem.checked = isFlagSet("locked");
             repeatingMenuItem.checked = isFlagSet("repeating");
+            lazyMenuItem.checked = isFlagSet("lazy");
             pinnedMenuItem.checked = isFlagSet("pinned");
             ready = true;
         }
@@ -1536,6 +1536,19 @@ ApplicationWindow
         }
     }
 
+    Action
+    {
+        id: exportTransformStatisticsAction
+        text: qsTr("Export Transform Statistics…")
+        enabled: currentTab && !currentTab.document.busy && currentTab.document.hasTransformInfo()
+
+        onTriggered: function(source)
+        {
+            if(currentTab)
+                currentTab.exportTransformStatistics();
+        }
+    }
+
     Action
     {
         id: overviewModeAction
@@ -2253,6 +2266,7 @@ ApplicationWindow
             title: qsTr("T&ools")
             PlatformMenuItem { action: enrichmentAction }
             PlatformMenuItem { action: searchWebAction }
+            PlatformMenuItem { action: exportTransformStatisticsAction }
             PlatformMenuSeparator {}
             PlatformMenuItem { action: cloneAttributeAction }
             PlatformMenuItem { action: editAttributeAction }
@@ -0,0 +1,89 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bitpackedrows.h"
+#include "distancekernels.h"
+
+#include <algorithm>
+#include <bit>
+
+// Roughly the size of a per core L2 cache
+static constexpr size_t TargetTileBytes = 512 * 1024;
+
+BitPackedRows::BitPackedRows(const DiscreteDataVectors& vectors, bool binary) :
+    _numRows(vectors.size()),
+    _numColumns(!vectors.empty() ? vectors.front().size() : 0),
+    _numWords((_numColumns + 63) / 64)
+{
+    if(!binary && !vectors.empty())
+    {
+        // The tokens come from the dictionary shared by all the vectors
+        auto maxToken = vectors.front().dictionary().maxToken();
+        _numPlanes = static_cast<size_t>(std::bit_width(maxToken));
+    }
+
+    _stride = (1 + _numPlanes) * _numWords;
+    _data.resize(_numRows * _stride, 0);
+
+    for(size_t index = 0; index < _numRows; index++)
+    {
+        auto* bits = &_data[index * _stride];
+
+        for(size_t column = 0; column < _numColumns; column++)
+        {
+            auto token = vectors[index].tokenAt(column);
+            if(token == 0)
+                continue;
+
+            auto word = column / 64;
+            auto bit = uint64_t{1} << (column % 64);
+
+            bits[word] |= bit;
+
+            for(size_t plane = 0; plane < _numPlanes; plane++)
+            {
+                if((token >> plane) & 1u)
+                    bits[((1 + plane) * _numWords) + word] |= bit;
+            }
+        }
+    }
+}
+
+size_t BitPackedRows::tileSize() const
+{
+    auto rowBytes = std::max(_stride, size_t{1}) * sizeof(uint64_t);
+    return std::clamp(TargetTileBytes / (2 * rowBytes), size_t{16}, size_t{512});
+}
+
+BitPackedRows::Counts BitPackedRows::compare(size_t rowA, size_t rowB) const
+{
+    Counts counts;
+
+    if(_numPlanes == 0)
+    {
+        binaryMatchCounts(row(rowA), row(rowB), _numWords,
+            counts._numMatching, counts._numEitherNonZero);
+    }
+    else
+    {
+        tokenMatchCounts(row(rowA), row(rowB), _numWords, _numPlanes,
+            counts._numMatching, counts._numEitherNonZero);
+    }
+
+    return counts;
+}
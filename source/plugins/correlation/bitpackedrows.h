@@ -0,0 +1,67 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BITPACKEDROWS_H
+#define BITPACKEDROWS_H
+
+#include "correlationdatavector.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Discrete data vectors' tokens packed into bitsets, such that matching correlations can be
+// computed 64 columns at a time using bitwise operations and popcounts. Each row has a
+// bitset marking its non-zero tokens, followed, unless the data is being treated as
+// binary, by the tokens themselves, bit sliced; that is, one bitset per bit of token,
+// which scales with the logarithm of the number of distinct values, rather than linearly
+class BitPackedRows
+{
+private:
+    size_t _numRows = 0;
+    size_t _numColumns = 0;
+    size_t _numWords = 0;
+    size_t _numPlanes = 0;
+    size_t _stride = 0;
+
+    std::vector<uint64_t> _data;
+
+    const uint64_t* row(size_t index) const { return &_data[index * _stride]; }
+
+public:
+    BitPackedRows(const DiscreteDataVectors& vectors, bool binary);
+
+    size_t numRows() const { return _numRows; }
+    size_t numColumns() const { return _numColumns; }
+
+    // The number of rows per tile, such that a pair of tiles fits in cache
+    size_t tileSize() const;
+
+    struct Counts
+    {
+        // Columns at which the rows match (or if binary, are both non-zero)
+        size_t _numMatching = 0;
+
+        // Columns at which either row is non-zero
+        size_t _numEitherNonZero = 0;
+    };
+
+    Counts compare(size_t rowA, size_t rowB) const;
+};
+
+#endif // BITPACKEDROWS_H
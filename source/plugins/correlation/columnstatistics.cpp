@@ -0,0 +1,353 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "columnstatistics.h"
+
+#include "shared/utils/container_randomsample.h"
+#include "shared/utils/threadpool.h"
+
+#include <algorithm>
+#include <numeric>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <cmath>
+
+static size_t numThreads()
+{
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+// The median of [first, last), by selection; afterwards, the values below
+// the middle of the range are those less than or equal to the median
+static double medianOf(std::vector<double>::iterator first, std::vector<double>::iterator last)
+{
+    auto size = std::distance(first, last);
+    if(size == 0)
+        return 0.0;
+
+    auto middle = first + (size / 2);
+    std::nth_element(first, middle, last);
+    auto median = *middle;
+
+    if(size % 2 == 0)
+        median = (*std::max_element(first, middle) + median) / 2.0;
+
+    return median;
+}
+
+IQRStatistics iqrStatisticsOf(std::vector<double>& values)
+{
+    IQRStatistics iqr;
+    iqr._numValues = values.size();
+
+    if(values.empty())
+        return iqr;
+
+    iqr._secondQuartile = medianOf(values.begin(), values.end());
+    iqr._firstQuartile = iqr._secondQuartile;
+    iqr._thirdQuartile = iqr._secondQuartile;
+
+    // Don't calculate medians if there's only one sample
+    if(values.size() > 1)
+    {
+        // Selecting the median has partitioned the values into lower and upper halves;
+        // when there are an odd number of values, the median itself is in neither
+        auto middle = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+        auto upperFirst = values.size() % 2 == 0 ? middle : middle + 1;
+
+        iqr._firstQuartile = medianOf(values.begin(), middle);
+        iqr._thirdQuartile = medianOf(upperFirst, values.end());
+    }
+
+    auto range = iqr._thirdQuartile - iqr._firstQuartile;
+    auto lowerFence = iqr._firstQuartile - (range * 1.5);
+    auto upperFence = iqr._thirdQuartile + (range * 1.5);
+
+    iqr._minValue = iqr._secondQuartile;
+    iqr._maxValue = iqr._secondQuartile;
+
+    for(auto value : values)
+    {
+        // Find Maximum and minimum non-outliers
+        if(value < upperFence)
+            iqr._maxValue = std::max(iqr._maxValue, value);
+
+        if(value > lowerFence)
+            iqr._minValue = std::min(iqr._minValue, value);
+
+        if(value > upperFence || value < lowerFence)
+            iqr._outliers.push_back(value);
+    }
+
+    iqr._minOutlier = iqr._minValue;
+    iqr._maxOutlier = iqr._maxValue;
+
+    if(!iqr._outliers.empty())
+    {
+        auto minmax = std::minmax_element(iqr._outliers.begin(), iqr._outliers.end());
+        iqr._minOutlier = *minmax.first;
+        iqr._maxOutlier = *minmax.second;
+    }
+
+    if(iqr._outliers.size() > IQRStatistics::maxOutliers)
+    {
+        iqr._outliers = u::randomSample(iqr._outliers, IQRStatistics::maxOutliers);
+
+        // Ensure the minimum and maximum outliers are included
+        iqr._outliers.push_back(iqr._minOutlier);
+        iqr._outliers.push_back(iqr._maxOutlier);
+    }
+
+    iqr._outliers.shrink_to_fit();
+
+    return iqr;
+}
+
+ColumnStatistics::ColumnStatistics(ThreadPool& threadPool, const ContinuousDataMatrix& data,
+    const std::vector<double>& shifts, double epsilon, std::vector<int> rows) :
+    _threadPool(&threadPool), _data(&data), _shifts(&shifts), _epsilon(epsilon), _rows(std::move(rows)),
+    _sums(data.numColumns(), 0.0), _sumsOfSquares(data.numColumns(), 0.0)
+{
+    accumulate(_rows, 1.0);
+}
+
+void ColumnStatistics::accumulate(const std::vector<int>& rows, double sign)
+{
+    if(rows.empty())
+        return;
+
+    auto numColumns = _data->numColumns();
+    const auto& shifts = *_shifts;
+
+    struct Partial
+    {
+        std::vector<double> _sums;
+        std::vector<double> _sumsOfSquares;
+    };
+
+    std::vector<Partial> partials(numThreads(),
+        {std::vector<double>(numColumns, 0.0), std::vector<double>(numColumns, 0.0)});
+
+    _threadPool->parallel_for(rows.begin(), rows.end(), [&](int row, size_t threadIndex)
+    {
+        auto& partial = partials.at(threadIndex);
+        const auto* values = _data->row(static_cast<size_t>(row));
+
+        for(size_t column = 0; column < numColumns; column++)
+        {
+            auto value = values[column] - shifts[column];
+
+            partial._sums[column] += value;
+            partial._sumsOfSquares[column] += value * value;
+        }
+    });
+
+    for(const auto& partial : partials)
+    {
+        for(size_t column = 0; column < numColumns; column++)
+        {
+            _sums[column] += sign * partial._sums[column];
+            _sumsOfSquares[column] += sign * partial._sumsOfSquares[column];
+        }
+    }
+}
+
+void ColumnStatistics::update(std::vector<int> rows)
+{
+    std::vector<int> added;
+    std::vector<int> removed;
+
+    std::set_difference(rows.begin(), rows.end(), _rows.begin(), _rows.end(), std::back_inserter(added));
+    std::set_difference(_rows.begin(), _rows.end(), rows.begin(), rows.end(), std::back_inserter(removed));
+
+    _rows = std::move(rows);
+
+    if(added.empty() && removed.empty())
+        return;
+
+    if(_rows.empty())
+    {
+        // Avoid leaving behind any accumulated rounding error
+        std::fill(_sums.begin(), _sums.end(), 0.0);
+        std::fill(_sumsOfSquares.begin(), _sumsOfSquares.end(), 0.0);
+    }
+    else
+    {
+        accumulate(added, 1.0);
+        accumulate(removed, -1.0);
+    }
+
+    _iqrs.reset();
+    _logScaledIqrs.reset();
+}
+
+double ColumnStatistics::mean(size_t column) const
+{
+    return (*_shifts)[column] + (_sums[column] / static_cast<double>(_rows.size()));
+}
+
+std::vector<double> ColumnStatistics::means() const
+{
+    std::vector<double> means(_sums.size());
+
+    for(size_t column = 0; column < means.size(); column++)
+        means[column] = mean(column);
+
+    return means;
+}
+
+double ColumnStatistics::sumOfSquaredDeviationsFrom(size_t column, double centre) const
+{
+    // ∑(x - c)² = ∑((x - k) - d)² = ∑(x - k)² - 2d∑(x - k) + nd², where d = c - k
+    auto d = centre - (*_shifts)[column];
+    auto n = static_cast<double>(_rows.size());
+    auto sumOfSquaredDeviations = _sumsOfSquares[column] - (2.0 * d * _sums[column]) + (n * d * d);
+
+    // Rounding may push a (near) zero result slightly negative
+    return std::max(sumOfSquaredDeviations, 0.0);
+}
+
+const std::vector<IQRStatistics>& ColumnStatistics::iqrs(bool logScaled)
+{
+    auto& iqrs = logScaled ? _logScaledIqrs : _iqrs;
+
+    if(iqrs)
+        return *iqrs;
+
+    auto numColumns = _data->numColumns();
+    iqrs.emplace(numColumns);
+
+    std::vector<size_t> columns(numColumns);
+    std::iota(columns.begin(), columns.end(), 0);
+
+    // Reuse a buffer per thread, to avoid allocating for every column
+    std::vector<std::vector<double>> buffers(numThreads());
+
+    _threadPool->parallel_for(columns.begin(), columns.end(), [&](size_t column, size_t threadIndex)
+    {
+        auto& values = buffers.at(threadIndex);
+        values.clear();
+        values.reserve(_rows.size());
+
+        for(auto row : _rows)
+        {
+            auto value = _data->valueAt(static_cast<size_t>(row), column);
+
+            // Adding an epsilon prevents log(0) = -inf shenanigans
+            if(logScaled)
+                value = std::log(value + _epsilon);
+
+            values.push_back(value);
+        }
+
+        (*iqrs)[column] = iqrStatisticsOf(values);
+    });
+
+    return *iqrs;
+}
+
+std::vector<double> ColumnStatistics::medians()
+{
+    const auto& iqrs = this->iqrs();
+
+    std::vector<double> medians;
+    medians.reserve(iqrs.size());
+
+    for(const auto& iqr : iqrs)
+        medians.push_back(iqr._secondQuartile);
+
+    return medians;
+}
+
+void ColumnStatisticsCache::setData(const ContinuousDataMatrix& data, double epsilon)
+{
+    if(_data == &data && _numRows == data.numRows() &&
+        _numColumns == data.numColumns() && _epsilon == epsilon) // NOLINT clang-diagnostic-float-equal
+    {
+        return;
+    }
+
+    clear();
+
+    _data = &data;
+    _numRows = data.numRows();
+    _numColumns = data.numColumns();
+    _epsilon = epsilon;
+
+    // Shift by the means of the whole data set; any value that is representative of
+    // a column will do, but the closer it is to the mean of a subset, the less error
+    std::vector<int> allRows(_numRows);
+    std::iota(allRows.begin(), allRows.end(), 0);
+
+    _shifts.assign(_numColumns, 0.0);
+    ColumnStatistics all(*_threadPool, data, _shifts, _epsilon, std::move(allRows));
+
+    if(all.numRows() > 0)
+        _shifts = all.means();
+}
+
+void ColumnStatisticsCache::clear()
+{
+    _entries.clear();
+}
+
+ColumnStatistics& ColumnStatisticsCache::statisticsFor(const QVector<int>& rows)
+{
+    Q_ASSERT(_data != nullptr);
+
+    std::vector<int> sortedRows(rows.begin(), rows.end());
+    std::sort(sortedRows.begin(), sortedRows.end());
+
+    auto closest = _entries.end();
+    auto closestDistance = std::numeric_limits<size_t>::max();
+
+    for(auto it = _entries.begin(); it != _entries.end(); ++it)
+    {
+        const auto& entryRows = it->rows();
+
+        if(entryRows == sortedRows)
+        {
+            _entries.splice(_entries.begin(), _entries, it);
+            return _entries.front();
+        }
+
+        std::vector<int> difference;
+        std::set_symmetric_difference(entryRows.begin(), entryRows.end(),
+            sortedRows.begin(), sortedRows.end(), std::back_inserter(difference));
+
+        if(difference.size() < closestDistance)
+        {
+            closest = it;
+            closestDistance = difference.size();
+        }
+    }
+
+    if(closest != _entries.end() && closestDistance < sortedRows.size())
+    {
+        _entries.push_front(*closest);
+        _entries.front().update(std::move(sortedRows));
+    }
+    else
+        _entries.emplace_front(*_threadPool, *_data, _shifts, _epsilon, std::move(sortedRows));
+
+    if(_entries.size() > maxEntries)
+        _entries.pop_back();
+
+    return _entries.front();
+}
@@ -0,0 +1,137 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COLUMNSTATISTICS_H
+#define COLUMNSTATISTICS_H
+
+#include "correlationdatavector.h"
+
+#include <QVector>
+
+#include <vector>
+#include <list>
+#include <optional>
+#include <cstddef>
+
+class ThreadPool;
+
+// The quartiles of a set of values, along with the whiskers and outliers of its box plot;
+// the whiskers are the most extreme values that lie within 1.5 IQR of the quartiles and
+// anything beyond them is an outlier
+struct IQRStatistics
+{
+    size_t _numValues = 0;
+
+    double _firstQuartile = 0.0;
+    double _secondQuartile = 0.0;
+    double _thirdQuartile = 0.0;
+
+    double _minValue = 0.0;
+    double _maxValue = 0.0;
+
+    // If there are no outliers, these are the same as the whiskers
+    double _minOutlier = 0.0;
+    double _maxOutlier = 0.0;
+
+    // At most maxOutliers, randomly sampled, plus the minimum and maximum
+    std::vector<double> _outliers;
+
+    static constexpr size_t maxOutliers = 100;
+};
+
+// Computes the IQRStatistics of values by selection, reordering them in the process
+IQRStatistics iqrStatisticsOf(std::vector<double>& values);
+
+// Per column statistics of the continuous data, over a subset of its rows. The sums are
+// taken relative to a per column shift, which avoids catastrophic cancellation when the
+// sums of squares are used to compute deviations, and allows rows to be added to or
+// removed from the subset incrementally, without revisiting the rest of it. Quartiles
+// are computed on demand and retained until the subset changes.
+class ColumnStatistics
+{
+private:
+    ThreadPool* _threadPool = nullptr;
+    const ContinuousDataMatrix* _data = nullptr;
+    const std::vector<double>* _shifts = nullptr;
+    double _epsilon = 0.0;
+
+    std::vector<int> _rows;
+
+    std::vector<double> _sums;
+    std::vector<double> _sumsOfSquares;
+
+    std::optional<std::vector<IQRStatistics>> _iqrs;
+    std::optional<std::vector<IQRStatistics>> _logScaledIqrs;
+
+    void accumulate(const std::vector<int>& rows, double sign);
+
+public:
+    // rows must be sorted
+    ColumnStatistics(ThreadPool& threadPool, const ContinuousDataMatrix& data,
+        const std::vector<double>& shifts, double epsilon, std::vector<int> rows);
+
+    const std::vector<int>& rows() const { return _rows; }
+    size_t numRows() const { return _rows.size(); }
+
+    // Changes the subset of rows to rows, which must be sorted, by accounting
+    // only for the differences between it and the current subset
+    void update(std::vector<int> rows);
+
+    double mean(size_t column) const;
+    std::vector<double> means() const;
+
+    // The sum of the squared differences between each value in column and centre
+    double sumOfSquaredDeviationsFrom(size_t column, double centre) const;
+
+    // If logScaled, the quartiles are of log(value + epsilon)
+    const std::vector<IQRStatistics>& iqrs(bool logScaled = false);
+    std::vector<double> medians();
+};
+
+// The ColumnStatistics of the most recently used subsets of rows; when a new subset is
+// requested, and it differs from an existing one by fewer rows than it contains, its
+// statistics are derived from those of the existing one, rather than computed afresh;
+// the computation is spread over threadPool, which should be one that isn't shared
+// with long running work, since the statistics are typically needed by the UI thread
+class ColumnStatisticsCache
+{
+private:
+    ThreadPool* _threadPool = nullptr;
+    const ContinuousDataMatrix* _data = nullptr;
+    size_t _numRows = 0;
+    size_t _numColumns = 0;
+    double _epsilon = 0.0;
+
+    std::vector<double> _shifts;
+
+    // Most recently used first
+    std::list<ColumnStatistics> _entries;
+
+    static constexpr size_t maxEntries = 32;
+
+public:
+    explicit ColumnStatisticsCache(ThreadPool& threadPool) : _threadPool(&threadPool) {}
+
+    // Does nothing if data is unchanged since the last call
+    void setData(const ContinuousDataMatrix& data, double epsilon);
+    void clear();
+
+    ColumnStatistics& statisticsFor(const QVector<int>& rows);
+};
+
+#endif // COLUMNSTATISTICS_H
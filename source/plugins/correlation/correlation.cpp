@@ -17,6 +17,14 @@
  */
 
 #include "correlation.h"
+#include "distancekernels.h"
+
+#include "shared/utils/statistics.h"
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
 
 std::unique_ptr<ContinuousCorrelation> ContinuousCorrelation::create(CorrelationType correlationType)
 {
@@ -45,84 +53,71 @@ std::unique_ptr<DiscreteCorrelation> DiscreteCorrelation::create(CorrelationType
     return nullptr;
 }
 
-double PearsonAlgorithm::evaluate(size_t size, const ContinuousDataVector* vectorA, const ContinuousDataVector* vectorB)
+void PearsonAlgorithm::standardise(const double* values, size_t size, double* out)
 {
-    double productSum = std::inner_product(vectorA->begin(), vectorA->end(), vectorB->begin(), 0.0);
-    double numerator = (static_cast<double>(size) * productSum) - (vectorA->sum() * vectorB->sum());
-    double denominator = vectorA->variability() * vectorB->variability();
+    // Centred and scaled to unit length, the dot product of two vectors is their r
+    auto mean = std::accumulate(values, values + size, 0.0) / static_cast<double>(size);
+    double sumSqDeviations = 0.0;
 
-    return numerator / denominator;
-}
+    for(size_t i = 0; i < size; i++)
+        sumSqDeviations += (values[i] - mean) * (values[i] - mean);
 
-double EuclideanSimilarityAlgorithm::evaluate(size_t size, const ContinuousDataVector* vectorA, const ContinuousDataVector* vectorB)
-{
-    double sum = 0.0;
+    // r is undefined when a vector has no variance, so make sure that it is evaluated as such
+    auto scale = sumSqDeviations > 0.0 ? 1.0 / std::sqrt(sumSqDeviations) :
+        std::numeric_limits<double>::quiet_NaN();
 
     for(size_t i = 0; i < size; i++)
-    {
-        auto diff = vectorA->valueAt(i) - vectorB->valueAt(i);
-        auto diffSq = diff * diff;
-        sum += diffSq;
-    }
+        out[i] = (values[i] - mean) * scale;
+}
 
+double EuclideanSimilarityAlgorithm::evaluate(size_t size, const ContinuousDataVector* vectorA, const ContinuousDataVector* vectorB)
+{
+    auto sum = squaredEuclideanDistance(vectorA->data(), vectorB->data(), size);
     auto sqrtSum = sum != 0.0 ? std::sqrt(sum) : 0.0;
 
     return 1.0 / (1.0 + sqrtSum);
 }
 
-double CosineSimilarityAlgorithm::evaluate(size_t, const ContinuousDataVector* vectorA, const ContinuousDataVector* vectorB)
+void CosineSimilarityAlgorithm::standardise(const double* values, size_t size, double* out)
 {
-    double productSum = std::inner_product(vectorA->begin(), vectorA->end(), vectorB->begin(), 0.0);
-    double magnitudeProduct = vectorA->magnitude() * vectorB->magnitude();
+    auto magnitude = std::sqrt(std::inner_product(values, values + size, values, 0.0));
+
+    // Zero length vectors are dissimilar to everything
+    auto scale = magnitude > 0.0 ? 1.0 / magnitude : 0.0;
 
-    return magnitudeProduct > 0.0 ? productSum / magnitudeProduct : 0.0;
+    for(size_t i = 0; i < size; i++)
+        out[i] = values[i] * scale;
 }
 
-void BicorAlgorithm::preprocess(size_t size, const ContinuousDataVectors& vectors)
+void BicorAlgorithm::standardise(const double* values, size_t size, double* out)
 {
-    _base = &vectors.front();
-    _processedVectors.resize(vectors.size());
+    // The medians are found by selection, in per thread scratch space
+    thread_local std::vector<double> scratch;
 
-    for(size_t i = 0; const auto& vector : vectors)
-    {
-        auto median = u::medianOf(vector.data());
-
-        std::vector<double> absDiffs(size);
-        std::vector<double> intermediate(size);
-
-        for(size_t j = 0; auto value : vector)
-        {
-            intermediate[j] = value - median;
-            absDiffs[j] = std::abs(intermediate[j]);
-            j++;
-        }
+    scratch.assign(values, values + size);
+    auto median = u::medianOfInPlace(scratch);
 
-        auto mad = u::medianOf(absDiffs);
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] = values[i] - median;
+        scratch[i] = std::abs(out[i]);
+    }
 
-        for(size_t j = 0; auto value : intermediate)
-        {
-            auto u = value / (9.0 * mad);
-            auto v = 1 - (u * u);
-            auto newValue = value * (v * v) * (v > 0.0 ? 1.0 : 0.0);
+    auto mad = u::medianOfInPlace(scratch);
+    double sumSq = 0.0;
 
-            intermediate[j++] = newValue;
-        }
+    for(size_t i = 0; i < size; i++)
+    {
+        auto u = out[i] / (9.0 * mad);
+        auto v = 1 - (u * u);
+        out[i] = out[i] * (v * v) * (v > 0.0 ? 1.0 : 0.0);
 
-        auto& processedVector = _processedVectors.at(i++);
-        processedVector = {intermediate, vector.nodeId(), vector.computeCostHint()};
-        processedVector.update();
+        sumSq += out[i] * out[i];
     }
-}
 
-double BicorAlgorithm::evaluate(size_t, const ContinuousDataVector* vectorA, const ContinuousDataVector* vectorB)
-{
-    auto a = std::distance(_base, vectorA);
-    auto b = std::distance(_base, vectorB);
-    const auto& processedVectorA = _processedVectors.at(a);
-    const auto& processedVectorB = _processedVectors.at(b);
-
-    double productSum = std::inner_product(processedVectorA.begin(), processedVectorA.end(),
-        processedVectorB.begin(), 0.0);
+    // As with Pearson, a vector with no magnitude has an undefined correlation
+    auto scale = sumSq > 0.0 ? 1.0 / std::sqrt(sumSq) : std::numeric_limits<double>::quiet_NaN();
 
-    return productSum / (processedVectorA.magnitude() * processedVectorB.magnitude());
+    for(size_t i = 0; i < size; i++)
+        out[i] *= scale;
 }
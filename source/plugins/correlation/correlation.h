@@ -21,6 +21,13 @@
 
 #include "correlationdatavector.h"
 #include "correlationtype.h"
+#include "standardisedrows.h"
+#include "correlationpruner.h"
+#include "distancekernels.h"
+#include "nearestneighbours.h"
+#include "nndescent.h"
+#include "correlationedges.h"
+#include "bitpackedrows.h"
 
 #include "shared/utils/progressable.h"
 #include "shared/utils/cancellable.h"
@@ -33,7 +40,11 @@
 
 #include <vector>
 #include <iterator>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <type_traits>
+#include <optional>
 
 #include <QObject>
 #include <QString>
@@ -51,11 +62,49 @@ public:
 
 class ContinuousCorrelation : public ICorrelation
 {
+protected:
+    bool _singlePrecision = false;
+    size_t _numNearestNeighbours = 0;
+    bool _approximateNearestNeighbours = false;
+    double _nearestNeighboursAccuracy = 0.5;
+    CorrelationPruning _pruning = CorrelationPruning::None;
+    size_t _memoryLimit = CorrelationEdges::DefaultMemoryLimit;
+
 public:
-    virtual EdgeList edgeList(const ContinuousDataVectors& vectors, double minimumThreshold,
+    // Where supported, compute using floats rather than doubles; this uses
+    // half the memory and is faster, but is less accurate
+    void setSinglePrecision(bool singlePrecision) { _singlePrecision = singlePrecision; }
+
+    // If non-zero, only the edges that are amongst the k most significant of
+    // either of the vectors they connect are returned, i.e. the k-NN graph
+    void setNumNearestNeighbours(size_t k) { _numNearestNeighbours = k; }
+
+    // Where supported, approximate the k-NN graph using NN-descent, rather than evaluating
+    // every pair of vectors; accuracy, in [0, 1], trades speed for recall
+    void setApproximateNearestNeighbours(bool approximate, double accuracy = 0.5)
+    {
+        _approximateNearestNeighbours = approximate;
+        _nearestNeighboursAccuracy = accuracy;
+    }
+
+    // Where supported, avoid evaluating pairs of vectors that can't exceed the threshold;
+    // approximate pruning is much more aggressive, but may miss some marginal correlations
+    void setPruning(CorrelationPruning pruning) { _pruning = pruning; }
+
+    // The amount of memory the resultant edges may occupy, before they spill to disk
+    void setMemoryLimit(size_t memoryLimit) { _memoryLimit = memoryLimit; }
+
+    virtual CorrelationEdges edges(const ContinuousDataVectors& vectors, double minimumThreshold,
         CorrelationPolarity polarity = CorrelationPolarity::Positive,
         Cancellable* cancellable = nullptr, Progressable* progressable = nullptr) const = 0;
 
+    EdgeList edgeList(const ContinuousDataVectors& vectors, double minimumThreshold,
+        CorrelationPolarity polarity = CorrelationPolarity::Positive,
+        Cancellable* cancellable = nullptr, Progressable* progressable = nullptr) const
+    {
+        return edges(vectors, minimumThreshold, polarity, cancellable, progressable).toEdgeList();
+    }
+
     virtual CovarianceMatrix matrix(const ContinuousDataVectors& vectors,
         Cancellable* cancellable = nullptr, Progressable* progressable = nullptr) const = 0;
 
@@ -72,7 +121,10 @@ template<typename Algorithm, VectorType vectorType = VectorType::Raw>
 class CovarianceCorrelation : public ContinuousCorrelation
 {
     template<typename A>
-    using preprocess_t = decltype(std::declval<A>().preprocess(0, ContinuousDataVectors{}));
+    using standardise_t = decltype(std::declval<A>().standardise(nullptr, size_t{}, nullptr));
+
+    static constexpr bool AlgorithmCanStandardise =
+        std::experimental::is_detected_v<standardise_t, Algorithm>;
 
 private:
     struct ContinuousDataVectorRelation
@@ -84,35 +136,42 @@ private:
 
     using CorrelationList = std::vector<ContinuousDataVectorRelation>;
 
-    auto process(const ContinuousDataVectors& vectors,
-        double minimumThreshold, CorrelationPolarity polarity = CorrelationPolarity::Positive,
-        Cancellable* cancellable = nullptr, Progressable* progressable = nullptr) const
+    static bool exceedsThreshold(double r, double minimumThreshold, CorrelationPolarity polarity)
     {
-        size_t size = vectors.front().size();
+        switch(polarity)
+        {
+        default:
+        case CorrelationPolarity::Positive: return r >= minimumThreshold;
+        case CorrelationPolarity::Negative: return r <= -minimumThreshold;
+        case CorrelationPolarity::Both:     return std::abs(r) >= minimumThreshold;
+        }
+    }
 
-        if(progressable != nullptr)
-            progressable->setProgress(-1);
+    // Each pair of vectors is evaluated individually
+    auto processPairwise(const ContinuousDataVectors& vectors,
+        double minimumThreshold, CorrelationPolarity polarity,
+        Cancellable* cancellable, Progressable* progressable,
+        NearestNeighbours* nearestNeighbours, CorrelationEdges* correlationEdges) const
+    {
+        size_t size = vectors.front().size();
 
         uint64_t totalCost = 0;
         for(const auto& vector : vectors)
-        {
             totalCost += vector.computeCostHint();
 
-            if constexpr(vectorType == VectorType::Ranking)
-                vector.generateRanking();
+        ThreadPool threadPool(QStringLiteral("Correlation"));
+
+        if constexpr(vectorType == VectorType::Ranking)
+        {
+            threadPool.parallel_for(vectors.begin(), vectors.end(),
+                [](const ContinuousDataVector& vector) { vector.generateRanking(); });
         }
 
         Algorithm algorithm;
 
-        constexpr bool AlgorithmHasPreprocess =
-            std::experimental::is_detected_v<preprocess_t, Algorithm>;
-
-        if constexpr(AlgorithmHasPreprocess)
-            algorithm.preprocess(size, vectors);
-
         std::atomic<uint64_t> cost(0);
 
-        auto results = ThreadPool(QStringLiteral("Correlation")).parallel_for(vectors.begin(), vectors.end(),
+        return threadPool.parallel_for(vectors.begin(), vectors.end(),
         [&](ContinuousDataVectors::const_iterator vectorAIt)
         {
             const auto* vectorA = &(*vectorAIt);
@@ -125,6 +184,10 @@ private:
             if(cancellable != nullptr && cancellable->cancelled())
                 return correlations;
 
+            std::optional<CorrelationEdges::Writer> writer;
+            if(correlationEdges != nullptr)
+                writer.emplace(*correlationEdges);
+
             for(auto vectorBIt = vectorAIt + 1; vectorBIt != vectors.end(); ++vectorBIt)
             {
                 const auto* vectorB = &(*vectorBIt);
@@ -134,20 +197,17 @@ private:
 
                 double r = algorithm.evaluate(size, vectorA, vectorB);
 
-                if(!std::isfinite(r))
+                if(!std::isfinite(r) || !exceedsThreshold(r, minimumThreshold, polarity))
                     continue;
 
-                bool exceedsThreshold = false;
-
-                switch(polarity)
+                if(nearestNeighbours != nullptr)
                 {
-                default:
-                case CorrelationPolarity::Positive: exceedsThreshold = (r >= minimumThreshold); break;
-                case CorrelationPolarity::Negative: exceedsThreshold = (r <= -minimumThreshold); break;
-                case CorrelationPolarity::Both:     exceedsThreshold = (std::abs(r) >= minimumThreshold); break;
+                    nearestNeighbours->add(static_cast<size_t>(std::distance(vectors.begin(), vectorAIt)),
+                        static_cast<size_t>(std::distance(vectors.begin(), vectorBIt)), r);
                 }
-
-                if(exceedsThreshold)
+                else if(writer)
+                    writer->add(vectorAIt->nodeId(), vectorBIt->nodeId(), r);
+                else
                     correlations.push_back({vectorAIt, vectorBIt, r});
             }
 
@@ -158,6 +218,264 @@ private:
 
             return correlations;
         });
+    }
+
+    // Each vector is standardised such that any correlation is simply a dot product
+    template<typename T>
+    static StandardisedRows<T> standardisedRows(const ContinuousDataVectors& vectors, ThreadPool& threadPool)
+    {
+        StandardisedRows<T> rows(vectors.size(), vectors.front().size());
+
+        // Any ranking and standardisation is done concurrently, straight into the rows,
+        // with per thread scratch space, so that no per vector allocations are necessary
+        threadPool.parallel_for(vectors.begin(), vectors.end(),
+        [&](ContinuousDataVectors::const_iterator vectorIt)
+        {
+            const double* values = vectorIt->data();
+            auto size = vectorIt->size();
+
+            if constexpr(vectorType == VectorType::Ranking)
+            {
+                thread_local std::vector<double> ranks;
+                ranks.resize(size);
+
+                vectorIt->rankInto(ranks.data());
+                values = ranks.data();
+            }
+
+            auto index = static_cast<size_t>(std::distance(vectors.begin(), vectorIt));
+
+            if constexpr(std::is_same_v<T, double>)
+                Algorithm::standardise(values, size, rows.row(index));
+            else
+            {
+                // Standardise at full precision, then narrow
+                thread_local std::vector<double> standardised;
+                standardised.resize(size);
+
+                Algorithm::standardise(values, size, standardised.data());
+                std::copy(standardised.begin(), standardised.end(), rows.row(index));
+            }
+        });
+
+        return rows;
+    }
+
+    // The vectors are standardised up front such that each correlation is a dot product,
+    // meaning the whole correlation matrix is the product of the standardised matrix and
+    // its transpose, which is then computed in cache sized tiles
+    template<typename T>
+    auto processTiled(const ContinuousDataVectors& vectors,
+        double minimumThreshold, CorrelationPolarity polarity,
+        Cancellable* cancellable, Progressable* progressable,
+        NearestNeighbours* nearestNeighbours, CorrelationEdges* correlationEdges) const
+    {
+        ThreadPool threadPool(QStringLiteral("Correlation"));
+        auto rows = standardisedRows<T>(vectors, threadPool);
+
+        // Pruning relies on the threshold excluding uncorrelated pairs
+        std::optional<CorrelationPruner<T>> pruner;
+        if(_pruning != CorrelationPruning::None && minimumThreshold > 0.0)
+            pruner.emplace(rows, _pruning, minimumThreshold, polarity, threadPool);
+
+        auto numRows = pruner ? pruner->numRows() : rows.numRows();
+
+        struct Tile
+        {
+            size_t _rowA = 0;
+            size_t _rowB = 0;
+        };
+
+        // Only the upper triangle of the (symmetric) correlation matrix is required
+        auto tileSize = rows.tileSize();
+        std::vector<size_t> tileRows;
+        for(size_t row = 0; row < numRows; row += tileSize)
+            tileRows.push_back(row);
+
+        std::vector<Tile> tiles;
+
+        if(!tileRows.empty())
+        {
+            // Bounding the tiles is a quadratic operation in itself, hence doing so concurrently
+            auto tileResults = threadPool.parallel_for(tileRows.begin(), tileRows.end(),
+            [&](size_t rowA)
+            {
+                std::vector<Tile> rowTiles;
+
+                for(size_t rowB = rowA; rowB < numRows; rowB += tileSize)
+                {
+                    if(!pruner || !pruner->tilesCanBeSkipped(rowA, rowB))
+                        rowTiles.push_back({rowA, rowB});
+                }
+
+                return rowTiles;
+            });
+
+            for(const auto& tile : tileResults)
+                tiles.push_back(tile);
+        }
+
+        std::atomic<uint64_t> numTilesProcessed(0);
+
+        return threadPool.parallel_for(tiles.begin(), tiles.end(),
+        [&](const Tile& tile)
+        {
+            CorrelationList correlations;
+
+            if(cancellable != nullptr && cancellable->cancelled())
+                return correlations;
+
+            auto numRowsA = std::min(tileSize, numRows - tile._rowA);
+            auto numRowsB = std::min(tileSize, numRows - tile._rowB);
+
+            std::optional<CorrelationEdges::Writer> writer;
+            if(correlationEdges != nullptr)
+                writer.emplace(*correlationEdges);
+
+            auto addCorrelation = [&](size_t rowA, size_t rowB, double r)
+            {
+                if(!std::isfinite(r) || !exceedsThreshold(r, minimumThreshold, polarity))
+                    return;
+
+                auto indexA = pruner ? pruner->originalIndexOf(rowA) : rowA;
+                auto indexB = pruner ? pruner->originalIndexOf(rowB) : rowB;
+
+                if(indexA > indexB)
+                    std::swap(indexA, indexB);
+
+                if(nearestNeighbours != nullptr)
+                {
+                    nearestNeighbours->add(indexA, indexB, r);
+                    return;
+                }
+
+                auto vectorAIt = vectors.begin() + static_cast<std::ptrdiff_t>(indexA);
+                auto vectorBIt = vectors.begin() + static_cast<std::ptrdiff_t>(indexB);
+
+                if(writer)
+                    writer->add(vectorAIt->nodeId(), vectorBIt->nodeId(), r);
+                else
+                    correlations.push_back({vectorAIt, vectorBIt, r});
+            };
+
+            auto multiplyTile = [&]
+            {
+                thread_local std::vector<T> tileValues;
+                rows.multiplyTile(tile._rowA, numRowsA, tile._rowB, numRowsB, tileValues);
+
+                for(size_t a = 0; a < numRowsA; a++)
+                {
+                    // On the diagonal, avoid self correlation and duplicates
+                    size_t firstB = tile._rowA == tile._rowB ? a + 1 : 0;
+
+                    for(size_t b = firstB; b < numRowsB; b++)
+                    {
+                        addCorrelation(tile._rowA + a, tile._rowB + b,
+                            static_cast<double>(tileValues[(a * numRowsB) + b]));
+                    }
+                }
+            };
+
+            if(pruner && pruner->approximate())
+            {
+                thread_local std::vector<std::pair<size_t, size_t>> candidates;
+                candidates.clear();
+
+                for(size_t a = 0; a < numRowsA; a++)
+                {
+                    size_t firstB = tile._rowA == tile._rowB ? a + 1 : 0;
+
+                    for(size_t b = firstB; b < numRowsB; b++)
+                    {
+                        if(pruner->isCandidate(tile._rowA + a, tile._rowB + b))
+                            candidates.emplace_back(tile._rowA + a, tile._rowB + b);
+                    }
+                }
+
+                // When there are relatively few candidates, evaluating them individually
+                // is cheaper than multiplying out the whole tile
+                if(candidates.size() * 8 < numRowsA * numRowsB)
+                {
+                    for(const auto& [rowA, rowB] : candidates)
+                    {
+                        addCorrelation(rowA, rowB, static_cast<double>(
+                            dotProduct(rows.row(rowA), rows.row(rowB), rows.numColumns())));
+                    }
+                }
+                else
+                    multiplyTile();
+            }
+            else
+                multiplyTile();
+
+            if(progressable != nullptr)
+                progressable->setProgress(static_cast<int>((++numTilesProcessed * 100) / tiles.size()));
+
+            return correlations;
+        });
+    }
+
+    // The (approximate) k-NN graph is found by NN-descent, over the standardised vectors
+    template<typename T>
+    CorrelationEdges processApproximateNearestNeighbours(const ContinuousDataVectors& vectors,
+        double minimumThreshold, CorrelationPolarity polarity,
+        Cancellable* cancellable, Progressable* progressable) const
+    {
+        if(progressable != nullptr)
+            progressable->setProgress(-1);
+
+        ThreadPool threadPool(QStringLiteral("Correlation"));
+        auto rows = standardisedRows<T>(vectors, threadPool);
+
+        NNDescent<T> nnDescent(rows, _numNearestNeighbours, polarity, _nearestNeighboursAccuracy);
+        auto relations = nnDescent.relations(threadPool, cancellable, progressable);
+
+        if(cancellable != nullptr && cancellable->cancelled())
+            return CorrelationEdges(_memoryLimit);
+
+        CorrelationEdges correlationEdges(_memoryLimit);
+        CorrelationEdges::Writer writer(correlationEdges);
+
+        for(const auto& relation : relations)
+        {
+            if(exceedsThreshold(relation._r, minimumThreshold, polarity))
+                writer.add(vectors.at(relation._a).nodeId(), vectors.at(relation._b).nodeId(), relation._r);
+        }
+
+        writer.flush();
+
+        return correlationEdges;
+    }
+
+    // If nearestNeighbours or correlationEdges is supplied, correlations
+    // are passed to it rather than returned
+    auto process(const ContinuousDataVectors& vectors,
+        double minimumThreshold, CorrelationPolarity polarity = CorrelationPolarity::Positive,
+        Cancellable* cancellable = nullptr, Progressable* progressable = nullptr,
+        NearestNeighbours* nearestNeighbours = nullptr, CorrelationEdges* correlationEdges = nullptr) const
+    {
+        if(progressable != nullptr)
+            progressable->setProgress(-1);
+
+        auto results = [&]
+        {
+            if constexpr(AlgorithmCanStandardise)
+            {
+                if(_singlePrecision)
+                {
+                    return processTiled<float>(vectors, minimumThreshold, polarity,
+                        cancellable, progressable, nearestNeighbours, correlationEdges);
+                }
+
+                return processTiled<double>(vectors, minimumThreshold, polarity,
+                    cancellable, progressable, nearestNeighbours, correlationEdges);
+            }
+            else
+            {
+                return processPairwise(vectors, minimumThreshold, polarity,
+                    cancellable, progressable, nearestNeighbours, correlationEdges);
+            }
+        }();
 
         if(progressable != nullptr)
         {
@@ -169,28 +487,53 @@ private:
     }
 
 public:
-    EdgeList edgeList(const ContinuousDataVectors& vectors,
+    CorrelationEdges edges(const ContinuousDataVectors& vectors,
         double minimumThreshold, CorrelationPolarity polarity = CorrelationPolarity::Positive,
         Cancellable* cancellable = nullptr, Progressable* progressable = nullptr) const final
     {
-        if(vectors.empty())
-            return {};
+        CorrelationEdges correlationEdges(_memoryLimit);
 
-        auto results = process(vectors, minimumThreshold, polarity, cancellable, progressable);
+        if(vectors.empty())
+            return correlationEdges;
 
-        if(cancellable != nullptr && cancellable->cancelled())
-            return {};
+        if constexpr(AlgorithmCanStandardise)
+        {
+            if(_numNearestNeighbours > 0 && _approximateNearestNeighbours)
+            {
+                if(_singlePrecision)
+                {
+                    return processApproximateNearestNeighbours<float>(vectors,
+                        minimumThreshold, polarity, cancellable, progressable);
+                }
 
-        EdgeList edges;
-        edges.reserve(std::distance(results.begin(), results.end()));
+                return processApproximateNearestNeighbours<double>(vectors,
+                    minimumThreshold, polarity, cancellable, progressable);
+            }
+        }
 
-        std::transform(results.begin(), results.end(), std::back_inserter(edges),
-        [](const auto& result)
+        if(_numNearestNeighbours > 0)
         {
-            return EdgeListEdge{result._a->nodeId(), result._b->nodeId(), result._r};
-        });
+            NearestNeighbours nearestNeighbours(vectors.size(), _numNearestNeighbours, polarity);
+            process(vectors, minimumThreshold, polarity, cancellable, progressable, &nearestNeighbours);
+
+            if(cancellable != nullptr && cancellable->cancelled())
+                return CorrelationEdges(_memoryLimit);
+
+            CorrelationEdges::Writer writer(correlationEdges);
+            for(const auto& relation : nearestNeighbours.relations())
+                writer.add(vectors.at(relation._a).nodeId(), vectors.at(relation._b).nodeId(), relation._r);
+
+            writer.flush();
+
+            return correlationEdges;
+        }
+
+        process(vectors, minimumThreshold, polarity, cancellable, progressable, nullptr, &correlationEdges);
+
+        if(cancellable != nullptr && cancellable->cancelled())
+            return CorrelationEdges(_memoryLimit);
 
-        return edges;
+        return correlationEdges;
     }
 
     CovarianceMatrix matrix(const ContinuousDataVectors& vectors,
@@ -219,7 +562,7 @@ public:
 
 struct PearsonAlgorithm
 {
-    double evaluate(size_t size, const ContinuousDataVector* vectorA, const ContinuousDataVector* vectorB);
+    static void standardise(const double* values, size_t size, double* out);
 };
 
 class PearsonCorrelation : public CovarianceCorrelation<PearsonAlgorithm>
@@ -289,7 +632,7 @@ public:
 
 struct CosineSimilarityAlgorithm
 {
-    double evaluate(size_t, const ContinuousDataVector* vectorA, const ContinuousDataVector* vectorB);
+    static void standardise(const double* values, size_t size, double* out);
 };
 
 class CosineSimilarityCorrelation : public CovarianceCorrelation<CosineSimilarityAlgorithm>
@@ -315,11 +658,7 @@ public:
 
 struct BicorAlgorithm
 {
-    const ContinuousDataVector* _base = nullptr;
-    ContinuousDataVectors _processedVectors;
-
-    void preprocess(size_t size, const ContinuousDataVectors& vectors);
-    double evaluate(size_t, const ContinuousDataVector* vectorA, const ContinuousDataVector* vectorB);
+    static void standardise(const double* values, size_t size, double* out);
 };
 
 class BicorCorrelation : public CovarianceCorrelation<BicorAlgorithm>
@@ -343,122 +682,97 @@ public:
 
 class DiscreteCorrelation : public ICorrelation
 {
+protected:
+    size_t _memoryLimit = CorrelationEdges::DefaultMemoryLimit;
+
 public:
-    virtual EdgeList edgeList(const DiscreteDataVectors& vectors, double minimumThreshold, bool treatAsBinary,
+    // The amount of memory the resultant edges may occupy, before they spill to disk
+    void setMemoryLimit(size_t memoryLimit) { _memoryLimit = memoryLimit; }
+
+    virtual CorrelationEdges edges(const DiscreteDataVectors& vectors, double minimumThreshold, bool treatAsBinary,
         Cancellable* cancellable = nullptr, Progressable* progressable = nullptr) const = 0;
 
+    EdgeList edgeList(const DiscreteDataVectors& vectors, double minimumThreshold, bool treatAsBinary,
+        Cancellable* cancellable = nullptr, Progressable* progressable = nullptr) const
+    {
+        return edges(vectors, minimumThreshold, treatAsBinary, cancellable, progressable).toEdgeList();
+    }
+
     static std::unique_ptr<DiscreteCorrelation> create(CorrelationType correlationType);
 };
 
+// Denominator is the weight given to columns where neither vector has a value
 template<int Denominator>
 class MatchingCorrelation : public DiscreteCorrelation
 {
 public:
-    EdgeList edgeList(const DiscreteDataVectors& vectors, double minimumThreshold, bool treatAsBinary,
+    CorrelationEdges edges(const DiscreteDataVectors& vectors, double minimumThreshold, bool treatAsBinary,
         Cancellable* cancellable = nullptr, Progressable* progressable = nullptr) const final
     {
-        if(vectors.empty())
-            return {};
+        CorrelationEdges correlationEdges(_memoryLimit);
 
-        size_t size = vectors.front().size();
+        if(vectors.empty())
+            return correlationEdges;
 
         if(progressable != nullptr)
             progressable->setProgress(-1);
 
-        const auto tokenisedVectors = tokeniseDataVectors(vectors);
+        const BitPackedRows rows(vectors, treatAsBinary);
 
-        uint64_t totalCost = 0;
-        for(const auto& vector : vectors)
-            totalCost += vector.computeCostHint();
+        struct Tile
+        {
+            size_t _rowA = 0;
+            size_t _rowB = 0;
+        };
+
+        // Only the upper triangle of the (symmetric) correlation matrix is required
+        auto tileSize = rows.tileSize();
+        std::vector<Tile> tiles;
+        for(size_t rowA = 0; rowA < rows.numRows(); rowA += tileSize)
+        {
+            for(size_t rowB = rowA; rowB < rows.numRows(); rowB += tileSize)
+                tiles.push_back({rowA, rowB});
+        }
 
-        std::atomic<uint64_t> cost(0);
+        std::atomic<uint64_t> numTilesProcessed(0);
 
-        auto results = ThreadPool(QStringLiteral("Correlation")).parallel_for(tokenisedVectors.begin(), tokenisedVectors.end(),
-        [&](TokenisedDataVectors::const_iterator vectorAIt)
+        ThreadPool(QStringLiteral("Correlation")).parallel_for(tiles.begin(), tiles.end(),
+        [&](const Tile& tile)
         {
-            EdgeList edges;
-
             if(cancellable != nullptr && cancellable->cancelled())
-                return edges;
-
-            struct Fraction
-            {
-                int _numerator = 0;
-                int _denominator = 0;
-
-                Fraction& operator+=(const Fraction& other)
-                {
-                    _numerator += other._numerator;
-                    _denominator += other._denominator;
+                return;
 
-                    return *this;
-                }
+            CorrelationEdges::Writer writer(correlationEdges);
 
-                // NOLINTNEXTLINE google-explicit-constructor
-                operator double() const { return static_cast<double>(_numerator) / _denominator; }
-            };
-
-            auto binary = [&](auto vectorAValue, auto vectorBValue) -> Fraction
-            {
-                return {vectorAValue && vectorBValue ? 1 : 0, 1};
-            };
+            auto lastRowA = std::min(tile._rowA + tileSize, rows.numRows());
+            auto lastRowB = std::min(tile._rowB + tileSize, rows.numRows());
 
-            auto nonBinary = [&](auto vectorAValue, auto vectorBValue) -> Fraction
+            for(auto rowA = tile._rowA; rowA < lastRowA; rowA++)
             {
-                return {vectorAValue == vectorBValue ? 1 : 0, 1};
-            };
+                // On the diagonal, avoid self correlation and duplicates
+                auto firstRowB = tile._rowA == tile._rowB ? rowA + 1 : tile._rowB;
 
-            auto createEdgesForVectorPairs = [&](auto&& f)
-            {
-                for(auto vectorBIt = vectorAIt + 1; vectorBIt != tokenisedVectors.end(); ++vectorBIt)
+                for(auto rowB = firstRowB; rowB < lastRowB; rowB++)
                 {
-                    Fraction fraction;
-                    for(size_t i = 0; i < size; i++)
-                    {
-                        const auto& vectorAValue = vectorAIt->valueAt(i);
-                        const auto& vectorBValue = vectorBIt->valueAt(i);
+                    auto counts = rows.compare(rowA, rowB);
+                    auto numBothZero = rows.numColumns() - counts._numEitherNonZero;
+                    auto denominator = counts._numEitherNonZero + (Denominator * numBothZero);
 
-                        if(!vectorAValue && !vectorBValue)
-                            fraction += {0, Denominator};
-                        else
-                            fraction += f(vectorAValue, vectorBValue);
-                    }
-
-                    double r = fraction;
+                    double r = static_cast<double>(counts._numMatching) / static_cast<double>(denominator);
 
                     if(std::isfinite(r) && r >= minimumThreshold)
-                        edges.push_back({vectorAIt->nodeId(), vectorBIt->nodeId(), r});
+                        writer.add(vectors.at(rowA).nodeId(), vectors.at(rowB).nodeId(), r);
                 }
-            };
-
-            if(treatAsBinary)
-                createEdgesForVectorPairs(binary);
-            else
-                createEdgesForVectorPairs(nonBinary);
-
-            cost += vectorAIt->computeCostHint();
+            }
 
             if(progressable != nullptr)
-                progressable->setProgress(static_cast<int>((cost * 100) / totalCost));
-
-            return edges;
+                progressable->setProgress(static_cast<int>((++numTilesProcessed * 100) / tiles.size()));
         });
 
-        if(progressable != nullptr)
-        {
-            // Returning the results might take time
-            progressable->setProgress(-1);
-        }
-
         if(cancellable != nullptr && cancellable->cancelled())
-            return {};
-
-        EdgeList edges;
-        edges.reserve(std::distance(results.begin(), results.end()));
-        edges.insert(edges.end(), std::make_move_iterator(results.begin()),
-            std::make_move_iterator(results.end()));
+            return CorrelationEdges(_memoryLimit);
 
-        return edges;
+        return correlationEdges;
     }
 };
 
@@ -21,16 +21,110 @@
 #include "shared/utils/container.h"
 
 #include <algorithm>
+#include <numeric>
+#include <vector>
 #include <cmath>
+#include <span>
+#include <utility>
+
+ContinuousDataMatrix::ContinuousDataMatrix(size_t numRows, size_t numColumns) :
+    _numRows(numRows), _numColumns(numColumns)
+{
+    const size_t valuesPerAlignment = Alignment / sizeof(double);
+    _stride = ((numColumns + valuesPerAlignment - 1) / valuesPerAlignment) * valuesPerAlignment;
+
+    auto numValues = std::max(_numRows * _stride, size_t{1});
+    _values.reset(static_cast<double*>(::operator new[](numValues * sizeof(double),
+        std::align_val_t{Alignment})));
+
+    // Zero everything, including the padding, so that it's always safe to read
+    std::fill(_values.get(), _values.get() + numValues, 0.0);
+}
+
+std::vector<double> ContinuousDataMatrix::column(size_t column) const
+{
+    std::vector<double> values;
+    values.reserve(_numRows);
+
+    for(size_t r = 0; r < _numRows; r++)
+        values.push_back(valueAt(r, column));
+
+    return values;
+}
+
+std::vector<double> ContinuousDataMatrix::values() const
+{
+    std::vector<double> values;
+    values.reserve(_numRows * _numColumns);
+
+    forEachValue([&values](double value) { values.push_back(value); });
+
+    return values;
+}
+
+ContinuousDataVector::ContinuousDataVector(const ContinuousDataVector& other) :
+    _ownedValues(other._ownedValues), _values(other._values), _size(other._size),
+    _isView(other._isView), _nodeId(other._nodeId), _cost(other._cost),
+    _statistics(other._statistics), _rankingVector(other._rankingVector)
+{
+    rebind();
+}
+
+ContinuousDataVector::ContinuousDataVector(ContinuousDataVector&& other) noexcept :
+    _ownedValues(std::move(other._ownedValues)), _values(other._values), _size(other._size),
+    _isView(other._isView), _nodeId(other._nodeId), _cost(other._cost),
+    _statistics(std::move(other._statistics)), _rankingVector(std::move(other._rankingVector))
+{
+    rebind();
+}
+
+ContinuousDataVector& ContinuousDataVector::operator=(const ContinuousDataVector& other)
+{
+    if(this != &other)
+    {
+        _ownedValues = other._ownedValues;
+        _values = other._values;
+        _size = other._size;
+        _isView = other._isView;
+        _nodeId = other._nodeId;
+        _cost = other._cost;
+        _statistics = other._statistics;
+        _rankingVector = other._rankingVector;
+
+        rebind();
+    }
+
+    return *this;
+}
+
+ContinuousDataVector& ContinuousDataVector::operator=(ContinuousDataVector&& other) noexcept
+{
+    if(this != &other)
+    {
+        _ownedValues = std::move(other._ownedValues);
+        _values = other._values;
+        _size = other._size;
+        _isView = other._isView;
+        _nodeId = other._nodeId;
+        _cost = other._cost;
+        _statistics = std::move(other._statistics);
+        _rankingVector = std::move(other._rankingVector);
+
+        rebind();
+    }
+
+    return *this;
+}
 
 void ContinuousDataVector::update()
 {
-    _statistics = u::findStatisticsFor(_data);
+    _statistics = u::findStatisticsFor(std::span<const double>(_values, _size));
 }
 
 void ContinuousDataVector::generateRanking() const
 {
-    _rankingVector = std::make_shared<ContinuousDataVector>(u::rankingOf(_data), _nodeId, _cost);
+    std::vector<double> values(begin(), end());
+    _rankingVector = std::make_shared<ContinuousDataVector>(u::rankingOf(values), _nodeId, _cost);
     _rankingVector->update();
 }
 
@@ -38,3 +132,61 @@ const ContinuousDataVector* ContinuousDataVector::ranking() const
 {
     return _rankingVector.get();
 }
+
+void ContinuousDataVector::rankInto(double* out) const
+{
+    thread_local std::vector<size_t> indices;
+    indices.resize(_size);
+    std::iota(indices.begin(), indices.end(), 0);
+
+    std::sort(indices.begin(), indices.end(),
+        [this](size_t a, size_t b) { return _values[a] < _values[b]; });
+
+    for(size_t first = 0; first < indices.size();)
+    {
+        auto last = first + 1;
+        while(last < indices.size() && _values[indices[last]] == _values[indices[first]])
+            last++;
+
+        // Ranks are 1-based, so the tied values share the mean of first + 1 to last
+        auto rank = static_cast<double>(first + last + 1) / 2.0;
+        for(auto i = first; i < last; i++)
+            out[indices[i]] = rank;
+
+        first = last;
+    }
+}
+
+DiscreteDataDictionary::DiscreteDataDictionary()
+{
+    codeFor({});
+}
+
+DiscreteDataDictionary::Code DiscreteDataDictionary::codeFor(const QString& value)
+{
+    auto it = _codes.constFind(value);
+    if(it != _codes.constEnd())
+        return it.value();
+
+    auto code = static_cast<Code>(_values.size());
+    _values.push_back(value);
+    _codes.insert(value, code);
+
+    if(value.isEmpty() || value == u"0" || value == u"false")
+        _tokens.push_back(0);
+    else
+        _tokens.push_back(++_maxToken);
+
+    return code;
+}
+
+std::vector<DiscreteDataDictionary::Code> DiscreteDataDictionary::sortedCodes() const
+{
+    std::vector<Code> codes(_values.size());
+    std::iota(codes.begin(), codes.end(), 0);
+
+    std::sort(codes.begin(), codes.end(),
+        [this](Code a, Code b) { return _values[a] < _values[b]; });
+
+    return codes;
+}
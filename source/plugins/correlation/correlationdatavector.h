@@ -27,10 +27,13 @@
 #include <limits>
 #include <iterator>
 #include <memory>
-#include <map>
 #include <type_traits>
+#include <new>
+#include <span>
 
 #include <QString>
+#include <QHash>
+#include <QtGlobal>
 
 template<typename T>
 class CorrelationDataVector
@@ -100,14 +103,148 @@ public:
     virtual void update() {}
 };
 
-class ContinuousDataVector : public CorrelationDataVector<double>
+// All of the continuous data rows of a data set, in a single row-major allocation; each row
+// is padded so that it begins on a boundary that is suitably aligned for SIMD loads
+class ContinuousDataMatrix
 {
+public:
+    static constexpr size_t Alignment = 64;
+
+private:
+    struct Deleter
+    {
+        void operator()(double* values) const
+        {
+            ::operator delete[](values, std::align_val_t{Alignment});
+        }
+    };
+
+    std::unique_ptr<double[], Deleter> _values;
+    size_t _numRows = 0;
+    size_t _numColumns = 0;
+    size_t _stride = 0;
+
+public:
+    ContinuousDataMatrix() = default;
+    ContinuousDataMatrix(size_t numRows, size_t numColumns);
+
+    size_t numRows() const { return _numRows; }
+    size_t numColumns() const { return _numColumns; }
+    size_t stride() const { return _stride; }
+    bool empty() const { return _numRows == 0 || _numColumns == 0; }
+
+    double* row(size_t row) { return _values.get() + (row * _stride); }
+    const double* row(size_t row) const { return _values.get() + (row * _stride); }
+
+    double valueAt(size_t row, size_t column) const
+    {
+        Q_ASSERT(row < _numRows && column < _numColumns);
+        return this->row(row)[column];
+    }
+
+    void setValueAt(size_t row, size_t column, double value)
+    {
+        Q_ASSERT(row < _numRows && column < _numColumns);
+        this->row(row)[column] = value;
+    }
+
+    std::vector<double> column(size_t column) const;
+
+    // A copy of the values, excluding the padding
+    std::vector<double> values() const;
+
+    // Calls fn for each value, excluding the padding
+    template<typename Fn>
+    void forEachValue(Fn&& fn)
+    {
+        for(size_t r = 0; r < _numRows; r++)
+        {
+            auto* values = row(r);
+            for(size_t column = 0; column < _numColumns; column++)
+                fn(values[column]);
+        }
+    }
+
+    template<typename Fn>
+    void forEachValue(Fn&& fn) const
+    {
+        for(size_t r = 0; r < _numRows; r++)
+        {
+            const auto* values = row(r);
+            for(size_t column = 0; column < _numColumns; column++)
+                fn(values[column]);
+        }
+    }
+};
+
+// A single row (or column) of continuous data; this is normally a lightweight view of a row
+// of a ContinuousDataMatrix, but can also own its values, when it needs to stand alone
+class ContinuousDataVector
+{
+public:
+    using ConstDataIterator = const double*;
+    using DataIterator = double*;
+
 private:
+    std::vector<double> _ownedValues;
+    double* _values = nullptr;
+    size_t _size = 0;
+    bool _isView = false;
+
+    NodeId _nodeId;
+    uint64_t _cost = 0;
+
     u::Statistics _statistics;
     mutable std::shared_ptr<ContinuousDataVector> _rankingVector;
 
+    void rebind() { if(!_isView) _values = _ownedValues.data(); }
+
 public:
-    using CorrelationDataVector::CorrelationDataVector;
+    ContinuousDataVector() = default;
+    ContinuousDataVector(const ContinuousDataVector& other);
+    ContinuousDataVector(ContinuousDataVector&& other) noexcept;
+    ContinuousDataVector& operator=(const ContinuousDataVector& other);
+    ContinuousDataVector& operator=(ContinuousDataVector&& other) noexcept;
+    ~ContinuousDataVector() = default;
+
+    // View of a row of a matrix
+    ContinuousDataVector(ContinuousDataMatrix& matrix, size_t row,
+        NodeId nodeId, uint64_t computeCost = 1) :
+        _values(matrix.row(row)), _size(matrix.numColumns()), _isView(true),
+        _nodeId(nodeId), _cost(computeCost)
+    {}
+
+    // Row from row-wise input
+    template<typename U>
+    ContinuousDataVector(const std::vector<U>& data, size_t row, size_t numColumns,
+        NodeId nodeId, uint64_t computeCost = 1) :
+        _ownedValues(data.cbegin() + (row * numColumns), (data.cbegin() + (row * numColumns)) + numColumns),
+        _size(numColumns), _nodeId(nodeId), _cost(computeCost)
+    {
+        rebind();
+    }
+
+    template<typename U>
+    ContinuousDataVector(const std::vector<U>& dataVector,
+        NodeId nodeId, uint64_t computeCost = 1) :
+        ContinuousDataVector(dataVector, 0, dataVector.size(), nodeId, computeCost)
+    {}
+
+    DataIterator begin() { return _values; }
+    DataIterator end() { return _values + _size; }
+
+    ConstDataIterator begin() const { return _values; }
+    ConstDataIterator end() const { return _values + _size; }
+
+    const double* data() const { return _values; }
+
+    uint64_t computeCostHint() const { return _cost; }
+
+    size_t size() const { return _size; }
+    double valueAt(size_t index) const { Q_ASSERT(index < _size); return _values[index]; }
+    void setValueAt(size_t index, double value) { Q_ASSERT(index < _size); _values[index] = value; }
+
+    NodeId nodeId() const { return _nodeId; }
 
     double sum() const { return _statistics._sum; }
     double sumSq() const { return _statistics._sumSq; }
@@ -122,64 +259,78 @@ public:
     double maxValue() const { return _statistics._max; }
     size_t largestColumnIndex() const { return _statistics._largestIndex; }
 
-    void update() override;
+    void update();
 
     void generateRanking() const;
     const ContinuousDataVector* ranking() const;
+
+    // Writes the rank of each value to out, with tied values sharing
+    // the mean of their ranks; this doesn't allocate, once warmed up
+    void rankInto(double* out) const;
 };
 
-class DiscreteDataVector : public CorrelationDataVector<QString>
+// The distinct values of a discrete data set, each identified by a compact code, such that
+// the cells themselves need only store codes; code 0 is always the empty string
+class DiscreteDataDictionary
 {
 public:
-    using CorrelationDataVector::CorrelationDataVector;
-};
+    using Code = uint32_t;
+
+private:
+    std::vector<QString> _values;
+    QHash<QString, Code> _codes;
+
+    // Each value also has a token, as used for correlation, where the various
+    // falsey values all share the 0 token and are hence considered equivalent
+    std::vector<size_t> _tokens;
+    size_t _maxToken = 0;
 
-class TokenisedDataVector : public CorrelationDataVector<size_t>
-{
 public:
-    using CorrelationDataVector::CorrelationDataVector;
-};
+    DiscreteDataDictionary();
 
-using ContinuousDataVectors = std::vector<ContinuousDataVector>;
-using DiscreteDataVectors = std::vector<DiscreteDataVector>;
-using TokenisedDataVectors = std::vector<TokenisedDataVector>;
+    Code codeFor(const QString& value);
 
-template<typename DataVectors>
-TokenisedDataVectors tokeniseDataVectors(const DataVectors& dataVectors)
-{
-    using T = typename DataVectors::value_type::ConstDataIterator::value_type;
+    const QString& valueOf(Code code) const { Q_ASSERT(code < _values.size()); return _values[code]; }
+    size_t tokenOf(Code code) const { Q_ASSERT(code < _tokens.size()); return _tokens[code]; }
 
-    TokenisedDataVectors tokenisedDataVectors;
+    size_t size() const { return _values.size(); }
+    size_t maxToken() const { return _maxToken; }
 
-    size_t token = 1;
-    std::map<T, size_t> valueMap;
+    // The codes, ordered by the values they represent
+    std::vector<Code> sortedCodes() const;
+};
 
-    // Map various falsey values to the 0 token
-    if constexpr(std::is_same_v<T, QString>)
-        valueMap[""] = valueMap["0"] = valueMap["false"] = 0;
-    else
-        valueMap[0] = 0;
+class DiscreteDataVector : public CorrelationDataVector<DiscreteDataDictionary::Code>
+{
+private:
+    std::shared_ptr<const DiscreteDataDictionary> _dictionary;
 
-    for(const auto& dataVector : dataVectors)
-    {
-        std::vector<size_t> tokens;
-        tokens.reserve(dataVector.size());
+public:
+    using Code = DiscreteDataDictionary::Code;
 
-        for(const auto& value : dataVector)
-        {
-            if(!u::contains(valueMap, value))
-            {
-                valueMap[value] = token;
-                token++;
-            }
+    DiscreteDataVector() = default;
 
-            tokens.emplace_back(valueMap.at(value));
-        }
+    // Row from row-wise input
+    DiscreteDataVector(std::shared_ptr<const DiscreteDataDictionary> dictionary,
+        const std::vector<Code>& codes, size_t row, size_t numColumns,
+        NodeId nodeId, uint64_t computeCost = 1) :
+        CorrelationDataVector(codes, row, numColumns, nodeId, computeCost),
+        _dictionary(std::move(dictionary))
+    {}
 
-        tokenisedDataVectors.emplace_back(tokens, dataVector.nodeId(), dataVector.computeCostHint());
-    }
+    DiscreteDataVector(std::shared_ptr<const DiscreteDataDictionary> dictionary,
+        const std::vector<Code>& codes, NodeId nodeId, uint64_t computeCost = 1) :
+        DiscreteDataVector(std::move(dictionary), codes, 0, codes.size(), nodeId, computeCost)
+    {}
 
-    return tokenisedDataVectors;
-}
+    const DiscreteDataDictionary& dictionary() const { return *_dictionary; }
+
+    Code codeAt(size_t index) const { return _data.at(index); }
+    const QString& valueAt(size_t index) const { return _dictionary->valueOf(codeAt(index)); }
+    size_t tokenAt(size_t index) const { return _dictionary->tokenOf(codeAt(index)); }
+};
+
+using ContinuousDataVectors = std::vector<ContinuousDataVector>;
+using DiscreteDataVectors = std::vector<DiscreteDataVector>;
 
 #endif // CORRELATIONDATAVECTOR_H
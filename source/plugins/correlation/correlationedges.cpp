@@ -0,0 +1,217 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "correlationedges.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <utility>
+
+void CorrelationEdges::Writer::flush()
+{
+    if(_chunk.empty())
+        return;
+
+    _edges->append(_chunk.data(), _chunk.size());
+    _chunk.clear();
+}
+
+CorrelationEdges::CorrelationEdges(size_t memoryLimit) :
+    _memoryLimit(memoryLimit)
+{}
+
+CorrelationEdges::CorrelationEdges(CorrelationEdges&& other) noexcept :
+    _memoryLimit(other._memoryLimit),
+    _chunks(std::move(other._chunks)),
+    _spillFile(std::move(other._spillFile)),
+    _numSpilledChunks(std::exchange(other._numSpilledChunks, 0)),
+    _spillFailed(other._spillFailed),
+    _size(std::exchange(other._size, 0))
+{}
+
+CorrelationEdges& CorrelationEdges::operator=(CorrelationEdges&& other) noexcept
+{
+    _memoryLimit = other._memoryLimit;
+    _chunks = std::move(other._chunks);
+    _spillFile = std::move(other._spillFile);
+    _numSpilledChunks = std::exchange(other._numSpilledChunks, 0);
+    _spillFailed = other._spillFailed;
+    _size = std::exchange(other._size, 0);
+
+    return *this;
+}
+
+CorrelationEdges::~CorrelationEdges() = default;
+
+CorrelationEdges CorrelationEdges::fromEdgeList(const EdgeList& edgeList, size_t memoryLimit)
+{
+    CorrelationEdges edges(memoryLimit);
+
+    Writer writer(edges);
+    for(const auto& edge : edgeList)
+        writer.add(edge._source, edge._target, edge._weight);
+
+    writer.flush();
+
+    return edges;
+}
+
+void CorrelationEdges::add(NodeId source, NodeId target, double r)
+{
+    const Edge edge{static_cast<uint32_t>(static_cast<int>(source)),
+        static_cast<uint32_t>(static_cast<int>(target)), static_cast<float>(r)};
+
+    append(&edge, 1);
+}
+
+void CorrelationEdges::append(const Edge* edges, size_t numEdges)
+{
+    const std::unique_lock<std::mutex> lock(_mutex);
+
+    _size += numEdges;
+
+    while(numEdges > 0)
+    {
+        if(_chunks.empty() || _chunks.back().size() >= ChunkSize)
+        {
+            _chunks.emplace_back();
+            _chunks.back().reserve(ChunkSize);
+        }
+
+        auto& chunk = _chunks.back();
+        auto numToCopy = std::min(numEdges, ChunkSize - chunk.size());
+
+        chunk.insert(chunk.end(), edges, edges + numToCopy);
+        edges += numToCopy;
+        numEdges -= numToCopy;
+
+        if(chunk.size() >= ChunkSize)
+            spillLastChunkIfRequired();
+    }
+}
+
+void CorrelationEdges::spillLastChunkIfRequired()
+{
+    if(_spillFailed || (_chunks.size() * ChunkSize * sizeof(Edge)) <= _memoryLimit)
+        return;
+
+    if(!spillChunk(_chunks.back()))
+        return;
+
+    _chunks.pop_back();
+}
+
+bool CorrelationEdges::spillChunk(const Chunk& chunk)
+{
+    if(_spillFailed)
+        return false;
+
+    if(_spillFile == nullptr)
+    {
+        _spillFile = std::make_unique<QTemporaryFile>();
+
+        if(!_spillFile->open())
+        {
+            qWarning() << "CorrelationEdges: can't open spill file, edges will be kept in memory";
+            _spillFailed = true;
+            return false;
+        }
+    }
+
+    auto numBytes = static_cast<qint64>(chunk.size() * sizeof(Edge));
+
+    // NOLINTNEXTLINE cppcoreguidelines-pro-type-reinterpret-cast
+    if(_spillFile->write(reinterpret_cast<const char*>(chunk.data()), numBytes) != numBytes)
+    {
+        qWarning() << "CorrelationEdges: can't write to spill file, edges will be kept in memory";
+        _spillFailed = true;
+        return false;
+    }
+
+    _numSpilledChunks++;
+    return true;
+}
+
+void CorrelationEdges::spillFullChunks()
+{
+    const std::unique_lock<std::mutex> lock(_mutex);
+
+    // The spill file only holds full chunks, so a partial last chunk stays in memory
+    size_t numFullChunks = 0;
+    while(numFullChunks < _chunks.size() && _chunks.at(numFullChunks).size() >= ChunkSize)
+        numFullChunks++;
+
+    size_t numChunksSpilled = 0;
+    for(; numChunksSpilled < numFullChunks; numChunksSpilled++)
+    {
+        auto& chunk = _chunks.at(numChunksSpilled);
+
+        if(!spillChunk(chunk))
+            break;
+
+        // Release each chunk as soon as it's on disk, rather than all of them at the end
+        Chunk().swap(chunk);
+    }
+
+    _chunks.erase(_chunks.begin(), _chunks.begin() + static_cast<std::ptrdiff_t>(numChunksSpilled));
+}
+
+void CorrelationEdges::clear()
+{
+    const std::unique_lock<std::mutex> lock(_mutex);
+
+    _chunks.clear();
+    _chunks.shrink_to_fit();
+    _spillFile.reset();
+    _numSpilledChunks = 0;
+    _spillFailed = false;
+    _size = 0;
+}
+
+bool CorrelationEdges::readSpilledChunk(size_t index, Chunk& chunk) const
+{
+    auto numBytes = static_cast<qint64>(ChunkSize * sizeof(Edge));
+
+    // The seek and read must happen as one, else another reader may move the file position
+    const std::unique_lock<std::mutex> lock(_mutex);
+
+    if(!_spillFile->flush() || !_spillFile->seek(static_cast<qint64>(index) * numBytes))
+        return false;
+
+    chunk.resize(ChunkSize);
+
+    // NOLINTNEXTLINE cppcoreguidelines-pro-type-reinterpret-cast
+    return _spillFile->read(reinterpret_cast<char*>(chunk.data()), numBytes) == numBytes;
+}
+
+EdgeList CorrelationEdges::toEdgeList() const
+{
+    EdgeList edgeList;
+    edgeList.reserve(_size);
+
+    forEachChunk([&edgeList](const Chunk& chunk)
+    {
+        for(const auto& edge : chunk)
+            edgeList.push_back({edge.source(), edge.target(), static_cast<double>(edge._r)});
+
+        return true;
+    });
+
+    return edgeList;
+}
@@ -0,0 +1,172 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORRELATIONEDGES_H
+#define CORRELATIONEDGES_H
+
+#include "shared/graph/elementid.h"
+#include "shared/graph/edgelist.h"
+
+#include <QTemporaryFile>
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// A store of the edges that result from correlation, which can be written to from many
+// threads at once; edges are held compactly, in fixed size chunks, and once the memory
+// those chunks occupy exceeds a limit, any further chunks are written to a temporary file
+class CorrelationEdges
+{
+public:
+    struct Edge
+    {
+        uint32_t _source = 0;
+        uint32_t _target = 0;
+        float _r = 0.0f;
+
+        NodeId source() const { return static_cast<int>(_source); }
+        NodeId target() const { return static_cast<int>(_target); }
+    };
+
+    using Chunk = std::vector<Edge>;
+
+    static constexpr size_t ChunkSize = 1u << 16u;
+    static constexpr size_t DefaultMemoryLimit = size_t{1} << 30u;
+
+    // Accumulates edges locally, so that the store only needs to be locked occasionally;
+    // anything still held is passed on to the store when the Writer is destroyed
+    class Writer
+    {
+    private:
+        CorrelationEdges* _edges;
+        Chunk _chunk;
+
+    public:
+        explicit Writer(CorrelationEdges& edges) : _edges(&edges) {}
+        Writer(const Writer&) = delete;
+        Writer(Writer&&) = delete;
+        Writer& operator=(const Writer&) = delete;
+        Writer& operator=(Writer&&) = delete;
+        ~Writer() { flush(); }
+
+        void add(NodeId source, NodeId target, double r)
+        {
+            _chunk.push_back({static_cast<uint32_t>(static_cast<int>(source)),
+                static_cast<uint32_t>(static_cast<int>(target)), static_cast<float>(r)});
+
+            if(_chunk.size() >= ChunkSize)
+                flush();
+        }
+
+        void flush();
+    };
+
+private:
+    size_t _memoryLimit = DefaultMemoryLimit;
+
+    // Also serialises reads of the spill file, which share a single file position
+    mutable std::mutex _mutex;
+
+    // Chunks that are held in memory, all of which are full, except for the last
+    std::vector<Chunk> _chunks;
+
+    // Chunks that have been written to the spill file, all of which are full
+    std::unique_ptr<QTemporaryFile> _spillFile;
+    size_t _numSpilledChunks = 0;
+    bool _spillFailed = false;
+
+    size_t _size = 0;
+
+    void append(const Edge* edges, size_t numEdges);
+    void spillLastChunkIfRequired();
+    bool spillChunk(const Chunk& chunk);
+    bool readSpilledChunk(size_t index, Chunk& chunk) const;
+
+public:
+    explicit CorrelationEdges(size_t memoryLimit = DefaultMemoryLimit);
+    CorrelationEdges(const CorrelationEdges&) = delete;
+    CorrelationEdges(CorrelationEdges&& other) noexcept;
+    CorrelationEdges& operator=(const CorrelationEdges&) = delete;
+    CorrelationEdges& operator=(CorrelationEdges&& other) noexcept;
+    ~CorrelationEdges();
+
+    static CorrelationEdges fromEdgeList(const EdgeList& edgeList,
+        size_t memoryLimit = DefaultMemoryLimit);
+
+    void add(NodeId source, NodeId target, double r);
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    bool spilled() const { return _numSpilledChunks > 0; }
+
+    // Calls fn for each chunk of edges in turn, stopping early if it returns false;
+    // returns false if iteration stopped early, or spilled edges couldn't be read;
+    // concurrent iterations are safe, but not iteration concurrent with adding edges
+    template<typename Fn>
+    bool forEachChunk(Fn&& fn) const
+    {
+        for(const auto& chunk : _chunks)
+        {
+            if(!fn(chunk))
+                return false;
+        }
+
+        Chunk chunk;
+        for(size_t index = 0; index < _numSpilledChunks; index++)
+        {
+            if(!readSpilledChunk(index, chunk) || !fn(chunk))
+                return false;
+        }
+
+        return true;
+    }
+
+    // As forEachChunk, but each chunk is released once fn has seen it, leaving the store
+    // empty; this allows the edges to be moved elsewhere without holding them twice over
+    template<typename Fn>
+    bool consumeChunks(Fn&& fn)
+    {
+        bool completed = true;
+
+        for(auto& chunk : _chunks)
+        {
+            completed = completed && fn(std::as_const(chunk));
+            Chunk().swap(chunk);
+        }
+
+        Chunk chunk;
+        for(size_t index = 0; completed && index < _numSpilledChunks; index++)
+            completed = readSpilledChunk(index, chunk) && fn(std::as_const(chunk));
+
+        clear();
+
+        return completed;
+    }
+
+    // Moves every full chunk held in memory to the spill file, where possible
+    void spillFullChunks();
+    void clear();
+
+    EdgeList toEdgeList() const;
+};
+
+#endif // CORRELATIONEDGES_H
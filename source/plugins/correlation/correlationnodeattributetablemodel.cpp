@@ -61,14 +61,14 @@ QVariant CorrelationNodeAttributeTableModel::dataValue(size_t row, const QString
 
         if(_continuousDataValues != nullptr)
         {
-            Q_ASSERT(index < _continuousDataValues->size());
-            return _continuousDataValues->at(index);
+            Q_ASSERT(row < _continuousDataValues->numRows());
+            return _continuousDataValues->valueAt(row, column);
         }
 
         if(_discreteDataValues != nullptr)
         {
             Q_ASSERT(index < _discreteDataValues->size());
-            return _discreteDataValues->at(index);
+            return _discreteDataDictionary->valueOf(_discreteDataValues->at(index));
         }
 
         return {};
@@ -78,7 +78,7 @@ QVariant CorrelationNodeAttributeTableModel::dataValue(size_t row, const QString
 }
 
 void CorrelationNodeAttributeTableModel::addContinuousDataColumns(const std::vector<QString>& dataColumnNames,
-    std::vector<double>* dataValues)
+    const ContinuousDataMatrix* dataValues)
 {
     addDataColumnNames(dataColumnNames);
     Q_ASSERT(_discreteDataValues == nullptr);
@@ -86,11 +86,12 @@ void CorrelationNodeAttributeTableModel::addContinuousDataColumns(const std::vec
 }
 
 void CorrelationNodeAttributeTableModel::addDiscreteDataColumns(const std::vector<QString>& dataColumnNames,
-    std::vector<QString>* dataValues)
+    const std::vector<DiscreteDataDictionary::Code>* dataValues, const DiscreteDataDictionary* dictionary)
 {
     addDataColumnNames(dataColumnNames);
     Q_ASSERT(_continuousDataValues == nullptr);
     _discreteDataValues = dataValues;
+    _discreteDataDictionary = dictionary;
 }
 
 bool CorrelationNodeAttributeTableModel::columnIsCalculated(const QString& columnName) const
@@ -21,6 +21,8 @@
 
 #include "shared/plugins/nodeattributetablemodel.h"
 
+#include "correlationdatavector.h"
+
 #include <QString>
 #include <QObject>
 
@@ -33,8 +35,9 @@ class CorrelationNodeAttributeTableModel : public NodeAttributeTableModel
 
 private:
     std::vector<QString> _dataColumnNames;
-    std::vector<double>* _continuousDataValues = nullptr;
-    std::vector<QString>* _discreteDataValues = nullptr;
+    const ContinuousDataMatrix* _continuousDataValues = nullptr;
+    const std::vector<DiscreteDataDictionary::Code>* _discreteDataValues = nullptr;
+    const DiscreteDataDictionary* _discreteDataDictionary = nullptr;
 
     // For fast lookup in dataValue(...)
     std::map<QString, size_t> _dataColumnIndexes;
@@ -45,9 +48,10 @@ private:
 
 public:
     void addContinuousDataColumns(const std::vector<QString>& dataColumnNames,
-        std::vector<double>* dataValues);
+        const ContinuousDataMatrix* dataValues);
     void addDiscreteDataColumns(const std::vector<QString>& dataColumnNames,
-        std::vector<QString>* dataValues);
+        const std::vector<DiscreteDataDictionary::Code>* dataValues,
+        const DiscreteDataDictionary* dictionary);
 
     QVariant dataValue(size_t row, const QString& columnName) const override;
 
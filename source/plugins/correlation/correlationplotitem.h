@@ -22,8 +22,10 @@
 #include "correlationplugin.h"
 
 #include "columnannotation.h"
+#include "columnstatistics.h"
 
 #include "shared/utils/qmlenum.h"
+#include "shared/utils/threadpool.h"
 
 #include <qcustomplot.h>
 
@@ -331,6 +333,14 @@ private:
 
     QMap<int, LineCacheEntry> _lineGraphCache;
 
+    // Plots are rebuilt on the UI thread, so rather than queue behind whatever
+    // transforms or correlations occupy the global pool, they get their own
+    ThreadPool _threadPool{QStringLiteral("Plot")};
+
+    // Not invalidated along with the line graph cache, as the statistics are
+    // independent of the column order and scaling of the plot
+    ColumnStatisticsCache _columnStatisticsCache{_threadPool};
+
     using LabelElisionCacheEntry = QMap<int, QString>;
     QMap<QString, LabelElisionCacheEntry> _labelElisionCache;
 
@@ -393,6 +403,7 @@ private:
     void setContinousYAxisRange(double min, double max);
     void setContinousYAxisRangeForSelection();
     QVector<double> meanAverageData(double& min, double& max, const QVector<int>& rows);
+    ColumnStatistics& columnStatisticsFor(const QVector<int>& rows);
 
     double visibleHorizontalFraction() const;
     bool isWide() const;
@@ -432,7 +443,7 @@ private:
     }
 
     static std::pair<double, double> addIQRBoxPlotTo(QCPAxis* keyAxis, QCPAxis* valueAxis,
-        size_t column, QVector<double> values, bool showOutliers,
+        size_t column, const IQRStatistics& iqr, bool showOutliers,
         const QColor& color = {}, const QString& text = {});
 
 private slots:
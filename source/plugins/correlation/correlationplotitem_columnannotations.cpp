@@ -203,12 +203,12 @@ void CorrelationPlotItem::populateIQRAnnotationPlot(const QCPColumnAnnotations*
 
     for(size_t column = 0; column < _annotationGroupMap.size(); column++)
     {
-        QVector<double> values;
+        std::vector<double> values;
 
         for(auto row : std::as_const(_selectedRows))
         {
             for(size_t groupedColumn : _annotationGroupMap.at(column))
-                values.append(_pluginInstance->continuousDataAt(row, static_cast<int>(groupedColumn)));
+                values.push_back(_pluginInstance->continuousDataAt(row, static_cast<int>(groupedColumn)));
         }
 
         if(_scaleType == static_cast<int>(PlotScaleType::Log))
@@ -225,7 +225,7 @@ void CorrelationPlotItem::populateIQRAnnotationPlot(const QCPColumnAnnotations*
         }
 
         auto minmax = addIQRBoxPlotTo(_continuousXAxis, _continuousYAxis, column,
-            std::move(values), _showIqrOutliers, color, value);
+            iqrStatisticsOf(values), _showIqrOutliers, color, value);
 
         minY = std::min(minY, minmax.first);
         maxY = std::max(maxY, minmax.second);
@@ -22,7 +22,8 @@
 #include "qcpcolumnannotations.h"
 
 #include "shared/utils/statistics.h"
-#include "shared/utils/container_randomsample.h"
+
+#include <numeric>
 
 // NOLINTNEXTLINE readability-make-member-function-const
 void CorrelationPlotItem::setContinousYAxisRange(double min, double max)
@@ -198,20 +199,21 @@ void CorrelationPlotItem::setDispersionType(int dispersionType)
     }
 }
 
+ColumnStatistics& CorrelationPlotItem::columnStatisticsFor(const QVector<int>& rows)
+{
+    _columnStatisticsCache.setData(_pluginInstance->continuousData(), _pluginInstance->continuousEpsilon());
+    return _columnStatisticsCache.statisticsFor(rows);
+}
+
 QVector<double> CorrelationPlotItem::meanAverageData(double& min, double& max, const QVector<int>& rows)
 {
     // Use Average Calculation
-    QVector<double> yDataAvg; yDataAvg.reserve(rows.size());
+    QVector<double> yDataAvg; yDataAvg.reserve(static_cast<int>(_pluginInstance->numContinuousColumns()));
+    const auto& statistics = columnStatisticsFor(rows);
 
     for(size_t col = 0; col < _pluginInstance->numContinuousColumns(); col++)
     {
-        double runningTotal = std::accumulate(rows.begin(), rows.end(), 0.0,
-        [this, col](auto partial, auto row)
-        {
-            return partial + _pluginInstance->continuousDataAt(row, static_cast<int>(_sortMap.at(col)));
-        });
-
-        yDataAvg.append(runningTotal / static_cast<double>(rows.length()));
+        yDataAvg.append(statistics.mean(_sortMap.at(col)));
 
         max = std::max(max, yDataAvg.back());
         min = std::min(min, yDataAvg.back());
@@ -303,21 +305,14 @@ void CorrelationPlotItem::populateMedianLinePlot()
         // xData is just the column indices
         std::iota(std::begin(xData), std::end(xData), 0);
 
-        QVector<double> rowsEntries(rows.length());
         QVector<double> yDataAvg(static_cast<int>(_pluginInstance->numContinuousColumns()));
+        const auto& iqrs = columnStatisticsFor(rows).iqrs();
 
         for(int col = 0; col < static_cast<int>(_pluginInstance->numContinuousColumns()); col++)
         {
-            rowsEntries.clear();
-            std::transform(rows.begin(), rows.end(), std::back_inserter(rowsEntries),
-            [this, col](auto row)
-            {
-                return _pluginInstance->continuousDataAt(row, static_cast<int>(_sortMap.at(col)));
-            });
-
             if(!rows.empty())
             {
-                yDataAvg[col] = u::medianOf(rowsEntries);
+                yDataAvg[col] = iqrs.at(_sortMap.at(col))._secondQuartile;
 
                 maxY = std::max(maxY, yDataAvg[col]);
                 minY = std::min(minY, yDataAvg[col]);
@@ -408,13 +403,13 @@ void CorrelationPlotItem::populateMeanHistogramPlot()
 }
 
 std::pair<double, double> CorrelationPlotItem::addIQRBoxPlotTo(QCPAxis* keyAxis, QCPAxis* valueAxis,
-    size_t column, QVector<double> values, bool showOutliers, const QColor& color, const QString& text)
+    size_t column, const IQRStatistics& iqr, bool showOutliers, const QColor& color, const QString& text)
 {
     // Box-plots representing the InterQuatile Range
     // Whiskers represent the maximum and minimum non-outlier values
     // Outlier values are (< Q1 - 1.5IQR and > Q3 + 1.5IQR)
 
-    if(values.empty())
+    if(iqr._numValues == 0)
         return {};
 
     auto* statisticalBox = new QCPStatisticalBox(keyAxis, valueAxis);
@@ -423,82 +418,17 @@ std::pair<double, double> CorrelationPlotItem::addIQRBoxPlotTo(QCPAxis* keyAxis,
     if(color.isValid())
         statisticalBox->setBrush(color);
 
-    // Partial (efficient) sort which is suitable for IQR calculation
-    auto const Q1 = values.size() / 4;
-    auto const Q2 = values.size() / 2;
-    auto const Q3 = Q1 + Q2;
-
-    std::nth_element(values.begin(),          values.begin() + Q1, values.end());
-    std::nth_element(values.begin() + Q1 + 1, values.begin() + Q2, values.end());
-    std::nth_element(values.begin() + Q2 + 1, values.begin() + Q3, values.end());
-
-    double secondQuartile = u::medianOf(values);
-    double firstQuartile = secondQuartile;
-    double thirdQuartile = secondQuartile;
-
-    // Don't calculate medians if there's only one sample
-    if(values.size() > 1)
-    {
-        if(values.size() % 2 == 0)
-        {
-            firstQuartile = u::medianOf(values.mid(0, (values.size() / 2)));
-            thirdQuartile = u::medianOf(values.mid((values.size() / 2)));
-        }
-        else
-        {
-            firstQuartile = u::medianOf(values.mid(0, ((values.size() - 1) / 2)));
-            thirdQuartile = u::medianOf(values.mid(((values.size() + 1) / 2)));
-        }
-    }
-
-    double iqr = thirdQuartile - firstQuartile;
-    double minValue = secondQuartile;
-    double maxValue = secondQuartile;
     QVector<double> outliers;
-    outliers.reserve(values.size());
-
-    for(auto value : std::as_const(values))
-    {
-        // Find Maximum and minimum non-outliers
-        if(value < thirdQuartile + (iqr * 1.5))
-            maxValue = std::max(maxValue, value);
-
-        if(value > firstQuartile - (iqr * 1.5))
-            minValue = std::min(minValue, value);
-
-        if(!showOutliers)
-            continue;
-
-        // Find outliers
-        if(value > thirdQuartile + (iqr * 1.5) || value < firstQuartile - (iqr * 1.5))
-            outliers.push_back(value);
-    }
-
-    outliers.shrink_to_fit();
-
-    auto minmax = std::minmax_element(outliers.begin(), outliers.end());
-    auto minOutlier = !outliers.empty() ? *minmax.first : minValue;
-    auto maxOutlier = !outliers.empty() ? *minmax.second : maxValue;
-
-    const size_t maxOutliers = 100;
-    if(static_cast<size_t>(outliers.size()) > maxOutliers)
-    {
-        outliers = u::randomSample(outliers, maxOutliers);
-
-        // Ensure the minimum and maximum outliers are included
-        outliers.append({minOutlier, maxOutlier});
-    }
+    if(showOutliers)
+        outliers = QVector<double>(iqr._outliers.begin(), iqr._outliers.end());
 
-    statisticalBox->addData(static_cast<int>(column), minValue, firstQuartile,
-        secondQuartile, thirdQuartile, maxValue, outliers);
+    statisticalBox->addData(static_cast<int>(column), iqr._minValue, iqr._firstQuartile,
+        iqr._secondQuartile, iqr._thirdQuartile, iqr._maxValue, outliers);
 
     if(showOutliers)
-    {
-        minValue = std::min(minValue, minOutlier);
-        maxValue = std::max(maxValue, maxOutlier);
-    }
+        return {std::min(iqr._minValue, iqr._minOutlier), std::max(iqr._maxValue, iqr._maxOutlier)};
 
-    return {minValue, maxValue};
+    return {iqr._minValue, iqr._maxValue};
 }
 
 void CorrelationPlotItem::populateIQRPlot()
@@ -506,21 +436,13 @@ void CorrelationPlotItem::populateIQRPlot()
     auto minY = std::numeric_limits<double>::max();
     auto maxY = std::numeric_limits<double>::lowest();
 
+    const auto& iqrs = columnStatisticsFor(_selectedRows).iqrs(
+        _scaleType == static_cast<int>(PlotScaleType::Log));
+
     for(int column = 0; column < static_cast<int>(_pluginInstance->numContinuousColumns()); column++)
     {
-        QVector<double> values;
-
-        const auto& selectedRows = std::as_const(_selectedRows);
-        std::transform(selectedRows.begin(), selectedRows.end(), std::back_inserter(values),
-        [this, column](auto row)
-        {
-            return _pluginInstance->continuousDataAt(row, static_cast<int>(_sortMap.at(column)));
-        });
-
-        if(_scaleType == static_cast<int>(PlotScaleType::Log))
-            logScale(values, _pluginInstance->continuousEpsilon());
-
-        auto minmax = addIQRBoxPlotTo(_continuousXAxis, _continuousYAxis, column, std::move(values), _showIqrOutliers);
+        auto minmax = addIQRBoxPlotTo(_continuousXAxis, _continuousYAxis, column,
+            iqrs.at(_sortMap.at(column)), _showIqrOutliers);
         minY = std::min(minY, minmax.first);
         maxY = std::max(maxY, minmax.second);
     }
@@ -592,16 +514,11 @@ void CorrelationPlotItem::populateStdDevPlot(QCPAbstractPlottable* meanPlot,
     const QVector<int>& rows, QVector<double>& means)
 {
     QVector<double> stdDevs(static_cast<int>(_pluginInstance->numContinuousColumns()));
+    const auto& statistics = columnStatisticsFor(rows);
 
     for(int col = 0; col < static_cast<int>(_pluginInstance->numContinuousColumns()); col++)
     {
-        double stdDev = 0.0;
-        for(auto row : rows)
-        {
-            auto value = _pluginInstance->continuousDataAt(row, static_cast<int>(_sortMap.at(col))) - means.at(col);
-            stdDev += (value * value);
-        }
-
+        double stdDev = statistics.sumOfSquaredDeviationsFrom(_sortMap.at(col), means.at(col));
         stdDev /= static_cast<double>(_pluginInstance->numContinuousColumns());
         stdDev = std::sqrt(stdDev);
         stdDevs[col] = stdDev;
@@ -615,16 +532,11 @@ void CorrelationPlotItem::populateStdErrorPlot(QCPAbstractPlottable* meanPlot,
     const QVector<int>& rows, QVector<double>& means)
 {
     QVector<double> stdErrs(static_cast<int>(_pluginInstance->numContinuousColumns()));
+    const auto& statistics = columnStatisticsFor(rows);
 
     for(int col = 0; col < static_cast<int>(_pluginInstance->numContinuousColumns()); col++)
     {
-        double stdErr = 0.0;
-        for(auto row : rows)
-        {
-            auto value = _pluginInstance->continuousDataAt(row, static_cast<int>(_sortMap.at(col))) - means.at(col);
-            stdErr += (value * value);
-        }
-
+        double stdErr = statistics.sumOfSquaredDeviationsFrom(_sortMap.at(col), means.at(col));
         stdErr /= static_cast<double>(_pluginInstance->numContinuousColumns());
         stdErr = std::sqrt(stdErr) / std::sqrt(static_cast<double>(rows.length()));
         stdErrs[col] = stdErr;
@@ -652,107 +564,125 @@ void CorrelationPlotItem::populateDispersion(QCPAbstractPlottable* meanPlot,
         populateStdErrorPlot(meanPlot, minY, maxY, rows, means);
 }
 
+// Beyond this many rows, lines are drawn without antialiasing; when so many lines
+// overlap it makes little visual difference, but it is far cheaper to render
+constexpr int maxAntialiasedLines = 500;
+
 void CorrelationPlotItem::populateLinePlot()
 {
     double minY = std::numeric_limits<double>::max();
     double maxY = std::numeric_limits<double>::lowest();
 
-    QVector<double> yData; yData.reserve(_selectedRows.size());
-    QVector<double> xData; xData.reserve(static_cast<int>(_pluginInstance->numContinuousColumns()));
+    auto numColumns = _pluginInstance->numContinuousColumns();
+    auto scaleType = NORMALISE_QML_ENUM(PlotScaleType, _scaleType);
 
-    // Plot each row individually
+    struct Line
+    {
+        int _row = 0;
+        double _attributeValue = 1.0;
+        QVector<double> _yData;
+        double _minY = std::numeric_limits<double>::max();
+        double _maxY = std::numeric_limits<double>::lowest();
+    };
+
+    // Only rows that aren't already cached need their data computing
+    std::vector<Line> newLines;
     for(auto row : std::as_const(_selectedRows))
     {
-        QCPGraph* graph = nullptr;
-        double rowMinY = std::numeric_limits<double>::max();
-        double rowMaxY = std::numeric_limits<double>::lowest();
+        if(_lineGraphCache.contains(row))
+            continue;
 
-        if(!_lineGraphCache.contains(row))
-        {
-            graph = _customPlot.addGraph(_continuousXAxis, _continuousYAxis);
-            graph->setLayer(_lineGraphLayer);
+        Line line;
+        line._row = row;
 
-            double rowSum = 0.0;
-            for(size_t col = 0; col < _pluginInstance->numContinuousColumns(); col++)
-                rowSum += _pluginInstance->continuousDataAt(row, static_cast<int>(_sortMap.at(col)));
+        // Attributes are looked up here, rather than concurrently below
+        if(scaleType == PlotScaleType::ByAttribute && !_scaleByAttributeName.isEmpty())
+        {
+            line._attributeValue = u::toNumber(_pluginInstance->attributeValueFor(_scaleByAttributeName, row));
 
-            double rowMean = rowSum / static_cast<double>(_pluginInstance->numContinuousColumns());
+            if(line._attributeValue == 0.0 || !std::isfinite(line._attributeValue))
+                line._attributeValue = 1.0;
+        }
 
-            double variance = 0.0;
-            for(size_t col = 0; col < _pluginInstance->numContinuousColumns(); col++)
-            {
-                auto value = _pluginInstance->continuousDataAt(row, static_cast<int>(_sortMap.at(col))) - rowMean;
-                variance += (value * value);
-            }
+        newLines.push_back(std::move(line));
+    }
 
-            variance /= static_cast<double>(_pluginInstance->numContinuousColumns());
-            double stdDev = std::sqrt(variance);
-            double pareto = std::sqrt(stdDev);
+    _threadPool.parallel_for(newLines.begin(), newLines.end(), [&](Line& line)
+    {
+        line._yData.reserve(static_cast<int>(numColumns));
 
-            double attributeValue = 1.0;
+        for(size_t col = 0; col < numColumns; col++)
+            line._yData.append(_pluginInstance->continuousDataAt(line._row, static_cast<int>(_sortMap.at(col))));
 
-            if(NORMALISE_QML_ENUM(PlotScaleType, _scaleType) == PlotScaleType::ByAttribute && !_scaleByAttributeName.isEmpty())
-            {
-                attributeValue = u::toNumber(_pluginInstance->attributeValueFor(_scaleByAttributeName, row));
+        double rowSum = std::accumulate(line._yData.begin(), line._yData.end(), 0.0);
+        double rowMean = rowSum / static_cast<double>(numColumns);
 
-                if(attributeValue == 0.0 || !std::isfinite(attributeValue))
-                    attributeValue = 1.0;
-            }
+        double variance = 0.0;
+        for(auto value : std::as_const(line._yData))
+            variance += ((value - rowMean) * (value - rowMean));
 
-            yData.clear();
-            xData.clear();
+        variance /= static_cast<double>(numColumns);
+        double stdDev = std::sqrt(variance);
+        double pareto = std::sqrt(stdDev);
 
-            for(size_t col = 0; col < _pluginInstance->numContinuousColumns(); col++)
+        for(auto& value : line._yData)
+        {
+            switch(scaleType)
             {
-                auto value = _pluginInstance->continuousDataAt(row, static_cast<int>(_sortMap.at(col)));
-
-                switch(NORMALISE_QML_ENUM(PlotScaleType, _scaleType))
-                {
-                case PlotScaleType::Log:
-                    value = logScale(value, _pluginInstance->continuousEpsilon());
-                    break;
-                case PlotScaleType::MeanCentre:
-                    value -= rowMean;
-                    break;
-                case PlotScaleType::UnitVariance:
-                    value -= rowMean;
-                    value /= stdDev;
-                    break;
-                case PlotScaleType::Pareto:
-                    value -= rowMean;
-                    value /= pareto;
-                    break;
-                case PlotScaleType::ByAttribute:
-                    value /= attributeValue;
-                    break;
-                default:
-                    break;
-                }
-
-                xData.append(static_cast<double>(col));
-                yData.append(value);
-
-                rowMinY = std::min(rowMinY, value);
-                rowMaxY = std::max(rowMaxY, value);
+            case PlotScaleType::Log:
+                value = logScale(value, _pluginInstance->continuousEpsilon());
+                break;
+            case PlotScaleType::MeanCentre:
+                value -= rowMean;
+                break;
+            case PlotScaleType::UnitVariance:
+                value -= rowMean;
+                value /= stdDev;
+                break;
+            case PlotScaleType::Pareto:
+                value -= rowMean;
+                value /= pareto;
+                break;
+            case PlotScaleType::ByAttribute:
+                value /= line._attributeValue;
+                break;
+            default:
+                break;
             }
 
-            graph->setData(xData, yData, true);
-
-            _lineGraphCache.insert(row, {graph, rowMinY, rowMaxY});
-        }
-        else
-        {
-            const auto& v = _lineGraphCache.value(row);
-            graph = v._graph;
-            rowMinY = v._minY;
-            rowMaxY = v._maxY;
+            line._minY = std::min(line._minY, value);
+            line._maxY = std::max(line._maxY, value);
         }
+    });
+
+    QVector<double> xData;
+    xData.reserve(static_cast<int>(numColumns));
+    for(size_t col = 0; col < numColumns; col++)
+        xData.append(static_cast<double>(col));
+
+    for(const auto& line : newLines)
+    {
+        auto* graph = _customPlot.addGraph(_continuousXAxis, _continuousYAxis);
+        graph->setLayer(_lineGraphLayer);
+        graph->setData(xData, line._yData, true);
+
+        _lineGraphCache.insert(line._row, {graph, line._minY, line._maxY});
+    }
+
+    bool antialiased = _selectedRows.size() <= maxAntialiasedLines;
+
+    // Plot each row individually
+    for(auto row : std::as_const(_selectedRows))
+    {
+        const auto& v = _lineGraphCache.value(row);
+        auto* graph = v._graph;
 
-        minY = std::min(minY, rowMinY);
-        maxY = std::max(maxY, rowMaxY);
+        minY = std::min(minY, v._minY);
+        maxY = std::max(maxY, v._maxY);
 
         graph->setVisible(true);
         graph->setSelectable(QCP::SelectionType::stWhole);
+        graph->setAntialiased(antialiased);
 
         graph->setPen(_pluginInstance->nodeColorForRow(row));
         graph->setName(_pluginInstance->rowName(row));
@@ -32,6 +32,7 @@
 #include "shared/utils/random.h"
 #include "shared/utils/string.h"
 #include "shared/utils/redirects.h"
+#include "shared/utils/preferences.h"
 
 #include "shared/attributes/iattribute.h"
 
@@ -41,7 +42,14 @@
 
 #include <json_helper.h>
 
+#include <QtEndian>
+
 #include <map>
+#include <limits>
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <utility>
 
 CorrelationPluginInstance::CorrelationPluginInstance()
 {
@@ -78,7 +86,6 @@ bool CorrelationPluginInstance::loadUserData(const TabularData& tabularData,
 
     parser.setProgress(-1);
 
-    uint64_t numDataPoints = static_cast<uint64_t>(tabularData.numColumns()) * tabularData.numRows();
     size_t numColumns = _numContinuousColumns + _numDiscreteColumns;
     size_t left = dataRect.x();
     size_t right = dataRect.x() + dataRect.width();
@@ -94,29 +101,27 @@ bool CorrelationPluginInstance::loadUserData(const TabularData& tabularData,
         rowAttributeColumnNames[columnIndex] = columnName;
     }
 
+    // The header rows and the row attribute columns populate user data, which isn't
+    // thread safe, so these are stored serially; they're a small fraction of the cells
     for(size_t rowIndex = 0; rowIndex < tabularData.numRows(); rowIndex++)
     {
-        for(size_t columnIndex = 0; columnIndex < tabularData.numColumns(); columnIndex++)
-        {
-            if(parser.cancelled())
-                return false;
+        if(parser.cancelled())
+            return false;
 
-            uint64_t rowOffset = static_cast<uint64_t>(rowIndex) * tabularData.numColumns();
-            uint64_t dataPoint = columnIndex + rowOffset;
-            parser.setProgress(static_cast<int>((dataPoint * 100) / numDataPoints));
+        size_t numColumnsToStore = rowIndex < top ? tabularData.numColumns() : left;
 
+        for(size_t columnIndex = 0; columnIndex < numColumnsToStore; columnIndex++)
+        {
             const auto& value = tabularData.valueAt(columnIndex, rowIndex);
 
             //FIXME: If there are continuous and discrete columns, dataColumnIndex will need to change
             size_t dataColumnIndex = columnIndex - dataRect.x();
             size_t dataRowIndex = rowIndex - dataRect.y();
             bool isColumnInDataRect = left <= columnIndex && columnIndex < right;
-            bool isRowInDataRect = top <= rowIndex && rowIndex < bottom;
             bool isColumnAnnotation = rowIndex < top;
             bool isRowAttribute = columnIndex < left;
 
-            if((isColumnInDataRect && dataColumnIndex >= numColumns) ||
-                (isRowInDataRect && dataRowIndex >= _numRows))
+            if(isColumnInDataRect && dataColumnIndex >= numColumns)
             {
                 qDebug() << QString("WARNING: Attempting to set data at coordinate (%1, %2) in "
                                     "dataRect of dimensions (%3, %4)")
@@ -140,58 +145,152 @@ bool CorrelationPluginInstance::loadUserData(const TabularData& tabularData,
                 else if(isColumnInDataRect)
                     _userColumnData.setValue(dataColumnIndex, tabularData.valueAt(0, rowIndex), value);
             }
-            else if(isColumnInDataRect)
+            else if(isRowAttribute)
+                _graphModel->userNodeData().setValue(dataRowIndex, rowAttributeColumnNames.at(columnIndex), value);
+        }
+    }
+
+    size_t numDataRows = std::min(bottom - top, _numRows);
+    size_t numDataColumns = std::min(right - left, numColumns);
+
+    if(numDataRows < bottom - top || numDataColumns < right - left)
+    {
+        qDebug() << QString("WARNING: dataRect of dimensions (%1, %2) exceeds the expected "
+                            "dimensions (%3, %4)")
+            .arg(right - left).arg(bottom - top)
+            .arg(numColumns).arg(_numRows);
+    }
+
+    std::vector<size_t> dataRowIndices(numDataRows);
+    std::iota(dataRowIndices.begin(), dataRowIndices.end(), 0);
+    std::atomic<size_t> numDataRowsStored(0);
+
+    auto setDataProgress = [&]
+    {
+        parser.setProgress(static_cast<int>((++numDataRowsStored * 100) / numDataRows));
+    };
+
+    switch(_correlationDataType)
+    {
+    default:
+    case CorrelationDataType::Continuous:
+    {
+        std::atomic<bool> valuesWereImputed(false);
+
+        parallel_for(dataRowIndices.begin(), dataRowIndices.end(), [&](size_t dataRowIndex)
+        {
+            if(parser.cancelled())
+                return;
+
+            auto rowIndex = dataRowIndex + top;
+
+            for(size_t dataColumnIndex = 0; dataColumnIndex < numDataColumns; dataColumnIndex++)
             {
-                switch(_correlationDataType)
+                auto columnIndex = dataColumnIndex + left;
+                const auto& value = tabularData.valueAt(columnIndex, rowIndex);
+                double transformedValue = 0.0;
+
+                if(!value.isEmpty())
                 {
-                default:
-                case CorrelationDataType::Continuous:
+                    bool success = false;
+                    transformedValue = value.toDouble(&success);
+                    Q_ASSERT(success);
+                }
+                else
                 {
-                    double transformedValue = 0.0;
-
-                    if(!value.isEmpty())
-                    {
-                        bool success = false;
-                        transformedValue = value.toDouble(&success);
-                        Q_ASSERT(success);
-                    }
-                    else
-                    {
-                        transformedValue = CorrelationFileParser::imputeValue(_missingDataType, _missingDataReplacementValue,
-                            tabularData, dataRect, columnIndex, rowIndex);
-                        _valuesWereImputed = true;
-                    }
-
-                    auto index = (dataRowIndex * _numContinuousColumns) + dataColumnIndex;
-                    Q_ASSERT(index < _continuousData.size());
-                    _continuousData.at(index) = transformedValue;
-                    break;
+                    transformedValue = CorrelationFileParser::imputeValue(_missingDataType, _missingDataReplacementValue,
+                        tabularData, dataRect, columnIndex, rowIndex);
+                    valuesWereImputed = true;
                 }
 
-                case CorrelationDataType::Discrete:
+                _continuousData.setValueAt(dataRowIndex, dataColumnIndex, transformedValue);
+            }
+
+            setDataProgress();
+        });
+
+        if(valuesWereImputed)
+            _valuesWereImputed = true;
+
+        break;
+    }
+
+    case CorrelationDataType::Discrete:
+    {
+        // Each thread codes its rows using its own dictionary, which are then
+        // merged into the shared dictionary and the codes remapped accordingly
+        struct ThreadDictionary
+        {
+            QHash<QString, DiscreteDataDictionary::Code> _codes;
+            std::vector<QString> _values;
+        };
+
+        std::vector<ThreadDictionary> threadDictionaries(std::max(std::thread::hardware_concurrency(), 1u));
+        std::vector<size_t> rowThreadIndices(numDataRows);
+
+        parallel_for(dataRowIndices.begin(), dataRowIndices.end(), [&](size_t dataRowIndex, size_t threadIndex)
+        {
+            if(parser.cancelled())
+                return;
+
+            auto& threadDictionary = threadDictionaries.at(threadIndex);
+            rowThreadIndices[dataRowIndex] = threadIndex;
+
+            for(size_t dataColumnIndex = 0; dataColumnIndex < numDataColumns; dataColumnIndex++)
+            {
+                const auto& value = tabularData.valueAt(dataColumnIndex + left, dataRowIndex + top);
+                auto it = threadDictionary._codes.constFind(value);
+
+                if(it == threadDictionary._codes.constEnd())
                 {
-                    auto index = (dataRowIndex * _numDiscreteColumns) + dataColumnIndex;
-                    Q_ASSERT(index < _discreteData.size());
-                    _discreteData.at(index) = value;
-                    break;
-                }
+                    auto code = static_cast<DiscreteDataDictionary::Code>(threadDictionary._values.size());
+                    it = threadDictionary._codes.insert(value, code);
+                    threadDictionary._values.push_back(value);
                 }
+
+                auto index = (dataRowIndex * _numDiscreteColumns) + dataColumnIndex;
+                Q_ASSERT(index < _discreteData.size());
+                _discreteData[index] = it.value();
             }
-            else if(isRowAttribute)
-                _graphModel->userNodeData().setValue(dataRowIndex, rowAttributeColumnNames.at(columnIndex), value);
+
+            setDataProgress();
+        });
+
+        if(parser.cancelled())
+            return false;
+
+        std::vector<std::vector<DiscreteDataDictionary::Code>> codeMaps;
+        codeMaps.reserve(threadDictionaries.size());
+
+        for(const auto& threadDictionary : threadDictionaries)
+        {
+            auto& codeMap = codeMaps.emplace_back();
+            codeMap.reserve(threadDictionary._values.size());
+
+            for(const auto& value : threadDictionary._values)
+                codeMap.push_back(_discreteDataDictionary->codeFor(value));
         }
+
+        parallel_for(dataRowIndices.begin(), dataRowIndices.end(), [&](size_t dataRowIndex)
+        {
+            const auto& codeMap = codeMaps.at(rowThreadIndices[dataRowIndex]);
+            auto* codes = &_discreteData[dataRowIndex * _numDiscreteColumns];
+
+            for(size_t dataColumnIndex = 0; dataColumnIndex < numDataColumns; dataColumnIndex++)
+                codes[dataColumnIndex] = codeMap[codes[dataColumnIndex]];
+        });
+
+        break;
+    }
     }
 
-    parser.setProgress(-1);
+    if(parser.cancelled())
+        return false;
 
-    CorrelationFileParser::clipValues(_clippingType, _clippingValue, _continuousData);
+    parser.setProgress(-1);
 
-    _continuousEpsilon = CorrelationFileParser::epsilonFor(_continuousData);
-    std::transform(_continuousData.begin(), _continuousData.end(), _continuousData.begin(),
-    [this](double value)
-    {
-        return CorrelationFileParser::scaleValue(_scalingType, value, _continuousEpsilon);
-    });
+    _continuousEpsilon = CorrelationFileParser::clipAndScale(_clippingType,
+        _clippingValue, _scalingType, _continuousData);
 
     buildDiscreteDataValueIndex(parser);
     makeDataColumnNamesUnique();
@@ -202,13 +301,8 @@ bool CorrelationPluginInstance::loadUserData(const TabularData& tabularData,
 
 void CorrelationPluginInstance::normalise(IParser* parser)
 {
+    // The rows are views of _continuousData, so this normalises it in place
     CorrelationFileParser::normalise(_normaliseType, _continuousDataRows, parser);
-
-    // Normalising obviously changes all the values in _continuousDataRows, so we
-    // must sync _data up so that it matches
-    _continuousData.clear();
-    for(const auto& dataRow : _continuousDataRows)
-        _continuousData.insert(_continuousData.end(), dataRow.begin(), dataRow.end());
 }
 
 void CorrelationPluginInstance::finishDataRows()
@@ -216,8 +310,9 @@ void CorrelationPluginInstance::finishDataRows()
     for(size_t row = 0; row < _numRows; row++)
         finishDataRow(row);
 
-    for(auto& continuousDataRow : _continuousDataRows)
-        continuousDataRow.update();
+    // Normalisation will update the rows itself, once it's done
+    if(!requiresNormalisation())
+        CorrelationFileParser::updateDataRows(_continuousDataRows);
 
     for(auto& discreteDataRow : _discreteDataRows)
         discreteDataRow.update();
@@ -265,30 +360,35 @@ void CorrelationPluginInstance::createAttributes()
             })
             .setFlag(AttributeFlag::FindShared)
             .setFlag(AttributeFlag::Searchable)
+            .setFlag(AttributeFlag::StructureIndependent)
             .setDescription(tr("The name of the data column which has the largest absolute value for "
                 "the data row associated with the node."));
 
         graphModel()->createAttribute(tr("Mean Data Value"))
             .setFloatValueFn([this](NodeId nodeId) { return continuousDataRowForNodeId(nodeId).mean(); })
             .setFlag(AttributeFlag::AutoRange)
+            .setFlag(AttributeFlag::StructureIndependent)
             .setDescription(tr("The Mean Data Value is the mean of the values associated "
                 "with the node."));
 
         graphModel()->createAttribute(tr("Minimum Data Value"))
             .setFloatValueFn([this](NodeId nodeId) { return continuousDataRowForNodeId(nodeId).minValue(); })
             .setFlag(AttributeFlag::AutoRange)
+            .setFlag(AttributeFlag::StructureIndependent)
             .setDescription(tr("The Minimum Data Value is the minimum value associated "
                 "with the node."));
 
         graphModel()->createAttribute(tr("Maximum Data Value"))
             .setFloatValueFn([this](NodeId nodeId) { return continuousDataRowForNodeId(nodeId).maxValue(); })
             .setFlag(AttributeFlag::AutoRange)
+            .setFlag(AttributeFlag::StructureIndependent)
             .setDescription(tr("The Maximum Data Value is the maximum value associated "
                 "with the node."));
 
         graphModel()->createAttribute(tr("Variance"))
             .setFloatValueFn([this](NodeId nodeId) { return continuousDataRowForNodeId(nodeId).variance(); })
             .setFlag(AttributeFlag::AutoRange)
+            .setFlag(AttributeFlag::StructureIndependent)
             .setDescription(tr("The %1 is a measure of the spread of the values associated with the node. "
                 "It is defined as ∑(<i>x</i>-µ)², where <i>x</i> is the value and µ is the mean.")
                 .arg(u::redirectLink("variance", tr("Variance"))));
@@ -296,6 +396,7 @@ void CorrelationPluginInstance::createAttributes()
         graphModel()->createAttribute(tr("Standard Deviation"))
             .setFloatValueFn([this](NodeId nodeId) { return continuousDataRowForNodeId(nodeId).stddev(); })
             .setFlag(AttributeFlag::AutoRange)
+            .setFlag(AttributeFlag::StructureIndependent)
             .setDescription(tr("The %1 is a measure of the spread of the values associated "
                 "with the node. It is defined as √∑(<i>x</i>-µ)², where <i>x</i> is the value "
                 "and µ is the mean.").arg(u::redirectLink("stddev", tr("Standard Deviation"))));
@@ -304,6 +405,7 @@ void CorrelationPluginInstance::createAttributes()
             .setFloatValueFn([this](NodeId nodeId) { return continuousDataRowForNodeId(nodeId).coefVar(); })
             .setValueMissingFn([this](NodeId nodeId) { return std::isnan(continuousDataRowForNodeId(nodeId).coefVar()); })
             .setFlag(AttributeFlag::AutoRange)
+            .setFlag(AttributeFlag::StructureIndependent)
             .setDescription(tr("The %1 is a measure of the spread of the values associated "
                 "with the node. It is defined as the standard deviation divided by the mean.")
                 .arg(u::redirectLink("coef_variation", tr("Coefficient of Variation"))));
@@ -337,6 +439,7 @@ void CorrelationPluginInstance::createAttributes()
     graphModel()->createAttribute(_correlationAttributeName)
         .setFloatValueFn([this](EdgeId edgeId) { return _correlationValues->get(edgeId); })
         .setFlag(AttributeFlag::AutoRange)
+        .setFlag(AttributeFlag::StructureIndependent)
         .setDescription(correlationAttributeDescription);
 
     auto correlationPolarity = NORMALISE_QML_ENUM(CorrelationPolarity, _correlationPolarity);
@@ -349,6 +452,7 @@ void CorrelationPluginInstance::createAttributes()
         graphModel()->createAttribute(_correlationAbsAttributeName)
             .setFloatValueFn([this](EdgeId edgeId) { return std::abs(_correlationValues->get(edgeId)); })
             .setFlag(AttributeFlag::AutoRange)
+            .setFlag(AttributeFlag::StructureIndependent)
             .setDescription(correlationAttributeDescription);
         break;
 
@@ -402,8 +506,38 @@ QStringList CorrelationPluginInstance::numericalAttributeNames() const
     return u::toQStringList(attributeNames);
 }
 
-EdgeList CorrelationPluginInstance::correlation(double minimumThreshold, IParser& parser)
+// The memory correlation edges may occupy before spilling to disk, configured in MiB
+static size_t correlationEdgesMemoryLimit()
+{
+    bool success = false;
+    auto memoryLimit = u::getPref(QStringLiteral("misc/correlationEdgesMemoryLimit")).toULongLong(&success);
+
+    if(!success || memoryLimit == 0)
+        return CorrelationEdges::DefaultMemoryLimit;
+
+    return static_cast<size_t>(memoryLimit) << 20u;
+}
+
+bool CorrelationPluginInstance::retainsCorrelations() const
+{
+    // When the edges are chosen by k-NN, they don't relate to a threshold
+    return _retainCorrelations && _edgeReductionType != EdgeReductionType::DirectKNN &&
+        _edgeReductionType != EdgeReductionType::ApproximateKNN;
+}
+
+CorrelationPolarity CorrelationPluginInstance::effectivePolarity() const
+{
+    if(NORMALISE_QML_ENUM(CorrelationDataType, _correlationDataType) == CorrelationDataType::Discrete)
+        return CorrelationPolarity::Positive;
+
+    return NORMALISE_QML_ENUM(CorrelationPolarity, _correlationPolarity);
+}
+
+CorrelationEdges CorrelationPluginInstance::correlation(double minimumThreshold, IParser& parser)
 {
+    if(retainsCorrelations())
+        minimumThreshold = std::min(minimumThreshold, _retainedCorrelationFloor);
+
     auto correlationDataType = NORMALISE_QML_ENUM(CorrelationDataType, _correlationDataType);
     switch(correlationDataType)
     {
@@ -411,37 +545,171 @@ EdgeList CorrelationPluginInstance::correlation(double minimumThreshold, IParser
     case CorrelationDataType::Continuous:
     {
         auto continuousCorrelation = ContinuousCorrelation::create(NORMALISE_QML_ENUM(CorrelationType, _continuousCorrelationType));
-        return continuousCorrelation->edgeList(_continuousDataRows, minimumThreshold,
+        continuousCorrelation->setSinglePrecision(_singlePrecision);
+        continuousCorrelation->setPruning(_correlationPruning);
+        continuousCorrelation->setMemoryLimit(correlationEdgesMemoryLimit());
+
+        if(_edgeReductionType == EdgeReductionType::DirectKNN ||
+            _edgeReductionType == EdgeReductionType::ApproximateKNN)
+        {
+            continuousCorrelation->setNumNearestNeighbours(_numNearestNeighbours);
+        }
+
+        // Correlation types that can't be approximated fall back to the exact k-NN
+        if(_edgeReductionType == EdgeReductionType::ApproximateKNN)
+            continuousCorrelation->setApproximateNearestNeighbours(true, _approximateKNNAccuracy);
+
+        return continuousCorrelation->edges(_continuousDataRows, minimumThreshold,
             NORMALISE_QML_ENUM(CorrelationPolarity, _correlationPolarity), &parser, &parser);
     }
 
     case CorrelationDataType::Discrete:
     {
         auto discreteCorrelation = DiscreteCorrelation::create(NORMALISE_QML_ENUM(CorrelationType, _discreteCorrelationType));
-        return discreteCorrelation->edgeList(_discreteDataRows, minimumThreshold, _treatAsBinary, &parser, &parser);
+        discreteCorrelation->setMemoryLimit(correlationEdgesMemoryLimit());
+
+        return discreteCorrelation->edges(_discreteDataRows, minimumThreshold, _treatAsBinary, &parser, &parser);
     }
     }
 
-    return {};
+    return CorrelationEdges{};
 }
 
-bool CorrelationPluginInstance::createEdges(const EdgeList& edges, IParser& parser)
+bool CorrelationPluginInstance::createEdges(CorrelationEdges&& edges, IParser& parser)
 {
     parser.setProgress(-1);
-    for(auto edgeIt = edges.begin(); edgeIt != edges.end(); ++edgeIt)
+
+    if(retainsCorrelations())
     {
+        _retainedCorrelations = RetainedCorrelations(std::move(edges),
+            std::min(_minimumCorrelationValue, _retainedCorrelationFloor), effectivePolarity());
+
         if(parser.cancelled())
             return false;
 
-        parser.setProgress(static_cast<int>(std::distance(edges.begin(), edgeIt)) * 100 /
-            static_cast<int>(edges.size()));
+        addRetainedEdges(_minimumCorrelationValue, std::numeric_limits<double>::max(), parser);
 
-        const auto& edge = *edgeIt;
-        auto edgeId = graphModel()->mutableGraph().addEdge(edge._source, edge._target);
-        _correlationValues->set(edgeId, edge._weight);
+        return !parser.cancelled();
     }
 
-    return true;
+    uint64_t numEdgesCreated = 0;
+
+    return edges.forEachChunk([&](const CorrelationEdges::Chunk& chunk)
+    {
+        for(const auto& edge : chunk)
+        {
+            auto edgeId = graphModel()->mutableGraph().addEdge(edge.source(), edge.target());
+            _correlationValues->set(edgeId, static_cast<double>(edge._r));
+        }
+
+        if(parser.cancelled())
+            return false;
+
+        numEdgesCreated += chunk.size();
+        parser.setProgress(static_cast<int>((numEdgesCreated * 100) / edges.size()));
+
+        return true;
+    });
+}
+
+void CorrelationPluginInstance::changeMinimumCorrelation(double minimumCorrelation)
+{
+    if(_retainedCorrelations.empty())
+        return;
+
+    minimumCorrelation = std::max(minimumCorrelation, _retainedCorrelations.floor());
+
+    commandManager()->execute(ExecutePolicy::Add,
+        std::make_unique<MinimumCorrelationCommand>(*this, minimumCorrelation));
+}
+
+void CorrelationPluginInstance::setMinimumCorrelation(double minimumCorrelation)
+{
+    _minimumCorrelationValue = minimumCorrelation;
+    emit minimumCorrelationChanged();
+}
+
+std::vector<EdgeId> CorrelationPluginInstance::addRetainedEdges(double lowerThreshold,
+    double upperThreshold, Progressable& progressable)
+{
+    std::vector<EdgeId> edgeIds;
+    auto& graph = graphModel()->mutableGraph();
+
+    graph.performTransaction([&](IMutableGraph& mutableGraph)
+    {
+        uint64_t numEdgesVisited = 0;
+        auto numEdges = _retainedCorrelations.countBetween(lowerThreshold, upperThreshold);
+
+        _retainedCorrelations.forEachBetween(lowerThreshold, upperThreshold, [&](const auto& edge)
+        {
+            progressable.setProgress(static_cast<int>((numEdgesVisited++ * 100) / numEdges));
+
+            // The nodes may have since been deleted
+            if(!mutableGraph.containsNodeId(edge.source()) || !mutableGraph.containsNodeId(edge.target()))
+                return;
+
+            auto edgeId = mutableGraph.addEdge(edge.source(), edge.target());
+            _correlationValues->set(edgeId, static_cast<double>(edge._r));
+            edgeIds.push_back(edgeId);
+        });
+    });
+
+    progressable.setProgress(-1);
+
+    return edgeIds;
+}
+
+std::vector<CorrelationEdge> CorrelationPluginInstance::removeEdgesBelow(double threshold,
+    Progressable& progressable)
+{
+    std::vector<CorrelationEdge> removedEdges;
+    auto& graph = graphModel()->mutableGraph();
+
+    for(auto edgeId : graph.edgeIds())
+    {
+        auto r = _correlationValues->get(edgeId);
+
+        if(!_retainedCorrelations.meetsThreshold(r, threshold))
+        {
+            const auto& edge = graph.edgeById(edgeId);
+            removedEdges.push_back({edgeId, edge.sourceId(), edge.targetId(), r});
+        }
+    }
+
+    if(removedEdges.empty())
+        return removedEdges;
+
+    graph.performTransaction([&](IMutableGraph& mutableGraph)
+    {
+        uint64_t numEdgesRemoved = 0;
+
+        for(const auto& removedEdge : removedEdges)
+        {
+            mutableGraph.removeEdge(removedEdge._id);
+            progressable.setProgress(static_cast<int>((numEdgesRemoved++ * 100) / removedEdges.size()));
+        }
+    });
+
+    progressable.setProgress(-1);
+
+    return removedEdges;
+}
+
+void CorrelationPluginInstance::removeEdges(const std::vector<EdgeId>& edgeIds)
+{
+    graphModel()->mutableGraph().removeEdges(edgeIds);
+}
+
+void CorrelationPluginInstance::restoreEdges(const std::vector<CorrelationEdge>& edges)
+{
+    graphModel()->mutableGraph().performTransaction([&](IMutableGraph& mutableGraph)
+    {
+        for(const auto& edge : edges)
+        {
+            mutableGraph.addEdge(edge._id, edge._source, edge._target);
+            _correlationValues->set(edge._id, edge._r);
+        }
+    });
 }
 
 void CorrelationPluginInstance::setDimensions(size_t numContinuousColumns, size_t numDiscreteColumns, size_t numRows)
@@ -457,7 +725,7 @@ void CorrelationPluginInstance::setDimensions(size_t numContinuousColumns, size_
     emit numColumnsChanged();
 
     _dataColumnNames.resize(numContinuousColumns + numDiscreteColumns);
-    _continuousData.resize(numContinuousColumns * numRows);
+    _continuousData = ContinuousDataMatrix(numRows, numContinuousColumns);
     _discreteData.resize(numDiscreteColumns * numRows);
 }
 
@@ -498,8 +766,8 @@ void CorrelationPluginInstance::finishDataRow(size_t row)
     auto nodeId = graphModel()->mutableGraph().addNode();
     auto computeCost = static_cast<uint64_t>(_numRows - row + 1);
 
-    _continuousDataRows.emplace_back(_continuousData, row, _numContinuousColumns, nodeId, computeCost);
-    _discreteDataRows.emplace_back(_discreteData, row, _numDiscreteColumns, nodeId, computeCost);
+    _continuousDataRows.emplace_back(_continuousData, row, nodeId, computeCost);
+    _discreteDataRows.emplace_back(_discreteDataDictionary, _discreteData, row, _numDiscreteColumns, nodeId, computeCost);
 
     _graphModel->userNodeData().setElementIdForIndex(nodeId, row);
 
@@ -523,7 +791,7 @@ void CorrelationPluginInstance::setNodeAttributeTableModelDataColumns()
         break;
 
     case CorrelationDataType::Discrete:
-        _nodeAttributeTableModel.addDiscreteDataColumns(_dataColumnNames, &_discreteData);
+        _nodeAttributeTableModel.addDiscreteDataColumns(_dataColumnNames, &_discreteData, _discreteDataDictionary.get());
         break;
     }
 }
@@ -543,17 +811,23 @@ void CorrelationPluginInstance::onLoadSuccess()
 {
     buildColumnAnnotations();
     _nodeAttributeTableModel.updateColumnNames();
+
+    emit retainedCorrelationsChanged();
 }
 
 void CorrelationPluginInstance::buildColumnAnnotations()
 {
     _columnAnnotations.reserve(_userColumnData.numUserDataVectors());
 
-    for(const auto& name : _userColumnData)
+    auto columnAnnotations = parallel_for(_userColumnData.begin(), _userColumnData.end(),
+    [this](const QString& name)
     {
         const auto* values = _userColumnData.vector(name);
-        _columnAnnotations.emplace_back(name, values->begin(), values->end());
-    }
+        return ColumnAnnotation(name, values->begin(), values->end());
+    });
+
+    for(auto& columnAnnotation : columnAnnotations)
+        _columnAnnotations.emplace_back(std::move(columnAnnotation));
 
     emit columnAnnotationNamesChanged();
 }
@@ -564,27 +838,63 @@ void CorrelationPluginInstance::buildDiscreteDataValueIndex(Progressable& progre
     if(_correlationDataType != CorrelationDataType::Discrete)
         return;
 
-    size_t dataValueIndex = 0;
+    const auto& dictionary = *_discreteDataDictionary;
+
+    // Rank the codes by value once, so that each column's codes can then be sorted cheaply
+    std::vector<size_t> codeRanks(dictionary.size());
+    auto sortedCodes = dictionary.sortedCodes();
+    for(size_t rank = 0; rank < sortedCodes.size(); rank++)
+        codeRanks[sortedCodes[rank]] = rank;
+
+    auto byRank = [&codeRanks](auto a, auto b) { return codeRanks[a] < codeRanks[b]; };
+
+    std::vector<size_t> columnIndices(_numDiscreteColumns);
+    std::iota(columnIndices.begin(), columnIndices.end(), 0);
+    std::atomic<size_t> numColumnsProcessed(0);
 
-    for(size_t columnIndex = 0; columnIndex < _numDiscreteColumns; columnIndex++)
+    std::vector<std::vector<size_t>> threadColumnLastSeen(std::max(std::thread::hardware_concurrency(), 1u));
+
+    // Find the distinct codes of each column, in value order
+    auto columnsCodes = parallel_for(columnIndices.begin(), columnIndices.end(),
+    [&](size_t columnIndex, size_t threadIndex)
     {
-        std::set<QString> values;
+        auto& columnLastSeen = threadColumnLastSeen.at(threadIndex);
+        if(columnLastSeen.empty())
+            columnLastSeen.resize(dictionary.size(), std::numeric_limits<size_t>::max());
+
+        std::vector<DiscreteDataDictionary::Code> codes;
 
         for(size_t rowIndex = 0; rowIndex < _numRows; rowIndex++)
-            values.emplace(discreteDataAt(static_cast<int>(rowIndex), static_cast<int>(columnIndex)));
+        {
+            auto code = _discreteData[(rowIndex * _numDiscreteColumns) + columnIndex];
+            if(columnLastSeen[code] != columnIndex)
+            {
+                columnLastSeen[code] = columnIndex;
+                codes.push_back(code);
+            }
+        }
+
+        std::sort(codes.begin(), codes.end(), byRank);
 
-        std::vector<QString> sortedValues;
-        sortedValues.reserve(values.size());
-        std::copy(values.begin(), values.end(), std::back_inserter(sortedValues));
-        std::sort(sortedValues.begin(), sortedValues.end());
+        progressable.setProgress(static_cast<int>((++numColumnsProcessed * 100) / _numDiscreteColumns));
+
+        return codes;
+    });
 
-        for(const auto& sortedValue : sortedValues)
+    // Then index them in column order, which is inherently serial, but cheap
+    std::vector<bool> indexed(dictionary.size(), false);
+    size_t dataValueIndex = 0;
+
+    for(const auto& codes : columnsCodes)
+    {
+        for(auto code : codes)
         {
-            if(!u::contains(_discreteDataValueIndex, sortedValue))
-                _discreteDataValueIndex[sortedValue] = dataValueIndex++;
+            if(!indexed[code])
+            {
+                _discreteDataValueIndex[dictionary.valueOf(code)] = dataValueIndex++;
+                indexed[code] = true;
+            }
         }
-
-        progressable.setProgress(static_cast<int>((columnIndex * 100) / _numDiscreteColumns));
     }
 }
 
@@ -635,6 +945,10 @@ void CorrelationPluginInstance::applyParameter(const QString& name, const QVaria
         _discreteCorrelationType = NORMALISE_QML_ENUM(CorrelationType, value.toInt());
     else if(name == QStringLiteral("correlationPolarity"))
         _correlationPolarity = NORMALISE_QML_ENUM(CorrelationPolarity, value.toInt());
+    else if(name == QStringLiteral("singlePrecision"))
+        _singlePrecision = value.toBool();
+    else if(name == QStringLiteral("correlationPruning"))
+        _correlationPruning = NORMALISE_QML_ENUM(CorrelationPruning, value.toInt());
     else if(name == QStringLiteral("scaling"))
         _scalingType = NORMALISE_QML_ENUM(ScalingType, value.toInt());
     else if(name == QStringLiteral("normalise"))
@@ -649,12 +963,20 @@ void CorrelationPluginInstance::applyParameter(const QString& name, const QVaria
         _clippingValue = value.toDouble();
     else if(name == QStringLiteral("treatAsBinary"))
         _treatAsBinary = value.toBool();
+    else if(name == QStringLiteral("retainCorrelations"))
+        _retainCorrelations = value.toBool();
+    else if(name == QStringLiteral("retainedCorrelationFloor"))
+        _retainedCorrelationFloor = value.toDouble();
     else if(name == QStringLiteral("dataRect"))
         _dataRect = value.toRect();
     else if(name == QStringLiteral("clusteringType"))
         _clusteringType = NORMALISE_QML_ENUM(ClusteringType, value.toInt());
     else if(name == QStringLiteral("edgeReductionType"))
         _edgeReductionType = NORMALISE_QML_ENUM(EdgeReductionType, value.toInt());
+    else if(name == QStringLiteral("numNearestNeighbours"))
+        _numNearestNeighbours = static_cast<size_t>(std::max(value.toInt(), 1));
+    else if(name == QStringLiteral("approximateKNNAccuracy"))
+        _approximateKNNAccuracy = value.toDouble();
     else if(name == QStringLiteral("data") && value.canConvert<std::shared_ptr<TabularData>>())
         _tabularData = std::move(*value.value<std::shared_ptr<TabularData>>());
     else
@@ -696,9 +1018,19 @@ QStringList CorrelationPluginInstance::defaultTransforms() const
 
     if(_edgeReductionType == EdgeReductionType::KNN)
     {
-        defaultTransforms.append(QStringLiteral(R"("k-NN" using $"%1")")
+        defaultTransforms.append(QStringLiteral(R"("k-NN" using $"%1" with "k" = %2)")
             .arg(correlationPolarity == CorrelationPolarity::Positive ?
-            _correlationAttributeName : _correlationAbsAttributeName));
+            _correlationAttributeName : _correlationAbsAttributeName)
+            .arg(_numNearestNeighbours));
+    }
+    else if(_edgeReductionType == EdgeReductionType::DirectKNN ||
+        _edgeReductionType == EdgeReductionType::ApproximateKNN)
+    {
+        // Only the edges required by a k-NN of this k have been created, so k can't be exceeded
+        defaultTransforms.append(QStringLiteral(R"("k-NN" using $"%1" with "k" = %2)")
+            .arg(correlationPolarity == CorrelationPolarity::Positive ?
+            _correlationAttributeName : _correlationAbsAttributeName)
+            .arg(_numNearestNeighbours));
     }
     else if(_edgeReductionType == EdgeReductionType::PercentNN)
     {
@@ -728,12 +1060,12 @@ QStringList CorrelationPluginInstance::defaultVisualisations() const
 
 double CorrelationPluginInstance::continuousDataAt(int row, int column) const
 {
-    return _continuousData.at((row * _numContinuousColumns) + column);
+    return _continuousData.valueAt(static_cast<size_t>(row), static_cast<size_t>(column));
 }
 
 QString CorrelationPluginInstance::discreteDataAt(int row, int column) const
 {
-    return _discreteData.at((row * _numDiscreteColumns) + column);
+    return _discreteDataDictionary->valueOf(_discreteData.at((row * _numDiscreteColumns) + column));
 }
 
 int CorrelationPluginInstance::discreteDataValueIndex(const QString& value) const
@@ -787,12 +1119,26 @@ QString CorrelationPluginInstance::attributeValueFor(const QString& attributeNam
     return attribute->stringValueOf(nodeId);
 }
 
+void CorrelationPluginInstance::setClusteringLinkage(int clusteringLinkage)
+{
+    auto linkage = NORMALISE_QML_ENUM(ClusteringLinkage, clusteringLinkage);
+
+    if(linkage == _clusteringLinkage)
+        return;
+
+    // Any existing ordering was computed using the previous linkage
+    _clusteringLinkage = linkage;
+    _continuousHcOrder.clear();
+
+    emit clusteringLinkageChanged();
+}
+
 void CorrelationPluginInstance::computeHierarchicalClustering()
 {
     if(_continuousHcOrder.empty())
     {
         commandManager()->execute(ExecutePolicy::Once, std::make_unique<HierarchicalClusteringCommand>(
-            _continuousData, _numContinuousColumns, _numRows, *this));
+            _continuousData, _clusteringLinkage, *this));
     }
     else
         emit hierarchicalClusteringComplete();
@@ -812,6 +1158,39 @@ size_t CorrelationPluginInstance::hcColumn(size_t column) const
     return _continuousHcOrder.at(column);
 }
 
+// Bulk data is saved as base64 encoded little endian arrays, as formatting and
+// parsing large JSON arrays of numbers is extremely slow, by comparison
+template<typename T>
+static void appendLittleEndian(QByteArray& byteArray, const T* values, size_t count)
+{
+    auto offset = byteArray.size();
+    byteArray.resize(offset + static_cast<qsizetype>(count * sizeof(T)));
+    qToLittleEndian<T>(values, static_cast<qsizetype>(count), byteArray.data() + offset);
+}
+
+static QByteArray bytesFromBase64(const json& jsonValue)
+{
+    if(!jsonValue.is_string())
+        return {};
+
+    const auto& base64 = jsonValue.get_ref<const std::string&>();
+    return QByteArray::fromBase64(QByteArray::fromRawData(base64.data(),
+        static_cast<qsizetype>(base64.size())));
+}
+
+template<typename T>
+static bool valuesFromBase64(const json& jsonValue, std::vector<T>& values)
+{
+    auto byteArray = bytesFromBase64(jsonValue);
+    if(byteArray.size() % static_cast<qsizetype>(sizeof(T)) != 0)
+        return false;
+
+    values.resize(static_cast<size_t>(byteArray.size()) / sizeof(T));
+    qFromLittleEndian<T>(byteArray.constData(), static_cast<qsizetype>(values.size()), values.data());
+
+    return true;
+}
+
 QByteArray CorrelationPluginInstance::save(IMutableGraph& graph, Progressable& progressable) const
 {
     json jsonObject;
@@ -825,38 +1204,51 @@ QByteArray CorrelationPluginInstance::save(IMutableGraph& graph, Progressable& p
     graph.setPhase(QObject::tr("Data"));
     jsonObject["continuousData"] = [&]
     {
-        json array;
+        QByteArray byteArray;
+        byteArray.reserve(static_cast<qsizetype>(graph.nodeIds().size() *
+            _numContinuousColumns * sizeof(double)));
 
         uint64_t i = 0;
         for(const auto& nodeId : graph.nodeIds())
         {
             const auto& dataRow = continuousDataRowForNodeId(nodeId);
-            std::copy(dataRow.begin(), dataRow.end(), std::back_inserter(array));
+            appendLittleEndian(byteArray, dataRow.data(), dataRow.size());
 
             progressable.setProgress(static_cast<int>((i++) * 100 / graph.nodeIds().size()));
         }
 
         progressable.setProgress(-1);
 
-        return array;
+        return byteArray.toBase64().toStdString();
     }();
 
     jsonObject["discreteData"] = [&]
     {
-        json array;
+        // The codes are saved along with the dictionary that they index
+        json dictionary = json::array();
+        for(size_t code = 0; code < _discreteDataDictionary->size(); code++)
+            dictionary.push_back(_discreteDataDictionary->valueOf(static_cast<DiscreteDataDictionary::Code>(code)));
+
+        QByteArray byteArray;
+        byteArray.reserve(static_cast<qsizetype>(graph.nodeIds().size() *
+            _numDiscreteColumns * sizeof(DiscreteDataDictionary::Code)));
 
         uint64_t i = 0;
         for(const auto& nodeId : graph.nodeIds())
         {
-            const auto& dataRow = discreteDataRowForNodeId(nodeId);
-            std::copy(dataRow.begin(), dataRow.end(), std::back_inserter(array));
+            const auto& codes = discreteDataRowForNodeId(nodeId).data();
+            appendLittleEndian(byteArray, codes.data(), codes.size());
 
             progressable.setProgress(static_cast<int>((i++) * 100 / graph.nodeIds().size()));
         }
 
         progressable.setProgress(-1);
 
-        return array;
+        json object;
+        object["dictionary"] = dictionary;
+        object["codes"] = byteArray.toBase64().toStdString();
+
+        return object;
     }();
 
     jsonObject["hcOrdering"] = [&]
@@ -876,9 +1268,39 @@ QByteArray CorrelationPluginInstance::save(IMutableGraph& graph, Progressable& p
     }();
 
     graph.setPhase(QObject::tr("Correlation Values"));
-    jsonObject["correlationValues"] = u::graphArrayAsJson(*_correlationValues, graph.edgeIds(), &progressable);
+    jsonObject["correlationValues"] = [&]
+    {
+        std::vector<int32_t> edgeIds;
+        std::vector<double> values;
+        edgeIds.reserve(graph.edgeIds().size());
+        values.reserve(graph.edgeIds().size());
+
+        uint64_t i = 0;
+        for(auto edgeId : graph.edgeIds())
+        {
+            edgeIds.push_back(static_cast<int32_t>(static_cast<int>(edgeId)));
+            values.push_back(_correlationValues->at(edgeId));
+
+            progressable.setProgress(static_cast<int>((i++) * 100 / graph.edgeIds().size()));
+        }
+
+        progressable.setProgress(-1);
+
+        QByteArray edgeIdsByteArray;
+        appendLittleEndian(edgeIdsByteArray, edgeIds.data(), edgeIds.size());
+
+        QByteArray valuesByteArray;
+        appendLittleEndian(valuesByteArray, values.data(), values.size());
+
+        json object;
+        object["edgeIds"] = edgeIdsByteArray.toBase64().toStdString();
+        object["values"] = valuesByteArray.toBase64().toStdString();
+
+        return object;
+    }();
 
     jsonObject["minimumCorrelationValue"] = _minimumCorrelationValue;
+    jsonObject["clusteringLinkage"] = static_cast<int>(_clusteringLinkage);
     jsonObject["transpose"] = _transpose;
     jsonObject["correlationDataType"] = static_cast<int>(_correlationDataType);
     jsonObject["continuousCorrelationType"] = static_cast<int>(_continuousCorrelationType);
@@ -891,6 +1313,12 @@ QByteArray CorrelationPluginInstance::save(IMutableGraph& graph, Progressable& p
     jsonObject["clippingType"] = static_cast<int>(_clippingType);
     jsonObject["clippingValue"] = _clippingValue;
 
+    if(!_retainedCorrelations.empty())
+    {
+        graph.setPhase(QObject::tr("Retained Correlations"));
+        jsonObject["retainedCorrelations"] = _retainedCorrelations.save();
+    }
+
     return QByteArray::fromStdString(jsonObject.dump());
 }
 
@@ -953,16 +1381,70 @@ bool CorrelationPluginInstance::load(const QByteArray& data, int dataVersion, IM
     if(!u::contains(jsonObject, continuousDataKey))
         return false;
 
+    _continuousData = ContinuousDataMatrix(_numRows, _numContinuousColumns);
+
     const auto& jsonContinuousData = jsonObject[continuousDataKey];
-    for(const auto& value : jsonContinuousData)
+
+    if(dataVersion >= 12)
+    {
+        auto byteArray = bytesFromBase64(jsonContinuousData);
+        auto rowSize = _numContinuousColumns * sizeof(double);
+
+        if(rowSize > 0)
+        {
+            auto numRows = static_cast<size_t>(byteArray.size()) / rowSize;
+            if(static_cast<size_t>(byteArray.size()) % rowSize != 0 || numRows > _numRows)
+                return false;
+
+            for(size_t row = 0; row < numRows; row++)
+            {
+                qFromLittleEndian<double>(byteArray.constData() + (row * rowSize),
+                    static_cast<qsizetype>(_numContinuousColumns), _continuousData.row(row));
+
+                parser.setProgress(static_cast<int>((row * 100) / numRows));
+            }
+        }
+    }
+    else
     {
-        _continuousData.emplace_back(value);
-        parser.setProgress(static_cast<int>((i++ * 100) / jsonContinuousData.size()));
+        for(const auto& value : jsonContinuousData)
+        {
+            auto row = _numContinuousColumns > 0 ? i / _numContinuousColumns : _numRows;
+            if(row < _numRows)
+                _continuousData.setValueAt(row, i % _numContinuousColumns, value);
+
+            parser.setProgress(static_cast<int>((i++ * 100) / jsonContinuousData.size()));
+        }
     }
 
     _continuousEpsilon = CorrelationFileParser::epsilonFor(_continuousData);
 
-    if(dataVersion >= 7)
+    if(dataVersion >= 12)
+    {
+        if(!u::contains(jsonObject, "discreteData"))
+            return false;
+
+        const auto& jsonDiscreteData = jsonObject["discreteData"];
+        if(!jsonDiscreteData.is_object() || !u::containsAllOf(jsonDiscreteData, {"dictionary", "codes"}))
+            return false;
+
+        // The saved codes are translated to those of the dictionary being built
+        std::vector<DiscreteDataDictionary::Code> codeMap;
+        for(const auto& value : jsonDiscreteData["dictionary"])
+            codeMap.push_back(_discreteDataDictionary->codeFor(QString::fromStdString(value)));
+
+        if(!valuesFromBase64(jsonDiscreteData["codes"], _discreteData))
+            return false;
+
+        for(auto& code : _discreteData)
+        {
+            if(code >= codeMap.size())
+                return false;
+
+            code = codeMap[code];
+        }
+    }
+    else if(dataVersion >= 7)
     {
         if(!u::contains(jsonObject, "discreteData"))
             return false;
@@ -971,7 +1453,7 @@ bool CorrelationPluginInstance::load(const QByteArray& data, int dataVersion, IM
         const auto& jsonDiscreteData = jsonObject["discreteData"];
         for(const auto& value : jsonDiscreteData)
         {
-            _discreteData.emplace_back(QString::fromStdString(value));
+            _discreteData.emplace_back(_discreteDataDictionary->codeFor(QString::fromStdString(value)));
             parser.setProgress(static_cast<int>((i++ * 100) / jsonDiscreteData.size()));
         }
     }
@@ -990,6 +1472,10 @@ bool CorrelationPluginInstance::load(const QByteArray& data, int dataVersion, IM
         }
     }
 
+    // Absent before linkages other than single were available
+    if(u::contains(jsonObject, "clusteringLinkage"))
+        _clusteringLinkage = NORMALISE_QML_ENUM(ClusteringLinkage, jsonObject["clusteringLinkage"]);
+
     parser.setProgress(-1);
 
     for(size_t row = 0; row < _numRows; row++)
@@ -998,8 +1484,8 @@ bool CorrelationPluginInstance::load(const QByteArray& data, int dataVersion, IM
 
         if(!nodeId.isNull())
         {
-            _continuousDataRows.emplace_back(_continuousData, row, _numContinuousColumns, nodeId).update();
-            _discreteDataRows.emplace_back(_discreteData, row, _numDiscreteColumns, nodeId).update();
+            _continuousDataRows.emplace_back(_continuousData, row, nodeId).update();
+            _discreteDataRows.emplace_back(_discreteDataDictionary, _discreteData, row, _numDiscreteColumns, nodeId).update();
         }
 
         parser.setProgress(static_cast<int>((row * 100) / _numRows));
@@ -1020,7 +1506,31 @@ bool CorrelationPluginInstance::load(const QByteArray& data, int dataVersion, IM
     graph.setPhase(QObject::tr("Correlation Values"));
     i = 0;
 
-    if(dataVersion >= 2)
+    if(dataVersion >= 12)
+    {
+        if(!jsonCorrelationValues.is_object() || !u::containsAllOf(jsonCorrelationValues, {"edgeIds", "values"}))
+            return false;
+
+        std::vector<int32_t> edgeIds;
+        std::vector<double> values;
+
+        if(!valuesFromBase64(jsonCorrelationValues["edgeIds"], edgeIds) ||
+            !valuesFromBase64(jsonCorrelationValues["values"], values) ||
+            edgeIds.size() != values.size())
+        {
+            return false;
+        }
+
+        for(size_t index = 0; index < edgeIds.size(); index++)
+        {
+            auto edgeId = static_cast<EdgeId>(edgeIds[index]);
+            Q_ASSERT(graph.containsEdgeId(edgeId));
+            _correlationValues->set(edgeId, values[index]);
+
+            parser.setProgress(static_cast<int>((index * 100) / edgeIds.size()));
+        }
+    }
+    else if(dataVersion >= 2)
     {
         u::forEachJsonGraphArray(jsonCorrelationValues, [&](EdgeId edgeId, double correlationValue)
         {
@@ -1090,6 +1600,14 @@ bool CorrelationPluginInstance::load(const QByteArray& data, int dataVersion, IM
         _correlationPolarity = NORMALISE_QML_ENUM(CorrelationPolarity, jsonObject["correlationPolarity"]);
     }
 
+    if(u::contains(jsonObject, "retainedCorrelations"))
+    {
+        graph.setPhase(QObject::tr("Retained Correlations"));
+
+        if(!_retainedCorrelations.load(jsonObject["retainedCorrelations"]))
+            return false;
+    }
+
     createAttributes();
     buildDiscreteDataValueIndex(parser);
     makeDataColumnNamesUnique();
@@ -1135,6 +1653,12 @@ QString CorrelationPluginInstance::log() const
     text.append(tr("\nMinimum Correlation Value: %1").arg(
         u::formatNumberScientific(_minimumCorrelationValue)));
 
+    if(retainsCorrelations())
+    {
+        text.append(tr("\nRetained Correlations Above: %1").arg(
+            u::formatNumberScientific(std::min(_minimumCorrelationValue, _retainedCorrelationFloor))));
+    }
+
     if(_valuesWereImputed)
     {
         text.append(tr("\nImputation: "));
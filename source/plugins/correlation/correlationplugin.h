@@ -32,7 +32,10 @@
 
 #include "columnannotation.h"
 #include "correlationdatavector.h"
+#include "correlationedges.h"
 #include "correlationnodeattributetablemodel.h"
+#include "minimumcorrelationcommand.h"
+#include "retainedcorrelations.h"
 
 #include <vector>
 #include <map>
@@ -68,6 +71,12 @@ class CorrelationPluginInstance : public BasePluginInstance
     Q_PROPERTY(size_t numContinuousColumns MEMBER _numContinuousColumns NOTIFY numColumnsChanged)
     Q_PROPERTY(size_t numDiscreteColumns MEMBER _numDiscreteColumns NOTIFY numColumnsChanged)
 
+    Q_PROPERTY(double minimumCorrelation READ minimumCorrelation NOTIFY minimumCorrelationChanged)
+    Q_PROPERTY(int clusteringLinkage READ clusteringLinkage
+        WRITE setClusteringLinkage NOTIFY clusteringLinkageChanged)
+    Q_PROPERTY(bool hasRetainedCorrelations READ hasRetainedCorrelations NOTIFY retainedCorrelationsChanged)
+    Q_PROPERTY(double retainedCorrelationFloor READ retainedCorrelationFloor NOTIFY retainedCorrelationsChanged)
+
 public:
     CorrelationPluginInstance();
 
@@ -85,8 +94,10 @@ private:
 
     CorrelationNodeAttributeTableModel _nodeAttributeTableModel;
 
-    std::vector<double> _continuousData;
-    std::vector<QString> _discreteData;
+    ContinuousDataMatrix _continuousData;
+    std::shared_ptr<DiscreteDataDictionary> _discreteDataDictionary =
+        std::make_shared<DiscreteDataDictionary>();
+    std::vector<DiscreteDataDictionary::Code> _discreteData;
 
     ContinuousDataVectors _continuousDataRows;
     DiscreteDataVectors _discreteDataRows;
@@ -96,6 +107,7 @@ private:
     double _continuousEpsilon = std::nextafter(0.0, 1.0);
 
     std::vector<size_t> _continuousHcOrder;
+    ClusteringLinkage _clusteringLinkage = ClusteringLinkage::Single;
 
     std::unique_ptr<EdgeArray<double>> _correlationValues;
     double _minimumCorrelationValue = 0.7;
@@ -107,6 +119,8 @@ private:
     CorrelationType _continuousCorrelationType = CorrelationType::Pearson;
     CorrelationType _discreteCorrelationType = CorrelationType::Jaccard;
     CorrelationPolarity _correlationPolarity = CorrelationPolarity::Positive;
+    bool _singlePrecision = false;
+    CorrelationPruning _correlationPruning = CorrelationPruning::None;
     ScalingType _scalingType = ScalingType::None;
     NormaliseType _normaliseType = NormaliseType::None;
     MissingDataType _missingDataType = MissingDataType::Constant;
@@ -114,11 +128,17 @@ private:
     ClippingType _clippingType = ClippingType::None;
     double _clippingValue = 0.0;
     bool _treatAsBinary = false;
+    bool _retainCorrelations = false;
+    double _retainedCorrelationFloor = 0.5;
     ClusteringType _clusteringType = ClusteringType::None;
     EdgeReductionType _edgeReductionType = EdgeReductionType::None;
+    size_t _numNearestNeighbours = 5;
+    double _approximateKNNAccuracy = 0.5;
 
     bool _valuesWereImputed = false;
 
+    RetainedCorrelations _retainedCorrelations;
+
     QString _correlationAttributeName;
     QString _correlationAbsAttributeName;
 
@@ -145,6 +165,9 @@ private:
 
     void setHighlightedRows(const QVector<int>& highlightedRows);
 
+    bool retainsCorrelations() const;
+    CorrelationPolarity effectivePolarity() const;
+
     QStringList sharedValuesAttributeNames() const;
     QStringList numericalAttributeNames() const;
 
@@ -156,13 +179,26 @@ public:
     void finishDataRows();
     void createAttributes();
 
-    EdgeList correlation(double minimumThreshold, IParser& parser);
+    CorrelationEdges correlation(double minimumThreshold, IParser& parser);
 
     double minimumCorrelation() const { return _minimumCorrelationValue; }
     bool transpose() const { return _transpose; }
     CorrelationDataType dataType() const { return _correlationDataType; }
 
-    bool createEdges(const EdgeList& edges, IParser& parser);
+    bool createEdges(CorrelationEdges&& edges, IParser& parser);
+
+    bool hasRetainedCorrelations() const { return !_retainedCorrelations.empty(); }
+    double retainedCorrelationFloor() const { return _retainedCorrelations.floor(); }
+
+    Q_INVOKABLE void changeMinimumCorrelation(double minimumCorrelation);
+    void setMinimumCorrelation(double minimumCorrelation);
+
+    // Adds the retained edges whose correlation values lie in [lowerThreshold, upperThreshold)
+    std::vector<EdgeId> addRetainedEdges(double lowerThreshold, double upperThreshold,
+        Progressable& progressable);
+    std::vector<CorrelationEdge> removeEdgesBelow(double threshold, Progressable& progressable);
+    void removeEdges(const std::vector<EdgeId>& edgeIds);
+    void restoreEdges(const std::vector<CorrelationEdge>& edges);
 
     std::unique_ptr<IParser> parserForUrlTypeName(const QString& urlTypeName) override;
     void applyParameter(const QString& name, const QVariant& value) override;
@@ -171,6 +207,7 @@ public:
 
     size_t numContinuousColumns() const { return _numContinuousColumns; }
     double continuousDataAt(int row, int column) const;
+    const ContinuousDataMatrix& continuousData() const { return _continuousData; }
     double continuousEpsilon() const { return _continuousEpsilon; }
 
     size_t numDiscreteColumns() const { return _numDiscreteColumns; }
@@ -187,6 +224,9 @@ public:
 
     QString attributeValueFor(const QString& attributeName, int row) const;
 
+    int clusteringLinkage() const { return static_cast<int>(_clusteringLinkage); }
+    void setClusteringLinkage(int clusteringLinkage);
+
     Q_INVOKABLE void computeHierarchicalClustering();
     void setHcOrdering(const std::vector<size_t>& ordering);
     size_t hcColumn(size_t column) const;
@@ -207,6 +247,9 @@ signals:
     void highlightedRowsChanged();
     void numColumnsChanged();
     void hierarchicalClusteringComplete();
+    void clusteringLinkageChanged();
+    void minimumCorrelationChanged();
+    void retainedCorrelationsChanged();
 };
 
 class CorrelationPlugin : public BasePlugin, public PluginInstanceProvider<CorrelationPluginInstance>
@@ -226,7 +269,7 @@ public:
 
     QString imageSource() const override { return QStringLiteral("qrc:///plots.svg"); }
 
-    int dataVersion() const override { return 11; }
+    int dataVersion() const override { return 12; }
 
     QStringList identifyUrl(const QUrl& url) const override;
     QString failureReason(const QUrl& url) const override;
@@ -0,0 +1,257 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "correlationpruner.h"
+#include "distancekernels.h"
+
+#include "shared/utils/threadpool.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <numbers>
+#include <cmath>
+
+// Allows for the rows not being exactly unit length, in particular when T is float
+static constexpr double BoundEpsilon = 1e-4;
+
+// Sets of rows at least this large are bisected concurrently
+static constexpr size_t ParallelBisectionSize = 4096;
+
+// The number of standard deviations the estimated angle between a pair of rows may
+// exceed the threshold angle by, before the pair is considered to not be a candidate
+static constexpr double HashMarginStandardDeviations = 3.0;
+
+template<typename T>
+CorrelationPruner<T>::CorrelationPruner(StandardisedRows<T>& rows, CorrelationPruning pruning,
+    double threshold, CorrelationPolarity polarity, ThreadPool& threadPool) :
+    _pruning(pruning), _threshold(threshold), _polarity(polarity),
+    _tileSize(rows.tileSize()), _tileDirections(0, rows.numColumns())
+{
+    _order.resize(rows.numRows());
+    std::iota(_order.begin(), _order.end(), 0);
+
+    std::vector<char> hasLength(rows.numRows());
+    threadPool.parallel_for(_order.begin(), _order.end(), [&](size_t index)
+    {
+        const auto* row = rows.row(index);
+        auto squaredNorm = static_cast<double>(dotProduct(row, row, rows.numColumns()));
+        hasLength[index] = std::isfinite(squaredNorm) && squaredNorm > BoundEpsilon ? 1 : 0;
+    });
+
+    auto withoutLength = std::stable_partition(_order.begin(), _order.end(),
+        [&](size_t index) { return hasLength[index] != 0; });
+    _numRows = static_cast<size_t>(std::distance(_order.begin(), withoutLength));
+
+    std::vector<double> keys(rows.numRows());
+    bisect(rows, 0, _numRows, keys, threadPool);
+    rows.reorder(_order);
+
+    computeTileBounds(rows, threadPool);
+
+    if(_pruning == CorrelationPruning::Approximate)
+    {
+        computeHashes(rows, threadPool);
+
+        // The fraction of hash bits that differ between a pair of rows is an estimate
+        // of the angle between them, as a proportion of π, with a binomial error
+        auto thresholdAngle = std::acos(std::clamp(threshold, -1.0, 1.0));
+        auto p = thresholdAngle / std::numbers::pi;
+        auto standardDeviation = std::sqrt((p * (1.0 - p)) / static_cast<double>(NumHashBits));
+        auto maxFraction = p + (HashMarginStandardDeviations * standardDeviation);
+
+        _maxHammingDistance = std::min(NumHashBits,
+            static_cast<size_t>(std::ceil(maxFraction * static_cast<double>(NumHashBits))));
+    }
+}
+
+// Splits the rows in [begin, end) of _order between the two rows within it that are
+// furthest apart, then does the same for each half, until each part fits in a tile
+template<typename T>
+void CorrelationPruner<T>::bisect(const StandardisedRows<T>& rows, size_t begin, size_t end,
+    std::vector<double>& keys, ThreadPool& threadPool)
+{
+    auto size = end - begin;
+    if(size <= _tileSize)
+        return;
+
+    auto first = _order.begin() + static_cast<std::ptrdiff_t>(begin);
+    auto last = _order.begin() + static_cast<std::ptrdiff_t>(end);
+
+    auto computeKeys = [&](auto&& keyFn)
+    {
+        auto fn = [&](size_t index) { keys[index] = keyFn(rows.row(index)); };
+
+        if(size >= ParallelBisectionSize)
+            threadPool.parallel_for(first, last, fn);
+        else
+            std::for_each(first, last, fn);
+    };
+
+    auto leastKey = [&]
+    {
+        return *std::min_element(first, last, [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+    };
+
+    // The row least similar to an arbitrary row, then the row least similar to that
+    const auto* arbitrary = rows.row(*first);
+    computeKeys([&](const T* row) { return static_cast<double>(dotProduct(row, arbitrary, rows.numColumns())); });
+    const auto* extremeA = rows.row(leastKey());
+    computeKeys([&](const T* row) { return static_cast<double>(dotProduct(row, extremeA, rows.numColumns())); });
+    const auto* extremeB = rows.row(leastKey());
+
+    computeKeys([&](const T* row)
+    {
+        return static_cast<double>(dotProduct(row, extremeA, rows.numColumns())) -
+            static_cast<double>(dotProduct(row, extremeB, rows.numColumns()));
+    });
+
+    // Split on a tile boundary, such that each half consists of whole tiles
+    auto numTiles = (size + _tileSize - 1) / _tileSize;
+    auto split = begin + (((numTiles + 1) / 2) * _tileSize);
+
+    std::nth_element(first, _order.begin() + static_cast<std::ptrdiff_t>(split), last,
+        [&](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+    bisect(rows, begin, split, keys, threadPool);
+    bisect(rows, split, end, keys, threadPool);
+}
+
+template<typename T>
+void CorrelationPruner<T>::computeTileBounds(const StandardisedRows<T>& rows, ThreadPool& threadPool)
+{
+    std::vector<size_t> tiles;
+    for(size_t tile = 0; tile * _tileSize < _numRows; tile++)
+        tiles.push_back(tile);
+
+    _tileDirections = StandardisedRows<T>(tiles.size(), rows.numColumns());
+    _tileRadii.resize(tiles.size());
+
+    if(tiles.empty())
+        return;
+
+    threadPool.parallel_for(tiles.begin(), tiles.end(), [&](size_t tile)
+    {
+        auto firstRow = tile * _tileSize;
+        auto lastRow = std::min(firstRow + _tileSize, _numRows);
+
+        std::vector<double> direction(rows.numColumns(), 0.0);
+        for(auto row = firstRow; row < lastRow; row++)
+        {
+            const auto* values = rows.row(row);
+            for(size_t column = 0; column < rows.numColumns(); column++)
+                direction[column] += static_cast<double>(values[column]);
+        }
+
+        auto magnitude = std::sqrt(std::inner_product(direction.begin(), direction.end(), direction.begin(), 0.0));
+        auto* tileDirection = _tileDirections.row(tile);
+
+        if(magnitude <= 0.0)
+        {
+            // The rows cancel each other out, so no useful bound can be given
+            std::fill(tileDirection, tileDirection + rows.numColumns(), T{0});
+            _tileRadii[tile] = std::numbers::pi;
+            return;
+        }
+
+        for(size_t column = 0; column < rows.numColumns(); column++)
+            tileDirection[column] = static_cast<T>(direction[column] / magnitude);
+
+        double radius = 0.0;
+        for(auto row = firstRow; row < lastRow; row++)
+        {
+            auto dot = static_cast<double>(dotProduct(rows.row(row), tileDirection, rows.numColumns()));
+            radius = std::max(radius, std::acos(std::clamp(dot, -1.0, 1.0)));
+        }
+
+        _tileRadii[tile] = radius;
+    });
+}
+
+template<typename T>
+void CorrelationPruner<T>::computeHashes(const StandardisedRows<T>& rows, ThreadPool& threadPool)
+{
+    // Random hyperplanes are generated deterministically, so that results are repeatable
+    StandardisedRows<T> hyperplanes(NumHashBits, rows.numColumns());
+    std::mt19937 generator(NumHashBits);
+    std::normal_distribution<double> distribution;
+
+    for(size_t hyperplane = 0; hyperplane < NumHashBits; hyperplane++)
+    {
+        auto* values = hyperplanes.row(hyperplane);
+        for(size_t column = 0; column < rows.numColumns(); column++)
+            values[column] = static_cast<T>(distribution(generator));
+    }
+
+    _hashes.resize(_numRows);
+
+    std::vector<size_t> tileRows;
+    for(size_t row = 0; row < _numRows; row += _tileSize)
+        tileRows.push_back(row);
+
+    if(tileRows.empty())
+        return;
+
+    threadPool.parallel_for(tileRows.begin(), tileRows.end(), [&](size_t firstRow)
+    {
+        auto numTileRows = std::min(_tileSize, _numRows - firstRow);
+
+        thread_local std::vector<T> projections;
+        rows.multiplyTile(firstRow, numTileRows, hyperplanes, 0, NumHashBits, projections);
+
+        for(size_t row = 0; row < numTileRows; row++)
+        {
+            auto& hash = _hashes[firstRow + row];
+            hash.fill(0);
+
+            for(size_t bit = 0; bit < NumHashBits; bit++)
+            {
+                if(projections[(row * NumHashBits) + bit] >= T{0})
+                    hash[bit / 64] |= uint64_t{1} << (bit % 64);
+            }
+        }
+    });
+}
+
+template<typename T>
+bool CorrelationPruner<T>::tilesCanBeSkipped(size_t rowA, size_t rowB) const
+{
+    auto tileA = rowA / _tileSize;
+    auto tileB = rowB / _tileSize;
+
+    auto dot = static_cast<double>(dotProduct(_tileDirections.row(tileA),
+        _tileDirections.row(tileB), _tileDirections.numColumns()));
+    auto angle = std::acos(std::clamp(dot, -1.0, 1.0));
+    auto radii = _tileRadii[tileA] + _tileRadii[tileB];
+
+    // The angle between a pair of rows is within the angle between the
+    // directions of their respective tiles, plus or minus the tiles' radii
+    auto maxR = std::cos(std::max(0.0, angle - radii)) + BoundEpsilon;
+    auto minR = std::cos(std::min(std::numbers::pi, angle + radii)) - BoundEpsilon;
+
+    switch(_polarity)
+    {
+    default:
+    case CorrelationPolarity::Positive: return maxR < _threshold;
+    case CorrelationPolarity::Negative: return minR > -_threshold;
+    case CorrelationPolarity::Both:     return maxR < _threshold && minR > -_threshold;
+    }
+}
+
+template class CorrelationPruner<float>;
+template class CorrelationPruner<double>;
@@ -0,0 +1,117 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORRELATIONPRUNER_H
+#define CORRELATIONPRUNER_H
+
+#include "correlationtype.h"
+#include "standardisedrows.h"
+
+class ThreadPool;
+
+#include <vector>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+// Where only correlations beyond a threshold are of interest, most pairs of rows need not
+// be considered at all. The rows are reordered by recursively bisecting them, such that
+// each tile holds rows that are close together, and for each tile the (unit length) mean
+// direction of its rows and the largest angle any of them makes with it is found. The
+// angle between any pair of rows from two tiles is then bounded by the angle between the
+// tiles' mean directions, less (or plus) both of their radii, which in turn bounds the
+// correlations within the pair of tiles, allowing those that can't exceed the threshold to
+// be skipped. In approximate mode, each row also has a sign random projection hash, the
+// Hamming distance between a pair of which estimates the angle between them; pairs whose
+// estimate is well beyond the threshold are skipped too, at the risk of missing a few that
+// are only marginally above it.
+template<typename T>
+class CorrelationPruner
+{
+public:
+    static constexpr size_t NumHashWords = 4;
+    static constexpr size_t NumHashBits = NumHashWords * 64;
+
+private:
+    using Hash = std::array<uint64_t, NumHashWords>;
+
+    CorrelationPruning _pruning = CorrelationPruning::None;
+    double _threshold = 0.0;
+    CorrelationPolarity _polarity = CorrelationPolarity::Positive;
+
+    size_t _tileSize = 0;
+
+    // Rows with no length (or an undefined one) can't correlate with anything, so
+    // they're moved to the end and excluded from consideration entirely
+    size_t _numRows = 0;
+
+    // For each row, the index it originally had
+    std::vector<size_t> _order;
+
+    // For each tile, the mean direction of its rows, and the maximum angle between it and them
+    StandardisedRows<T> _tileDirections;
+    std::vector<double> _tileRadii;
+
+    std::vector<Hash> _hashes;
+    size_t _maxHammingDistance = NumHashBits;
+
+    void bisect(const StandardisedRows<T>& rows, size_t begin, size_t end,
+        std::vector<double>& keys, ThreadPool& threadPool);
+    void computeTileBounds(const StandardisedRows<T>& rows, ThreadPool& threadPool);
+    void computeHashes(const StandardisedRows<T>& rows, ThreadPool& threadPool);
+
+public:
+    // Reorders rows, so the original index of each must subsequently be found using originalIndexOf
+    CorrelationPruner(StandardisedRows<T>& rows, CorrelationPruning pruning,
+        double threshold, CorrelationPolarity polarity, ThreadPool& threadPool);
+
+    size_t numRows() const { return _numRows; }
+    size_t originalIndexOf(size_t row) const { return _order.at(row); }
+
+    bool approximate() const { return _pruning == CorrelationPruning::Approximate; }
+
+    // True if no pair of rows in the tiles beginning at rowA and rowB can exceed the threshold
+    bool tilesCanBeSkipped(size_t rowA, size_t rowB) const;
+
+    // In approximate mode, true if the pair of rows is likely to exceed the threshold
+    bool isCandidate(size_t rowA, size_t rowB) const
+    {
+        const auto& hashA = _hashes[rowA];
+        const auto& hashB = _hashes[rowB];
+
+        size_t hammingDistance = 0;
+        for(size_t i = 0; i < NumHashWords; i++)
+            hammingDistance += static_cast<size_t>(std::popcount(hashA[i] ^ hashB[i]));
+
+        switch(_polarity)
+        {
+        default:
+        case CorrelationPolarity::Positive: return hammingDistance <= _maxHammingDistance;
+        case CorrelationPolarity::Negative: return hammingDistance >= NumHashBits - _maxHammingDistance;
+        case CorrelationPolarity::Both:
+            return hammingDistance <= _maxHammingDistance ||
+                hammingDistance >= NumHashBits - _maxHammingDistance;
+        }
+    }
+};
+
+extern template class CorrelationPruner<float>;
+extern template class CorrelationPruner<double>;
+
+#endif // CORRELATIONPRUNER_H
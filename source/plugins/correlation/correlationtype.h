@@ -45,4 +45,17 @@ DEFINE_QML_ENUM(
     Negative,
     Both);
 
+DEFINE_QML_ENUM(
+    Q_GADGET, CorrelationPruning,
+    None,
+    Exact,
+    Approximate);
+
+DEFINE_QML_ENUM(
+    Q_GADGET, ClusteringLinkage,
+    Single,
+    Average,
+    Complete,
+    Ward);
+
 #endif // CORRELATIONTYPE_H
@@ -0,0 +1,194 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "distancekernels.h"
+
+// The baseline versions of the kernels, which any CPU can run
+#define DISTANCE_KERNELS_ISA Baseline
+#include "distancekernels_impl.h"
+#undef DISTANCE_KERNELS_ISA
+
+#ifdef DISTANCE_KERNELS_X86
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#define DECLARE_DISTANCE_KERNELS(isa) \
+    namespace DistanceKernels::isa \
+    { \
+        double squaredEuclideanDistance(const double* a, const double* b, size_t size); \
+        float squaredEuclideanDistance(const float* a, const float* b, size_t size); \
+        double dotProduct(const double* a, const double* b, size_t size); \
+        float dotProduct(const float* a, const float* b, size_t size); \
+        void binaryMatchCounts(const uint64_t* a, const uint64_t* b, size_t numWords, \
+            size_t& numBoth, size_t& numEither); \
+        void tokenMatchCounts(const uint64_t* a, const uint64_t* b, size_t numWords, size_t numPlanes, \
+            size_t& numMatching, size_t& numEither); \
+    }
+
+DECLARE_DISTANCE_KERNELS(SSE42)
+DECLARE_DISTANCE_KERNELS(AVX2)
+DECLARE_DISTANCE_KERNELS(AVX512)
+
+enum class InstructionSet { Baseline, SSE42, AVX2, AVX512 };
+
+struct CpuidRegisters { uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0; };
+
+static CpuidRegisters cpuid(uint32_t leaf, uint32_t subleaf = 0)
+{
+    CpuidRegisters r;
+
+#if defined(_MSC_VER)
+    int registers[4] = {};
+    __cpuidex(registers, static_cast<int>(leaf), static_cast<int>(subleaf));
+    r.eax = static_cast<uint32_t>(registers[0]);
+    r.ebx = static_cast<uint32_t>(registers[1]);
+    r.ecx = static_cast<uint32_t>(registers[2]);
+    r.edx = static_cast<uint32_t>(registers[3]);
+#else
+    if(leaf > __get_cpuid_max(0, nullptr))
+        return r;
+
+    __cpuid_count(leaf, subleaf, r.eax, r.ebx, r.ecx, r.edx);
+#endif
+
+    return r;
+}
+
+// The register state the OS saves on context switches; if it doesn't save the wider
+// registers, the instructions that use them can't be used, even if the CPU has them
+static uint64_t xgetbv()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax = 0;
+    uint32_t edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32u) | eax;
+#endif
+}
+
+static InstructionSet bestInstructionSet()
+{
+    auto leaf1 = cpuid(1);
+
+    const bool sse42 =      (leaf1.ecx & (1u << 20u)) != 0;
+    const bool popcnt =     (leaf1.ecx & (1u << 23u)) != 0;
+    const bool osxsave =    (leaf1.ecx & (1u << 27u)) != 0;
+    const bool avx =        (leaf1.ecx & (1u << 28u)) != 0;
+
+    if(!sse42 || !popcnt)
+        return InstructionSet::Baseline;
+
+    if(!osxsave || !avx)
+        return InstructionSet::SSE42;
+
+    auto xcr0 = xgetbv();
+    const bool osSavesAvx =    (xcr0 & 0x06u) == 0x06u; // SSE and AVX state
+    const bool osSavesAvx512 = (xcr0 & 0xE6u) == 0xE6u; // ...and opmask and ZMM state
+
+    if(!osSavesAvx)
+        return InstructionSet::SSE42;
+
+    auto leaf7 = cpuid(7);
+    const bool avx2 =       (leaf7.ebx & (1u << 5u)) != 0;
+    const bool avx512f =    (leaf7.ebx & (1u << 16u)) != 0;
+
+    if(avx512f && avx2 && osSavesAvx512)
+        return InstructionSet::AVX512;
+
+    if(avx2)
+        return InstructionSet::AVX2;
+
+    return InstructionSet::SSE42;
+}
+
+#endif // DISTANCE_KERNELS_X86
+
+struct Kernels
+{
+    double (*_squaredEuclideanDistanceDouble)(const double*, const double*, size_t);
+    float (*_squaredEuclideanDistanceFloat)(const float*, const float*, size_t);
+    double (*_dotProductDouble)(const double*, const double*, size_t);
+    float (*_dotProductFloat)(const float*, const float*, size_t);
+    void (*_binaryMatchCounts)(const uint64_t*, const uint64_t*, size_t, size_t&, size_t&);
+    void (*_tokenMatchCounts)(const uint64_t*, const uint64_t*, size_t, size_t, size_t&, size_t&);
+};
+
+#define DISTANCE_KERNELS_FOR(isa) Kernels \
+    { \
+        &DistanceKernels::isa::squaredEuclideanDistance, \
+        &DistanceKernels::isa::squaredEuclideanDistance, \
+        &DistanceKernels::isa::dotProduct, \
+        &DistanceKernels::isa::dotProduct, \
+        &DistanceKernels::isa::binaryMatchCounts, \
+        &DistanceKernels::isa::tokenMatchCounts \
+    }
+
+// Chosen once, when the plugin is loaded
+static const Kernels kernels = []
+{
+#ifdef DISTANCE_KERNELS_X86
+    switch(bestInstructionSet())
+    {
+    case InstructionSet::AVX512:    return DISTANCE_KERNELS_FOR(AVX512);
+    case InstructionSet::AVX2:      return DISTANCE_KERNELS_FOR(AVX2);
+    case InstructionSet::SSE42:     return DISTANCE_KERNELS_FOR(SSE42);
+    default:                        break;
+    }
+#endif
+
+    return DISTANCE_KERNELS_FOR(Baseline);
+}();
+
+double squaredEuclideanDistance(const double* a, const double* b, size_t size)
+{
+    return kernels._squaredEuclideanDistanceDouble(a, b, size);
+}
+
+float squaredEuclideanDistance(const float* a, const float* b, size_t size)
+{
+    return kernels._squaredEuclideanDistanceFloat(a, b, size);
+}
+
+double dotProduct(const double* a, const double* b, size_t size)
+{
+    return kernels._dotProductDouble(a, b, size);
+}
+
+float dotProduct(const float* a, const float* b, size_t size)
+{
+    return kernels._dotProductFloat(a, b, size);
+}
+
+void binaryMatchCounts(const uint64_t* a, const uint64_t* b, size_t numWords,
+    size_t& numBoth, size_t& numEither)
+{
+    kernels._binaryMatchCounts(a, b, numWords, numBoth, numEither);
+}
+
+void tokenMatchCounts(const uint64_t* a, const uint64_t* b, size_t numWords, size_t numPlanes,
+    size_t& numMatching, size_t& numEither)
+{
+    kernels._tokenMatchCounts(a, b, numWords, numPlanes, numMatching, numEither);
+}
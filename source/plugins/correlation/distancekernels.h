@@ -0,0 +1,48 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DISTANCEKERNELS_H
+#define DISTANCEKERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DISTANCE_KERNELS_X86
+#endif
+
+// On x86 these are compiled for several instruction sets, the best of which the
+// CPU supports being selected at runtime; elsewhere the baseline instruction set
+// is used, which in the case of ARM64 includes NEON
+double squaredEuclideanDistance(const double* a, const double* b, size_t size);
+float squaredEuclideanDistance(const float* a, const float* b, size_t size);
+
+double dotProduct(const double* a, const double* b, size_t size);
+float dotProduct(const float* a, const float* b, size_t size);
+
+// Given bitsets of numWords words, counts the bits set in both, and in either
+void binaryMatchCounts(const uint64_t* a, const uint64_t* b, size_t numWords,
+    size_t& numBoth, size_t& numEither);
+
+// Given a bitset of numWords words, followed by numPlanes bitsets of the same size
+// that together encode a token for each bit, counts the bits at which either of the
+// first bitsets are set, and of those, the bits at which the tokens are equal
+void tokenMatchCounts(const uint64_t* a, const uint64_t* b, size_t numWords, size_t numPlanes,
+    size_t& numMatching, size_t& numEither);
+
+#endif // DISTANCEKERNELS_H
@@ -0,0 +1,28 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The AVX2 versions of the kernels; CMakeLists.txt sets the flags that enable the
+// instruction set for this file alone, so nothing here may be called unless the
+// CPU has been found to support it
+
+#include "distancekernels.h"
+
+#ifdef DISTANCE_KERNELS_X86
+#define DISTANCE_KERNELS_ISA AVX2
+#include "distancekernels_impl.h"
+#endif
@@ -0,0 +1,170 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Included once per instruction set by the distancekernels_*.cpp files, each of which
+// is compiled with the flags for its instruction set, and defines DISTANCE_KERNELS_ISA
+// as the name of the namespace in which its versions of the kernels are placed
+
+#ifndef DISTANCE_KERNELS_ISA
+#error DISTANCE_KERNELS_ISA must be defined
+#endif
+
+#include "distancekernels.h"
+
+#include <bit>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace DistanceKernels::DISTANCE_KERNELS_ISA
+{
+
+// Where the instruction is available, it's used directly rather than via std::popcount,
+// as any out of line instance of the latter may be shared with code built for other targets
+static inline size_t popCount(uint64_t value)
+{
+#if defined(__POPCNT__)
+    return static_cast<size_t>(__builtin_popcountll(value));
+#elif defined(_MSC_VER) && defined(__AVX__)
+    return static_cast<size_t>(__popcnt(static_cast<unsigned int>(value)) +
+        __popcnt(static_cast<unsigned int>(value >> 32u)));
+#else
+    return static_cast<size_t>(std::popcount(value));
+#endif
+}
+
+// The differences are accumulated across a cache line's worth of independent
+// sums, which the compiler can map directly onto vector registers, without
+// needing to reorder any floating point operations
+template<typename T>
+static inline T squaredEuclideanDistanceKernel(const T* a, const T* b, size_t size)
+{
+    constexpr size_t NumLanes = 64 / sizeof(T);
+
+    T sums[NumLanes] = {};
+    size_t i = 0;
+
+    for(; i + NumLanes <= size; i += NumLanes)
+    {
+        for(size_t lane = 0; lane < NumLanes; lane++)
+        {
+            auto difference = a[i + lane] - b[i + lane];
+            sums[lane] += difference * difference;
+        }
+    }
+
+    T sum = 0;
+    for(auto laneSum : sums)
+        sum += laneSum;
+
+    for(; i < size; i++)
+    {
+        auto difference = a[i] - b[i];
+        sum += difference * difference;
+    }
+
+    return sum;
+}
+
+template<typename T>
+static inline T dotProductKernel(const T* a, const T* b, size_t size)
+{
+    constexpr size_t NumLanes = 64 / sizeof(T);
+
+    T sums[NumLanes] = {};
+    size_t i = 0;
+
+    for(; i + NumLanes <= size; i += NumLanes)
+    {
+        for(size_t lane = 0; lane < NumLanes; lane++)
+            sums[lane] += a[i + lane] * b[i + lane];
+    }
+
+    T sum = 0;
+    for(auto laneSum : sums)
+        sum += laneSum;
+
+    for(; i < size; i++)
+        sum += a[i] * b[i];
+
+    return sum;
+}
+
+double squaredEuclideanDistance(const double* a, const double* b, size_t size)
+{
+    return squaredEuclideanDistanceKernel(a, b, size);
+}
+
+float squaredEuclideanDistance(const float* a, const float* b, size_t size)
+{
+    return squaredEuclideanDistanceKernel(a, b, size);
+}
+
+double dotProduct(const double* a, const double* b, size_t size)
+{
+    return dotProductKernel(a, b, size);
+}
+
+float dotProduct(const float* a, const float* b, size_t size)
+{
+    return dotProductKernel(a, b, size);
+}
+
+void binaryMatchCounts(const uint64_t* a, const uint64_t* b, size_t numWords,
+    size_t& numBoth, size_t& numEither)
+{
+    size_t both = 0;
+    size_t either = 0;
+
+    for(size_t i = 0; i < numWords; i++)
+    {
+        both += popCount(a[i] & b[i]);
+        either += popCount(a[i] | b[i]);
+    }
+
+    numBoth = both;
+    numEither = either;
+}
+
+void tokenMatchCounts(const uint64_t* a, const uint64_t* b, size_t numWords, size_t numPlanes,
+    size_t& numMatching, size_t& numEither)
+{
+    size_t matching = 0;
+    size_t either = 0;
+
+    for(size_t i = 0; i < numWords; i++)
+    {
+        auto nonZero = a[i] | b[i];
+        auto equal = nonZero;
+
+        for(size_t plane = 1; plane <= numPlanes; plane++)
+        {
+            auto offset = (plane * numWords) + i;
+            equal &= ~(a[offset] ^ b[offset]);
+        }
+
+        matching += popCount(equal);
+        either += popCount(nonZero);
+    }
+
+    numMatching = matching;
+    numEither = either;
+}
+
+} // namespace DistanceKernels::DISTANCE_KERNELS_ISA
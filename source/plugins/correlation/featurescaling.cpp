@@ -20,9 +20,13 @@
 
 #include "shared/loading/iparser.h"
 #include "shared/utils/cancellable.h"
+#include "shared/utils/threadpool.h"
 
 #include <limits>
 #include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <thread>
 #include <cmath>
 
 struct StandardNormalisationValues
@@ -34,7 +38,39 @@ struct StandardNormalisationValues
     std::vector<double>* stddevs = nullptr;
 };
 
-static bool calcStandardValues(const ContinuousDataVectors& dataRows,
+// Calls fn for each row, in parallel; fn is also passed the index of the thread it is
+// running on, so that it may accumulate per column partial results without contention
+template<typename Fn>
+static bool forEachRow(ContinuousDataVectors& dataRows, IParser* parser, Fn&& fn)
+{
+    std::vector<size_t> rowIndices(dataRows.size());
+    std::iota(rowIndices.begin(), rowIndices.end(), 0);
+
+    std::atomic<size_t> numRowsProcessed(0);
+
+    parallel_for(rowIndices.begin(), rowIndices.end(), [&](size_t rowIndex, size_t threadIndex)
+    {
+        if(parser != nullptr && parser->cancelled())
+            return;
+
+        fn(dataRows[rowIndex], threadIndex);
+
+        if(parser != nullptr)
+            parser->setProgress(static_cast<int>((++numRowsProcessed * 100) / dataRows.size()));
+    });
+
+    if(parser != nullptr)
+        parser->setProgress(-1);
+
+    return parser == nullptr || !parser->cancelled();
+}
+
+static size_t numThreads()
+{
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+static bool calcStandardValues(ContinuousDataVectors& dataRows,
     const StandardNormalisationValues& values, IParser* parser = nullptr)
 {
     if(dataRows.empty())
@@ -42,74 +78,97 @@ static bool calcStandardValues(const ContinuousDataVectors& dataRows,
 
     auto numColumns = dataRows.at(0).size();
 
-    if(values.mins != nullptr)
-        values.mins->resize(numColumns, std::numeric_limits<double>::max());
+    struct Partial
+    {
+        std::vector<double> _mins;
+        std::vector<double> _maxs;
+        std::vector<double> _sums;
+    };
+
+    // The minimums, maximums and means are all gathered in a single pass
+    std::vector<Partial> partials(numThreads(), {
+        std::vector<double>(numColumns, std::numeric_limits<double>::max()),
+        std::vector<double>(numColumns, std::numeric_limits<double>::lowest()),
+        std::vector<double>(numColumns, 0.0)});
+
+    auto completed = forEachRow(dataRows, parser, [&](const ContinuousDataVector& dataRow, size_t threadIndex)
+    {
+        auto& partial = partials.at(threadIndex);
+        const auto* row = dataRow.data();
 
-    if(values.maxs != nullptr)
-        values.maxs->resize(numColumns, std::numeric_limits<double>::lowest());
+        for(size_t column = 0; column < numColumns; column++)
+        {
+            auto value = row[column];
 
-    if(values.ranges != nullptr)
-        values.ranges->resize(numColumns);
+            partial._mins[column] = std::min(partial._mins[column], value);
+            partial._maxs[column] = std::max(partial._maxs[column], value);
+            partial._sums[column] += (value / static_cast<double>(numColumns));
+        }
+    });
 
-    if(values.means != nullptr)
-        values.means->resize(numColumns, 0.0);
+    if(!completed)
+        return false;
 
-    if(values.stddevs != nullptr)
-        values.stddevs->resize(numColumns, 0.0);
+    if(values.mins != nullptr)
+        values.mins->assign(numColumns, std::numeric_limits<double>::max());
 
-    uint64_t i = 0;
+    if(values.maxs != nullptr)
+        values.maxs->assign(numColumns, std::numeric_limits<double>::lowest());
 
-    for(const auto& dataRow : dataRows)
-    {
-        if(parser != nullptr && parser->cancelled())
-            return false;
+    if(values.means != nullptr)
+        values.means->assign(numColumns, 0.0);
 
+    for(const auto& partial : partials)
+    {
         for(size_t column = 0; column < numColumns; column++)
         {
-            auto value = dataRow.valueAt(column);
-
             if(values.mins != nullptr)
-                (*values.mins)[column] = std::min((*values.mins)[column], value);
+                (*values.mins)[column] = std::min((*values.mins)[column], partial._mins[column]);
 
             if(values.maxs != nullptr)
-                (*values.maxs)[column] = std::max((*values.maxs)[column], value);
+                (*values.maxs)[column] = std::max((*values.maxs)[column], partial._maxs[column]);
 
             if(values.means != nullptr)
-                (*values.means)[column] += (value / static_cast<double>(numColumns));
+                (*values.means)[column] += partial._sums[column];
         }
-
-        if(parser != nullptr)
-            parser->setProgress(static_cast<int>((i * 100) / dataRows.size()));
-
-        i++;
     }
 
     if(values.ranges != nullptr && values.mins != nullptr && values.maxs != nullptr)
     {
+        values.ranges->resize(numColumns);
+
         for(size_t column = 0; column < numColumns; column++)
             (*values.ranges)[column] = (*values.maxs)[column] - (*values.mins)[column];
     }
 
     if(values.stddevs != nullptr && values.means != nullptr)
     {
-        i = 0;
+        const auto& means = *values.means;
+        std::vector<std::vector<double>> partialDeviations(numThreads(),
+            std::vector<double>(numColumns, 0.0));
 
-        for(const auto& dataRow : dataRows)
+        completed = forEachRow(dataRows, parser, [&](const ContinuousDataVector& dataRow, size_t threadIndex)
         {
-            if(parser != nullptr && parser->cancelled())
-                return false;
+            auto& deviations = partialDeviations.at(threadIndex);
+            const auto* row = dataRow.data();
 
             for(size_t column = 0; column < numColumns; column++)
             {
-                auto deviation = dataRow.valueAt(column) - (*values.means)[column];
+                auto deviation = row[column] - means[column];
                 deviation *= deviation;
-                (*values.stddevs)[column] += (deviation / static_cast<double>(numColumns));
+                deviations[column] += (deviation / static_cast<double>(numColumns));
             }
+        });
 
-            if(parser != nullptr)
-                parser->setProgress(static_cast<int>((i * 100) / dataRows.size()));
+        if(!completed)
+            return false;
 
-            i++;
+        values.stddevs->assign(numColumns, 0.0);
+
+        for(const auto& deviations : partialDeviations)
+        {
+            for(size_t column = 0; column < numColumns; column++)
+                (*values.stddevs)[column] += deviations[column];
         }
 
         // Variance -> Std. Deviations
@@ -127,34 +186,16 @@ static bool normalise(ContinuousDataVectors& dataRows,
 {
     auto numColumns = dataRows.at(0).size();
 
-    uint64_t i = 0;
-
-    for(auto& dataRow : dataRows)
+    return forEachRow(dataRows, parser, [&](ContinuousDataVector& dataRow, size_t)
     {
-        if(parser != nullptr && parser->cancelled())
-            return false;
+        auto* row = dataRow.begin();
 
         for(size_t column = 0; column < numColumns; column++)
         {
-            if(denominators[column] > 0.0)
-            {
-                dataRow.setValueAt(column,
-                    (dataRow.valueAt(column) - subtractors[column]) / denominators[column]);
-            }
-            else
-                dataRow.setValueAt(column, 0.0);
+            row[column] = denominators[column] > 0.0 ?
+                (row[column] - subtractors[column]) / denominators[column] : 0.0;
         }
-
-        if(parser != nullptr)
-            parser->setProgress(static_cast<int>((i * 100) / dataRows.size()));
-
-        i++;
-    }
-
-    if(parser != nullptr)
-        parser->setProgress(-1);
-
-    return true;
+    });
 }
 
 bool MinMaxNormaliser::process(ContinuousDataVectors& dataRows,
@@ -208,53 +249,42 @@ bool StandardisationNormaliser::process(ContinuousDataVectors& dataRows, IParser
 
 bool UnitScalingNormaliser::process(ContinuousDataVectors& dataRows, IParser* parser) const
 {
-    auto numColumns = dataRows.at(0).size();
+    if(dataRows.empty())
+        return true;
 
-    std::vector<double> vectorLengthColumn(numColumns);
+    auto numColumns = dataRows.at(0).size();
 
-    uint64_t i = 0;
+    std::vector<std::vector<double>> partialSumSqs(numThreads(),
+        std::vector<double>(numColumns, 0.0));
 
-    for(auto& dataRow : dataRows)
+    auto completed = forEachRow(dataRows, parser, [&](const ContinuousDataVector& dataRow, size_t threadIndex)
     {
-        if(parser != nullptr && parser->cancelled())
-            return false;
+        auto& sumSqs = partialSumSqs.at(threadIndex);
+        const auto* row = dataRow.data();
 
         for(size_t column = 0; column < numColumns; column++)
-        {
-            auto value = dataRow.valueAt(column);
-            vectorLengthColumn[column] += (value * value);
-        }
+            sumSqs[column] += (row[column] * row[column]);
+    });
 
-        if(parser != nullptr)
-            parser->setProgress(static_cast<int>((i * 100) / dataRows.size()));
+    if(!completed)
+        return false;
 
-        i++;
-    }
+    std::vector<double> vectorLengthColumn(numColumns, 0.0);
 
-    if(parser != nullptr)
-        parser->setProgress(-1);
+    for(const auto& sumSqs : partialSumSqs)
+    {
+        for(size_t column = 0; column < numColumns; column++)
+            vectorLengthColumn[column] += sumSqs[column];
+    }
 
     for(size_t column = 0; column < numColumns; column++)
         vectorLengthColumn[column] = std::sqrt(vectorLengthColumn[column]);
 
-    i = 0;
-
-    for(auto& dataRow : dataRows)
+    return forEachRow(dataRows, parser, [&](ContinuousDataVector& dataRow, size_t)
     {
-        if(parser != nullptr && parser->cancelled())
-            return false;
+        auto* row = dataRow.begin();
 
         for(size_t column = 0; column < numColumns; column++)
-        {
-            auto scaledValue = dataRow.valueAt(column) / vectorLengthColumn[column];
-            dataRow.setValueAt(column, scaledValue);
-        }
-
-        if(parser != nullptr)
-            parser->setProgress(static_cast<int>((i * 100) / dataRows.size()));
-
-        i++;
-    }
-
-    return true;
+            row[column] /= vectorLengthColumn[column];
+    });
 }
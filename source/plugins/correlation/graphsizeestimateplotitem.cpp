@@ -76,9 +76,58 @@ void GraphSizeEstimatePlotItem::setGraphSizeEstimate(const QVariantMap& graphSiz
     _numEdges = graphSizeEstimate.value(QStringLiteral("numEdges")).value<QVector<double>>();
     _numUniqueEdges = graphSizeEstimate.value(QStringLiteral("numUniqueEdges")).value<QVector<double>>();
 
+    auto valuesFor = [&graphSizeEstimate](const QString& key)
+    {
+        return graphSizeEstimate.value(key).value<QVector<double>>();
+    };
+
+    _numNodesLower = valuesFor(QStringLiteral("numNodesLower"));
+    _numNodesUpper = valuesFor(QStringLiteral("numNodesUpper"));
+    _numEdgesLower = valuesFor(QStringLiteral("numEdgesLower"));
+    _numEdgesUpper = valuesFor(QStringLiteral("numEdgesUpper"));
+    _numUniqueEdgesLower = valuesFor(QStringLiteral("numUniqueEdgesLower"));
+    _numUniqueEdgesUpper = valuesFor(QStringLiteral("numUniqueEdgesUpper"));
+
     buildPlot();
 }
 
+void GraphSizeEstimatePlotItem::addConfidenceBand(const QVector<double>& lower,
+    const QVector<double>& upper, const QColor& color)
+{
+    if(lower.size() != _keys.size() || upper.size() != _keys.size())
+        return;
+
+    auto* lowerGraph = customPlot().addGraph();
+    auto* upperGraph = customPlot().addGraph();
+
+    // The log axis can't represent 0, so keep the band just above it
+    const double minimumValue = 0.5;
+    auto clamped = [&](const QVector<double>& values)
+    {
+        QVector<double> clampedValues;
+        clampedValues.reserve(values.size());
+
+        for(auto value : values)
+            clampedValues.append(std::max(value, minimumValue));
+
+        return clampedValues;
+    };
+
+    lowerGraph->setData(_keys, clamped(lower), true);
+    upperGraph->setData(_keys, clamped(upper), true);
+
+    lowerGraph->setPen(Qt::NoPen);
+    upperGraph->setPen(Qt::NoPen);
+
+    auto fillColor = color;
+    fillColor.setAlpha(40);
+    upperGraph->setBrush(QBrush(fillColor));
+    upperGraph->setChannelFillGraph(lowerGraph);
+
+    lowerGraph->removeFromLegend();
+    upperGraph->removeFromLegend();
+}
+
 void GraphSizeEstimatePlotItem::updateThresholdIndicator()
 {
     if(_thresholdIndicator == nullptr || _keys.isEmpty())
@@ -125,6 +174,13 @@ void GraphSizeEstimatePlotItem::buildPlot()
     customPlot().clearItems();
     customPlot().clearPlottables();
 
+    addConfidenceBand(_numNodesLower, _numNodesUpper, Qt::red);
+
+    if(_uniqueEdgesOnly)
+        addConfidenceBand(_numUniqueEdgesLower, _numUniqueEdgesUpper, Qt::blue);
+    else
+        addConfidenceBand(_numEdgesLower, _numEdgesUpper, Qt::blue);
+
     auto* nodesGraph = customPlot().addGraph();
     auto* edgesGraph = customPlot().addGraph();
 
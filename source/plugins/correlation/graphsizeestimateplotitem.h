@@ -21,6 +21,7 @@
 
 #include <qcustomplotquickitem.h>
 
+#include <QColor>
 #include <QObject>
 #include <QQuickPaintedItem>
 #include <QVector>
@@ -43,6 +44,14 @@ private:
     QVector<double> _numEdges;
     QVector<double> _numUniqueEdges;
 
+    // Confidence bands, when the estimate is based on a sample
+    QVector<double> _numNodesLower;
+    QVector<double> _numNodesUpper;
+    QVector<double> _numEdgesLower;
+    QVector<double> _numEdgesUpper;
+    QVector<double> _numUniqueEdgesLower;
+    QVector<double> _numUniqueEdgesUpper;
+
     double _threshold = 0.0;
     bool _uniqueEdgesOnly = false;
     bool _dragging = false;
@@ -53,6 +62,7 @@ private:
     QVariantMap graphSizeEstimate() const { return {}; } // Silence AutoMoc warning
     void setGraphSizeEstimate(const QVariantMap& graphSizeEstimate);
 
+    void addConfidenceBand(const QVector<double>& lower, const QVector<double>& upper, const QColor& color);
     void updateThresholdIndicator();
     void buildPlot();
 
@@ -20,10 +20,17 @@
 
 #include "correlationplugin.h"
 #include "correlationdatavector.h"
-#include "correlation.h"
+#include "distancekernels.h"
+
+#include "shared/utils/threadpool.h"
 
 #include <vector>
 #include <limits>
+#include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <cmath>
+#include <utility>
 
 #include <QObject>
 
@@ -65,75 +72,118 @@ struct Link
     size_t _pi;
 };
 
-struct EuclideanDistanceAlgorithm
+// Pairwise distances between n items, stored as the upper triangle only
+class DistanceMatrix
 {
-    double evaluate(size_t size, const ContinuousDataVector* vectorA, const ContinuousDataVector* vectorB)
-    {
-        double sum = 0.0;
+private:
+    size_t _size = 0;
+    std::vector<double> _distances;
 
-        for(size_t i = 0; i < size; i++)
-        {
-            auto diff = vectorA->valueAt(i) - vectorB->valueAt(i);
-            auto diffSq = diff * diff;
-            sum += diffSq;
-        }
+    size_t offsetOf(size_t i, size_t j) const
+    {
+        if(i > j)
+            std::swap(i, j);
 
-        return sum != 0.0 ? std::sqrt(sum) : 0.0;
+        Q_ASSERT(i != j && j < _size);
+        return (i * _size) - ((i * (i + 1)) / 2) + (j - i - 1);
     }
-};
 
-class EuclideanDistanceCorrelation : public CovarianceCorrelation<EuclideanDistanceAlgorithm>
-{
 public:
-    QString name() const override { return {}; }
-    QString description() const override { return {}; }
-    QString attributeName() const override { return {}; }
-    QString attributeDescription() const override { return {}; }
+    explicit DistanceMatrix(size_t size) :
+        _size(size), _distances((size * (size - 1)) / 2)
+    {}
+
+    size_t size() const { return _size; }
+
+    double valueAt(size_t i, size_t j) const { return _distances[offsetOf(i, j)]; }
+    void setValueAt(size_t i, size_t j, double value) { _distances[offsetOf(i, j)] = value; }
 };
 
-HierarchicalClusteringCommand::HierarchicalClusteringCommand(const std::vector<double>& data,
-    size_t numColumns, size_t numRows, CorrelationPluginInstance& correlationPluginInstance) :
-    _data(&data), _numColumns(numColumns), _numRows(numRows),
-    _correlationPluginInstance(&correlationPluginInstance)
-{}
+// Roughly the size of a per core L2 cache
+static constexpr size_t TargetTileBytes = 512 * 1024;
 
-bool HierarchicalClusteringCommand::execute()
+// Computes the (squared, for Ward) Euclidean distances between the rows of vectors, tile
+// by tile in parallel, where a tile is a pair of row ranges that together fit in cache
+static bool computeDistances(const ContinuousDataMatrix& vectors, bool squared,
+    DistanceMatrix& distances, Cancellable& cancellable, Progressable& progressable)
 {
-    ContinuousDataVectors dataColumns;
+    auto size = vectors.numRows();
+    auto rowBytes = std::max(vectors.stride(), size_t{1}) * sizeof(double);
+    auto tileSize = std::clamp(TargetTileBytes / (2 * rowBytes), size_t{8}, size_t{256});
 
-    for(size_t column = 0; column < _numColumns; column++)
-        dataColumns.emplace_back(*_data, column, _numColumns, _numRows);
+    struct Tile
+    {
+        size_t _rowA = 0;
+        size_t _rowB = 0;
+    };
 
-    for(auto& dataColumn : dataColumns)
-        dataColumn.update();
+    std::vector<Tile> tiles;
+    for(size_t rowA = 0; rowA < size; rowA += tileSize)
+    {
+        for(size_t rowB = rowA; rowB < size; rowB += tileSize)
+            tiles.push_back({rowA, rowB});
+    }
 
-    EuclideanDistanceCorrelation correlation;
+    std::atomic<size_t> numTilesProcessed(0);
 
-    setPhase(QObject::tr("Correlating"));
-    auto matrix = correlation.matrix(dataColumns, this, this);
+    parallel_for(tiles.begin(), tiles.end(), [&](const Tile& tile)
+    {
+        if(cancellable.cancelled())
+            return;
 
-    if(cancelled())
-        return false;
+        auto lastRowA = std::min(tile._rowA + tileSize, size);
+        auto lastRowB = std::min(tile._rowB + tileSize, size);
 
-    setPhase(QObject::tr("Clustering"));
+        for(auto rowA = tile._rowA; rowA < lastRowA; rowA++)
+        {
+            // On the diagonal, avoid self distances and duplicates
+            auto firstRowB = tile._rowA == tile._rowB ? rowA + 1 : tile._rowB;
+
+            for(auto rowB = firstRowB; rowB < lastRowB; rowB++)
+            {
+                auto distance = squaredEuclideanDistance(vectors.row(rowA),
+                    vectors.row(rowB), vectors.numColumns());
+
+                distances.setValueAt(rowA, rowB, squared ? distance : std::sqrt(distance));
+            }
+        }
 
-    std::vector<double> ls(dataColumns.size());
-    std::vector<size_t> ps(dataColumns.size());
-    std::vector<double> ms(dataColumns.size());
+        progressable.setProgress(static_cast<int>((++numTilesProcessed * 100) / tiles.size()));
+    });
+
+    progressable.setProgress(-1);
+
+    return !cancellable.cancelled();
+}
+
+struct Merge
+{
+    size_t _a;
+    size_t _b;
+    double _distance;
+};
+
+// SLINK; R. Sibson, "SLINK: An optimally efficient algorithm for the single-link
+// cluster method", The Computer Journal, 1973
+static std::vector<Merge> singleLinkage(const DistanceMatrix& distances,
+    Cancellable& cancellable, Progressable& progressable)
+{
+    auto size = distances.size();
+
+    std::vector<double> ls(size);
+    std::vector<size_t> ps(size);
+    std::vector<double> ms(size);
 
     ps[0] = 0;
     ls[0] = std::numeric_limits<double>::infinity();
 
-    uint64_t progress = 0;
-    uint64_t total = (dataColumns.size() * (dataColumns.size() - 1)) / 2;
-
-    for(size_t i = 1; i < dataColumns.size(); i++)
+    for(size_t i = 1; i < size; i++)
     {
         ps[i] = i;
         ls[i] = std::numeric_limits<double>::infinity();
 
         for(size_t j = 0; j < i; j++)
-            ms[j] = matrix.valueAt(i, j);
+            ms[j] = distances.valueAt(i, j);
 
         for(size_t j = 0; j < i; j++)
         {
@@ -155,49 +205,204 @@ bool HierarchicalClusteringCommand::execute()
 
             if(ls[j] >= ls[pi])
                 ps[j] = i;
+        }
+
+        if(cancellable.cancelled())
+            return {};
+
+        progressable.setProgress(static_cast<int>((i * i * 100) / (size * size)));
+    }
+
+    // In the pointer representation, every item bar the last joins ps[i] at height ls[i]
+    std::vector<Merge> merges;
+    merges.reserve(size - 1);
+
+    for(size_t i = 0; i < size - 1; i++)
+        merges.push_back({i, ps[i], ls[i]});
+
+    return merges;
+}
+
+// The Lance-Williams update of the distance between x and the union of a and b
+static double lanceWilliams(ClusteringLinkage linkage, double ax, double bx, double ab,
+    size_t sizeA, size_t sizeB, size_t sizeX)
+{
+    auto na = static_cast<double>(sizeA);
+    auto nb = static_cast<double>(sizeB);
+    auto nx = static_cast<double>(sizeX);
 
-            setProgress(static_cast<int>((progress++ * 100) / total));
+    switch(linkage)
+    {
+    case ClusteringLinkage::Complete:
+        return std::max(ax, bx);
+
+    case ClusteringLinkage::Average:
+        return ((na * ax) + (nb * bx)) / (na + nb);
+
+    case ClusteringLinkage::Ward:
+        return (((na + nx) * ax) + ((nb + nx) * bx) - (nx * ab)) / (na + nb + nx);
+
+    default:
+    case ClusteringLinkage::Single:
+        return std::min(ax, bx);
+    }
+}
+
+// The nearest-neighbour chain algorithm, which applies to any reducible linkage; see
+// D. Müllner, "Modern hierarchical, agglomerative clustering algorithms", 2011
+static std::vector<Merge> nnChainLinkage(DistanceMatrix& distances, ClusteringLinkage linkage,
+    Cancellable& cancellable, Progressable& progressable)
+{
+    auto size = distances.size();
+
+    std::vector<bool> active(size, true);
+    std::vector<size_t> sizes(size, 1);
+    std::vector<size_t> chain;
+    chain.reserve(size);
+
+    std::vector<Merge> merges;
+    merges.reserve(size - 1);
+
+    size_t firstActive = 0;
+
+    while(merges.size() < size - 1)
+    {
+        if(chain.empty())
+        {
+            while(!active[firstActive])
+                firstActive++;
+
+            chain.push_back(firstActive);
         }
 
-        if(cancelled())
-            return false;
+        size_t a = 0;
+        size_t b = 0;
+        double distance = 0.0;
+
+        while(true)
+        {
+            a = chain.back();
+
+            // Prefer the previous item in the chain when there is a tie, else it may never end
+            b = chain.size() >= 2 ? chain[chain.size() - 2] : size;
+            distance = b < size ? distances.valueAt(a, b) : std::numeric_limits<double>::infinity();
+
+            for(size_t x = 0; x < size; x++)
+            {
+                if(!active[x] || x == a)
+                    continue;
+
+                auto d = distances.valueAt(a, x);
+                if(d < distance)
+                {
+                    distance = d;
+                    b = x;
+                }
+            }
+
+            if(chain.size() >= 2 && b == chain[chain.size() - 2])
+                break;
+
+            chain.push_back(b);
+        }
+
+        // a and b are reciprocal nearest neighbours, so merge a into b
+        chain.resize(chain.size() - 2);
+        merges.push_back({a, b, distance});
+
+        for(size_t x = 0; x < size; x++)
+        {
+            if(!active[x] || x == a || x == b)
+                continue;
+
+            distances.setValueAt(b, x, lanceWilliams(linkage,
+                distances.valueAt(a, x), distances.valueAt(b, x), distance,
+                sizes[a], sizes[b], sizes[x]));
+        }
+
+        active[a] = false;
+        sizes[b] += sizes[a];
+
+        if(cancellable.cancelled())
+            return {};
+
+        progressable.setProgress(static_cast<int>((merges.size() * 100) / (size - 1)));
     }
 
-    setProgress(-1);
+    return merges;
+}
+
+HierarchicalClusteringCommand::HierarchicalClusteringCommand(const ContinuousDataMatrix& data,
+    ClusteringLinkage linkage, CorrelationPluginInstance& correlationPluginInstance) :
+    _data(&data), _linkage(linkage), _correlationPluginInstance(&correlationPluginInstance)
+{}
+
+bool HierarchicalClusteringCommand::execute()
+{
+    auto numColumns = _data->numColumns();
+
+    if(numColumns < 2)
+    {
+        _correlationPluginInstance->setHcOrdering(std::vector<size_t>(numColumns, 0));
+        return true;
+    }
+
+    // Transpose, so that each column's values are contiguous
+    ContinuousDataMatrix dataColumns(numColumns, _data->numRows());
+    for(size_t row = 0; row < _data->numRows(); row++)
+    {
+        const auto* values = _data->row(row);
 
-    std::vector<size_t> sortedIndices(dataColumns.size());
-    std::iota(sortedIndices.begin(), sortedIndices.end(), 0);
+        for(size_t column = 0; column < numColumns; column++)
+            dataColumns.setValueAt(column, row, values[column]);
+    }
+
+    DistanceMatrix distances(numColumns);
+
+    setPhase(QObject::tr("Correlating"));
+    if(!computeDistances(dataColumns, _linkage == ClusteringLinkage::Ward, distances, *this, *this))
+        return false;
+
+    setPhase(QObject::tr("Clustering"));
+
+    auto merges = _linkage == ClusteringLinkage::Single ?
+        singleLinkage(distances, *this, *this) :
+        nnChainLinkage(distances, _linkage, *this, *this);
+
+    if(cancelled())
+        return false;
+
+    setProgress(-1);
 
-    std::sort(sortedIndices.begin(), sortedIndices.end(),
-        [&ls](auto a, auto b) { return ls.at(a) < ls.at(b); });
+    std::stable_sort(merges.begin(), merges.end(),
+        [](const auto& a, const auto& b) { return a._distance < b._distance; });
 
     std::vector<Link> links;
-    links.reserve(dataColumns.size());
+    links.reserve(numColumns);
 
-    Unions unions(dataColumns.size() * 2);
+    Unions unions(numColumns * 2);
 
     // Generate linkage
-    for(size_t i = 0; i < dataColumns.size() - 1; i++)
+    for(size_t i = 0; i < merges.size(); i++)
     {
-        auto index = sortedIndices.at(i);
-        auto pi = ps.at(index);
+        const auto& merge = merges.at(i);
 
-        auto rIndex = unions.find(index);
-        auto rPi = unions.find(pi);
+        auto rIndex = unions.find(merge._a);
+        auto rPi = unions.find(merge._b);
 
         links.push_back({rIndex, rPi});
 
-        unions.join(index, dataColumns.size() + i);
-        unions.join(pi, dataColumns.size() + i);
+        unions.join(merge._a, numColumns + i);
+        unions.join(merge._b, numColumns + i);
     }
 
     // Find leaves
     size_t orderingIndex = 0;
     size_t i = 0;
-    std::vector<size_t> current(dataColumns.size());
-    current[0] = (dataColumns.size() * 2) - 2;
-    std::vector<bool> visited(dataColumns.size() * 2);
-    std::vector<size_t> ordering(dataColumns.size());
+    std::vector<size_t> current(numColumns);
+    current[0] = (numColumns * 2) - 2;
+    std::vector<bool> visited(numColumns * 2);
+    std::vector<size_t> ordering(numColumns);
 
     auto add = [&](size_t index)
     {
@@ -205,7 +410,7 @@ bool HierarchicalClusteringCommand::execute()
             return false;
 
         visited[index] = true;
-        if(index >= dataColumns.size())
+        if(index >= numColumns)
         {
             current[++i] = index;
             return true;
@@ -217,7 +422,7 @@ bool HierarchicalClusteringCommand::execute()
 
     while(true)
     {
-        const auto& link = links.at(current[i] - dataColumns.size());
+        const auto& link = links.at(current[i] - numColumns);
 
         if(add(link._index) || add(link._pi))
             continue;
@@ -21,20 +21,21 @@
 
 #include "shared/commands/icommand.h"
 
+#include "correlationtype.h"
+
 class CorrelationPluginInstance;
+class ContinuousDataMatrix;
 
 class HierarchicalClusteringCommand : public ICommand
 {
 private:
-    const std::vector<double>* _data = nullptr;
-    size_t _numColumns = 0;
-    size_t _numRows = 0;
+    const ContinuousDataMatrix* _data = nullptr;
+    ClusteringLinkage _linkage = ClusteringLinkage::Single;
 
     CorrelationPluginInstance* _correlationPluginInstance = nullptr;
 
 public:
-    HierarchicalClusteringCommand(const std::vector<double>& data,
-        size_t numColumns, size_t numRows,
+    HierarchicalClusteringCommand(const ContinuousDataMatrix& data, ClusteringLinkage linkage,
         CorrelationPluginInstance& correlationPluginInstance);
 
     QString description() const override { return QObject::tr("Sorting Columns"); }
@@ -34,14 +34,19 @@
 #include "shared/utils/container_randomsample.h"
 #include "shared/utils/string.h"
 #include "shared/utils/scope_exit.h"
+#include "shared/utils/threadpool.h"
 
 #include <QRect>
 
 #include <vector>
+#include <algorithm>
+#include <type_traits>
 #include <stack>
 #include <set>
 #include <utility>
 #include <limits>
+#include <numeric>
+#include <thread>
 
 CorrelationFileParser::CorrelationFileParser(CorrelationPluginInstance* plugin, const QString& urlTypeName,
                                              TabularData& tabularData, QRect dataRect) :
@@ -371,6 +376,92 @@ void CorrelationFileParser::clipValues(ClippingType clippingType, double clippin
     }
 }
 
+double CorrelationFileParser::clipAndScale(ClippingType clippingType, double clippingValue,
+    ScalingType scalingType, ContinuousDataMatrix& data)
+{
+    if(data.empty())
+        return std::nextafter(0.0, 1.0);
+
+    bool clip = false;
+    double clipValue = 0.0;
+
+    switch(clippingType)
+    {
+    case ClippingType::Constant:
+        clip = true;
+        clipValue = clippingValue;
+        break;
+
+    case ClippingType::Winsorization:
+    {
+        // Setting every value that sorts after the percentile to the value at the
+        // percentile is the same as clipping to it, which only needs a selection
+        auto values = data.values();
+        auto metaIndex = static_cast<size_t>((clippingValue * static_cast<double>(values.size() - 1)) / 100.0);
+        auto nth = values.begin() + static_cast<std::vector<double>::difference_type>(metaIndex);
+        std::nth_element(values.begin(), nth, values.end());
+
+        clip = true;
+        clipValue = *nth;
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    std::vector<size_t> rows(data.numRows());
+    std::iota(rows.begin(), rows.end(), 0);
+
+    auto numColumns = data.numColumns();
+
+    // Clip, and find the smallest positive value (for the epsilon) in the same pass
+    std::vector<double> minValues(std::max(std::thread::hardware_concurrency(), 1u),
+        std::numeric_limits<double>::max());
+
+    parallel_for(rows.begin(), rows.end(), [&](size_t row, size_t threadIndex)
+    {
+        auto* values = data.row(row);
+        auto& minValue = minValues.at(threadIndex);
+
+        for(size_t column = 0; column < numColumns; column++)
+        {
+            if(clip)
+                values[column] = std::min(values[column], clipValue);
+
+            if(values[column] > 0.0 && values[column] < minValue)
+                minValue = values[column];
+        }
+    });
+
+    // See epsilonFor
+    auto epsilon = *std::min_element(minValues.begin(), minValues.end()) * 0.5;
+
+    auto scaleRows = [&](auto&& scale)
+    {
+        parallel_for(rows.begin(), rows.end(), [&](size_t row)
+        {
+            auto* values = data.row(row);
+
+            for(size_t column = 0; column < numColumns; column++)
+                values[column] = scale(values[column]);
+        });
+    };
+
+    // The scaling type is resolved here, rather than for every value
+    switch(scalingType)
+    {
+    case ScalingType::Log2:         scaleRows([epsilon](double value) { return std::log2(value + epsilon); }); break;
+    case ScalingType::Log10:        scaleRows([epsilon](double value) { return std::log10(value + epsilon); }); break;
+    case ScalingType::AntiLog2:     scaleRows([](double value) { return std::pow(2.0, value); }); break;
+    case ScalingType::AntiLog10:    scaleRows([](double value) { return std::pow(10.0, value); }); break;
+    case ScalingType::ArcSin:       scaleRows([](double value) { return std::asin(value); }); break;
+    default: break;
+    }
+
+    return epsilon;
+}
+
 double CorrelationFileParser::scaleValue(ScalingType scalingType, double value, double epsilon)
 {
     switch(scalingType)
@@ -431,10 +522,7 @@ void CorrelationFileParser::normalise(NormaliseType normaliseType,
     }
 
     if(normaliseType != NormaliseType::None)
-    {
-        for(auto& dataRow : dataRows)
-            dataRow.update();
-    }
+        updateDataRows(dataRows);
 }
 
 double CorrelationFileParser::epsilonFor(const std::vector<double>& data)
@@ -454,6 +542,31 @@ double CorrelationFileParser::epsilonFor(const std::vector<double>& data)
     return minValue * 0.5;
 }
 
+double CorrelationFileParser::epsilonFor(const ContinuousDataMatrix& data)
+{
+    if(data.empty())
+        return std::nextafter(0.0, 1.0);
+
+    double minValue = std::numeric_limits<double>::max();
+    data.forEachValue([&minValue](double value)
+    {
+        if(value > 0.0 && value < minValue)
+            minValue = value;
+    });
+
+    return minValue * 0.5;
+}
+
+void CorrelationFileParser::updateDataRows(ContinuousDataVectors& dataRows)
+{
+    // Iterate over indices, as the rows' cost hints are for correlation, not this
+    std::vector<size_t> rowIndices(dataRows.size());
+    std::iota(rowIndices.begin(), rowIndices.end(), 0);
+
+    parallel_for(rowIndices.begin(), rowIndices.end(),
+        [&dataRows](size_t rowIndex) { dataRows[rowIndex].update(); });
+}
+
 bool CorrelationFileParser::parse(const QUrl&, IGraphModel* graphModel)
 {
     if(_tabularData.empty() || cancelled())
@@ -511,7 +624,7 @@ bool CorrelationFileParser::parse(const QUrl&, IGraphModel* graphModel)
     _plugin->createAttributes();
 
     graphModel->mutableGraph().setPhase(QObject::tr("Building Graph"));
-    if(!_plugin->createEdges(edges, *this))
+    if(!_plugin->createEdges(std::move(edges), *this))
         return false;
 
     graphModel->mutableGraph().clearPhase();
@@ -597,31 +710,31 @@ CorrelationTabularDataParser::CorrelationTabularDataParser()
             estimateGraphSize();
     });
 
-    connect(&_dataParserWatcher, &QFutureWatcher<void>::started, this, &CorrelationTabularDataParser::busyChanged);
-    connect(&_dataParserWatcher, &QFutureWatcher<void>::finished, this, &CorrelationTabularDataParser::busyChanged);
+    connect(this, &CorrelationTabularDataParser::previewParsed, this, &CorrelationTabularDataParser::onPreviewParsed);
     connect(&_dataParserWatcher, &QFutureWatcher<void>::finished, this, &CorrelationTabularDataParser::onDataLoaded);
 
     connect(this, &CorrelationTabularDataParser::dataRectChanged, this, [this] { estimateGraphSize(); });
     connect(this, &CorrelationTabularDataParser::parameterChanged, this, [this] { estimateGraphSize(); });
 
-    connect(&_graphSizeEstimateFutureWatcher, &QFutureWatcher<QVariantMap>::started,
+    connect(&_graphSizeEstimateFutureWatcher, &QFutureWatcher<void>::started,
         this, &CorrelationTabularDataParser::graphSizeEstimateInProgressChanged);
-    connect(&_graphSizeEstimateFutureWatcher, &QFutureWatcher<QVariantMap>::finished,
+    connect(&_graphSizeEstimateFutureWatcher, &QFutureWatcher<void>::finished,
         this, &CorrelationTabularDataParser::graphSizeEstimateInProgressChanged);
 
-    connect(&_graphSizeEstimateFutureWatcher, &QFutureWatcher<QVariantMap>::finished, [this]
+    connect(&_graphSizeEstimateFutureWatcher, &QFutureWatcher<void>::finished, [this]
     {
-        _graphSizeEstimate = _graphSizeEstimateFutureWatcher.result();
-        emit graphSizeEstimateChanged();
-
         // Another estimate was queued while we were busy
         if(_graphSizeEstimateQueued)
             estimateGraphSize();
     });
 }
 
-CorrelationTabularDataParser::~CorrelationTabularDataParser() // NOLINT modernize-use-equals-default
+CorrelationTabularDataParser::~CorrelationTabularDataParser()
 {
+    // The remainder of the file may still be being parsed
+    cancelParse();
+
+    _graphSizeEstimateCancellable.cancel();
     _graphSizeEstimateFutureWatcher.waitForFinished();
     _dataRectangleFutureWatcher.waitForFinished();
     _dataParserWatcher.waitForFinished();
@@ -634,27 +747,49 @@ bool CorrelationTabularDataParser::parse(const QUrl& fileUrl, const QString& fil
         if(fileUrl.isEmpty() || fileType.isEmpty())
             return;
 
-        auto parseUsing = [fileUrl, this](auto&& parser)
+        auto parseUsing = [fileUrl, this](auto&& previewParser)
         {
-            _cancellableParser = &parser;
+            using Parser = std::remove_reference_t<decltype(previewParser)>;
+            Parser parser;
+
+            _cancellableParser = &previewParser;
             auto atExit = std::experimental::make_scope_exit([this] { _cancellableParser = nullptr; });
 
             // This should already have been tested for, but check anyway
-            if(!parser.canLoad(fileUrl))
+            if(!previewParser.canLoad(fileUrl))
                 return;
 
-            parser.setProgressFn([this](int progress) { setProgress(progress); });
+            // Parse the start of the file first, so that it can be shown immediately...
+            previewParser.setRowLimit(PreviewRowLimit);
+            if(!previewParser.parse(fileUrl))
+                return;
 
-            if(!parser.parse(fileUrl))
+            _previewDataPtr = std::make_shared<TabularData>(std::move(previewParser.tabularData()));
+            _dataHasNumericalRect = !findLargestNumericalDataRect(*_previewDataPtr).isEmpty();
+            emit dataHasNumericalRectChanged();
+
+            // The row limit wasn't reached, so the preview is the whole file
+            if(_previewDataPtr->numRows() <= PreviewRowLimit)
+            {
+                _parsedDataPtr = _previewDataPtr;
                 return;
+            }
 
-            _dataPtr = std::make_shared<TabularData>(std::move(parser.tabularData()));
+            emit previewParsed();
 
-            // findLargestNumericalDataRect can take a while for big datasets
-            setProgress(-1);
+            // ...then parse it again in its entirety, in the background
+            _cancellableParser = &parser;
 
-            _dataHasNumericalRect = !findLargestNumericalDataRect(*_dataPtr).isEmpty();
-            emit dataHasNumericalRectChanged();
+            // Check for a cancellation that arrived between the two parsers
+            if(cancelled())
+                return;
+
+            parser.setProgressFn([this](int progress) { setProgress(progress); });
+
+            if(!parser.parse(fileUrl))
+                return;
+
+            _parsedDataPtr = std::make_shared<TabularData>(std::move(parser.tabularData()));
         };
 
         if(fileType == QStringLiteral("CorrelationCSV"))
@@ -675,10 +810,12 @@ bool CorrelationTabularDataParser::parse(const QUrl& fileUrl, const QString& fil
 
 void CorrelationTabularDataParser::cancelParse()
 {
+    // Cancel ourselves first, so that a parser that starts after
+    // _cancellableParser is read here will see the cancellation
+    cancel();
+
     if(_cancellableParser != nullptr)
         _cancellableParser.load()->cancel();
-
-    cancel();
 }
 
 void CorrelationTabularDataParser::waitForDataRectangleFuture()
@@ -691,6 +828,31 @@ void CorrelationTabularDataParser::waitForDataRectangleFuture()
     }
 }
 
+void CorrelationTabularDataParser::detectDataRectangle()
+{
+    auto numericalDataRect = findLargestNumericalDataRect(*_dataPtr);
+
+    if(numericalDataRect.isEmpty())
+    {
+        // A numerical rectangle can't be found and there isn't an existing
+        // selected rectangle, so search for a non-numerical rectangle instead
+        if(_dataRect.isEmpty())
+            _dataRect = findLargestNonNumericalDataRect(*_dataPtr);
+
+        _hasDiscreteValues = true;
+        _appearsToBeContinuous = false;
+    }
+    else
+    {
+        _dataRect = numericalDataRect;
+        _hasDiscreteValues = false;
+        _appearsToBeContinuous = dataRectAppearsToBeContinuous(*_dataPtr, _dataRect);
+        _numericalMinMax = dataRectMinMax(*_dataPtr, _dataRect);
+    }
+
+    _hasMissingValues = dataRectHasMissingValues(*_dataPtr, _dataRect);
+}
+
 void CorrelationTabularDataParser::autoDetectDataRectangle()
 {
     Q_ASSERT(_dataPtr != nullptr);
@@ -699,29 +861,84 @@ void CorrelationTabularDataParser::autoDetectDataRectangle()
 
     waitForDataRectangleFuture();
 
-    QFuture<void> future = QtConcurrent::run([this]()
+    QFuture<void> future = QtConcurrent::run([this]() { detectDataRectangle(); });
+    _dataRectangleFutureWatcher.setFuture(future);
+}
+
+// The preview is a prefix of the full data, and any data rectangle always extends to the
+// bottom rightmost cell, so a rectangle chosen on the preview can be carried over to the
+// full data by extending it, and then only examining the cells that weren't in the preview
+void CorrelationTabularDataParser::revalidateDataRectangle(size_t previewNumColumns, size_t previewNumRows)
+{
+    Q_ASSERT(_dataPtr != nullptr);
+    if(_dataPtr == nullptr)
+        return;
+
+    waitForDataRectangleFuture();
+
+    QFuture<void> future = QtConcurrent::run([this, previewNumColumns, previewNumRows]()
     {
-        auto numericalDataRect = findLargestNumericalDataRect(*_dataPtr);
+        const auto& data = *_dataPtr;
+        auto numColumns = static_cast<int>(data.numColumns());
+        auto numRows = static_cast<int>(data.numRows());
+        auto previewColumns = static_cast<int>(previewNumColumns);
+        auto previewRows = static_cast<int>(previewNumRows);
 
-        if(numericalDataRect.isEmpty())
+        if(!_dataRect.isEmpty())
         {
-            // A numerical rectangle can't be found and there isn't an existing
-            // selected rectangle, so search for a non-numerical rectangle instead
-            if(_dataRect.isEmpty())
-                _dataRect = findLargestNonNumericalDataRect(*_dataPtr);
+            QRect dataRect(_dataRect.left(), _dataRect.top(),
+                numColumns - _dataRect.left(), numRows - _dataRect.top());
 
-            _hasDiscreteValues = true;
-            _appearsToBeContinuous = false;
+            const std::vector<QRect> newCells =
+            {
+                // Below the preview
+                {dataRect.left(), previewRows, dataRect.width(), numRows - previewRows},
+
+                // Beside the preview, when subsequent rows are wider
+                {previewColumns, dataRect.top(), numColumns - previewColumns, previewRows - dataRect.top()}
+            };
+
+            auto anyOfNewCells = [&](auto&& predicate)
+            {
+                return std::any_of(newCells.begin(), newCells.end(),
+                    [&](const auto& rect) { return !rect.isEmpty() && predicate(data, rect); });
+            };
+
+            if(_hasDiscreteValues || !anyOfNewCells(dataRectHasDiscreteValues))
+            {
+                _dataRect = dataRect;
+                _hasMissingValues = _hasMissingValues || anyOfNewCells(dataRectHasMissingValues);
+
+                if(!_hasDiscreteValues)
+                {
+                    for(const auto& rect : newCells)
+                    {
+                        if(rect.isEmpty())
+                            continue;
+
+                        auto [min, max] = dataRectMinMax(data, rect);
+                        _numericalMinMax.first = std::min(_numericalMinMax.first, min);
+                        _numericalMinMax.second = std::max(_numericalMinMax.second, max);
+                    }
+
+                    _appearsToBeContinuous = dataRectAppearsToBeContinuous(data, _dataRect);
+                }
+            }
+            else
+            {
+                // Non-numerical values appear beyond the preview, so the
+                // rectangle no longer holds; start again from scratch
+                _dataRect = {};
+                detectDataRectangle();
+            }
         }
         else
-        {
-            _dataRect = numericalDataRect;
-            _hasDiscreteValues = false;
-            _appearsToBeContinuous = dataRectAppearsToBeContinuous(*_dataPtr, _dataRect);
-            _numericalMinMax = dataRectMinMax(*_dataPtr, _dataRect);
-        }
+            detectDataRectangle();
 
-        _hasMissingValues = dataRectHasMissingValues(*_dataPtr, _dataRect);
+        // A numerical data rectangle that extends to the bottom rightmost cell implies
+        // the existence of a largest one; otherwise it must be searched for
+        _dataHasNumericalRect = !_hasDiscreteValues || !findLargestNumericalDataRect(data).isEmpty();
+        emit dataHasNumericalRectChanged();
     });
     _dataRectangleFutureWatcher.setFuture(future);
 }
@@ -856,7 +1073,8 @@ DiscreteDataVectors CorrelationTabularDataParser::sampledDiscreteDataRows(size_t
         return {};
 
     DiscreteDataVectors dataRows;
-    std::vector<QString> rowData;
+    auto dictionary = std::make_shared<DiscreteDataDictionary>();
+    std::vector<DiscreteDataDictionary::Code> rowData;
     rowData.reserve(_dataPtr->numColumns() - _dataRect.x());
 
     NodeId nodeId(0);
@@ -874,10 +1092,10 @@ DiscreteDataVectors CorrelationTabularDataParser::sampledDiscreteDataRows(size_t
                 return {};
 
             const auto& value = _dataPtr->valueAt(columnIndex, rowIndex);
-            rowData.emplace_back(value);
+            rowData.emplace_back(dictionary->codeFor(value));
         }
 
-        dataRows.emplace_back(rowData, nodeId);
+        dataRows.emplace_back(dictionary, rowData, nodeId);
         ++nodeId;
     }
 
@@ -894,6 +1112,8 @@ void CorrelationTabularDataParser::estimateGraphSize()
 
     if(_graphSizeEstimateFutureWatcher.isRunning() || _dataRectangleFutureWatcher.isRunning())
     {
+        // Any estimate that is in progress is now stale, so stop it as soon as possible
+        _graphSizeEstimateCancellable.cancel();
         _graphSizeEstimateQueued = true;
         return;
     }
@@ -901,73 +1121,158 @@ void CorrelationTabularDataParser::estimateGraphSize()
     _graphSizeEstimateQueued = false;
     _graphSizeEstimateCancellable.uncancel();
 
-    QFuture<QVariantMap> future = QtConcurrent::run([this]
+    auto generation = ++_graphSizeEstimateGeneration;
+
+    QFuture<void> future = QtConcurrent::run([this, generation]
     {
-        if(_dataPtr->numRows() == 0)
-            return QVariantMap();
+        auto publish = [this, generation](const QVariantMap& graphSizeEstimate)
+        {
+            QMetaObject::invokeMethod(this, [this, generation, graphSizeEstimate]
+            {
+                // Ignore anything that arrives from an estimate that has since been superseded
+                if(generation != _graphSizeEstimateGeneration)
+                    return;
+
+                _graphSizeEstimate = graphSizeEstimate;
+                emit graphSizeEstimateChanged();
+            }, Qt::QueuedConnection);
+        };
+
+        if(_dataPtr->numRows() <= static_cast<size_t>(_dataRect.y()))
+        {
+            publish({});
+            return;
+        }
 
         Q_ASSERT(static_cast<size_t>(_dataRect.x() + _dataRect.width()) <= _dataPtr->numColumns());
         Q_ASSERT(static_cast<size_t>(_dataRect.y() + _dataRect.height()) <= _dataPtr->numRows());
 
+        const auto numRows = _dataPtr->numRows() - static_cast<size_t>(_dataRect.y());
+
+        // The cost of an estimate is quadratic in the number of sampled rows, so start
+        // with a small sample to get something on screen quickly, then refine it
+        const size_t minSampleRows = 175;
         const size_t maxSampleRows = 1400;
-        const auto numSampleRows = std::min(maxSampleRows, _dataPtr->numRows());
-        EdgeList sampleEdges;
+        const auto finalNumSampleRows = std::min(maxSampleRows, numRows);
 
-        switch(NORMALISE_QML_ENUM(CorrelationDataType, _correlationDataType))
-        {
-        default:
-        case CorrelationDataType::Continuous:
+        for(auto numSampleRows = std::min(minSampleRows, finalNumSampleRows); ;
+            numSampleRows = std::min(numSampleRows * 2, finalNumSampleRows))
         {
-            auto correlation = ContinuousCorrelation::create(NORMALISE_QML_ENUM(CorrelationType, _continuousCorrelationType));
-            auto dataRows = sampledContinuousDataRows(numSampleRows);
+            EdgeList sampleEdges;
+            size_t numSampledRows = 0;
 
-            if(correlation == nullptr || dataRows.empty())
-                return QVariantMap();
+            switch(NORMALISE_QML_ENUM(CorrelationDataType, _correlationDataType))
+            {
+            default:
+            case CorrelationDataType::Continuous:
+            {
+                auto correlation = ContinuousCorrelation::create(NORMALISE_QML_ENUM(CorrelationType, _continuousCorrelationType));
+                auto dataRows = sampledContinuousDataRows(numSampleRows);
 
-            sampleEdges = correlation->edgeList(dataRows, _minimumCorrelation,
-                static_cast<CorrelationPolarity>(_correlationPolarity),
-                &_graphSizeEstimateCancellable);
+                if(correlation == nullptr || dataRows.empty())
+                    break;
 
-            break;
-        }
+                numSampledRows = dataRows.size();
+                sampleEdges = correlation->edgeList(dataRows, _minimumCorrelation,
+                    static_cast<CorrelationPolarity>(_correlationPolarity),
+                    &_graphSizeEstimateCancellable);
 
-        case CorrelationDataType::Discrete:
-        {
-            auto correlation = DiscreteCorrelation::create(NORMALISE_QML_ENUM(CorrelationType, _discreteCorrelationType));
-            auto dataRows = sampledDiscreteDataRows(numSampleRows);
+                break;
+            }
 
-            if(correlation == nullptr || dataRows.empty())
-                return QVariantMap();
+            case CorrelationDataType::Discrete:
+            {
+                auto correlation = DiscreteCorrelation::create(NORMALISE_QML_ENUM(CorrelationType, _discreteCorrelationType));
+                auto dataRows = sampledDiscreteDataRows(numSampleRows);
 
-            sampleEdges = correlation->edgeList(dataRows, _minimumCorrelation, _treatAsBinary,
-                &_graphSizeEstimateCancellable);
+                if(correlation == nullptr || dataRows.empty())
+                    break;
 
-            break;
-        }
-        }
+                numSampledRows = dataRows.size();
+                sampleEdges = correlation->edgeList(dataRows, _minimumCorrelation, _treatAsBinary,
+                    &_graphSizeEstimateCancellable);
 
-        auto maxNodes = static_cast<double>(_dataPtr->numRows());
-        auto maxEdges = maxNodes * maxNodes;
-        auto nodesScale = maxNodes / static_cast<double>(numSampleRows);
-        auto edgesScale = nodesScale * nodesScale;
+                break;
+            }
+            }
 
-        return graphSizeEstimate(sampleEdges, nodesScale, edgesScale, maxNodes, maxEdges);
+            if(_graphSizeEstimateCancellable.cancelled())
+                return;
+
+            auto isFinalEstimate = numSampleRows >= finalNumSampleRows;
+
+            // A small sample may miss edges that a larger one finds, so only
+            // report that the graph is empty once the largest sample agrees
+            if(!sampleEdges.empty() || isFinalEstimate)
+                publish(sampledGraphSizeEstimate(sampleEdges, numSampledRows, numRows));
+
+            if(isFinalEstimate)
+                break;
+        }
     });
 
     _graphSizeEstimateFutureWatcher.setFuture(future);
 }
 
+void CorrelationTabularDataParser::onPreviewParsed()
+{
+    _dataPtr = _previewDataPtr;
+    _model.setTabularData(*_dataPtr);
+    emit dataChanged();
+
+    _partial = true;
+    emit partialChanged();
+
+    emit dataLoaded();
+
+    _complete = true;
+    emit completeChanged();
+}
+
 void CorrelationTabularDataParser::onDataLoaded()
 {
-    if(_dataPtr != nullptr)
+    auto parsedDataPtr = std::exchange(_parsedDataPtr, nullptr);
+    auto previewDataPtr = std::exchange(_previewDataPtr, nullptr);
+
+    if(parsedDataPtr == nullptr)
     {
+        _failed = true;
+        emit failedChanged();
+    }
+    else if(_dataPtr == nullptr)
+    {
+        // The whole file was parsed in one go, without a preview
+        _dataPtr = std::move(parsedDataPtr);
         _model.setTabularData(*_dataPtr);
+        emit dataChanged();
         emit dataLoaded();
     }
     else
     {
-        _failed = true;
-        emit failedChanged();
+        // Replace the preview with the full data, taking care
+        // that nothing is still making use of the former
+        waitForDataRectangleFuture();
+
+        if(_graphSizeEstimateFutureWatcher.isRunning())
+        {
+            _graphSizeEstimateCancellable.cancel();
+            _graphSizeEstimateFutureWatcher.waitForFinished();
+        }
+
+        auto previewNumColumns = _dataPtr->numColumns();
+        auto previewNumRows = _dataPtr->numRows();
+
+        _dataPtr = std::move(parsedDataPtr);
+        _model.setTabularData(*_dataPtr);
+        emit dataChanged();
+
+        revalidateDataRectangle(previewNumColumns, previewNumRows);
+    }
+
+    if(_partial)
+    {
+        _partial = false;
+        emit partialChanged();
     }
 
     _complete = true;
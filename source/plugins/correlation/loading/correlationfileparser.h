@@ -84,7 +84,9 @@ DEFINE_QML_ENUM(
     Q_GADGET, EdgeReductionType,
     None,
     KNN,
-    PercentNN);
+    PercentNN,
+    DirectKNN,
+    ApproximateKNN);
 
 class CorrelationPluginInstance;
 
@@ -105,11 +107,19 @@ public:
     static void clipValues(ClippingType clippingType, double clippingValue, std::vector<double>& data);
     static double scaleValue(ScalingType scalingType, double value,
         double epsilon = std::nextafter(0.0, 1.0));
+    // Clips then scales data in place, returning the epsilon used to scale it; this is
+    // equivalent to clipValues, epsilonFor then scaleValue, but done in parallel passes
+    static double clipAndScale(ClippingType clippingType, double clippingValue,
+        ScalingType scalingType, ContinuousDataMatrix& data);
     static void normalise(NormaliseType normaliseType,
         ContinuousDataVectors& dataRows,
         IParser* parser = nullptr);
 
     static double epsilonFor(const std::vector<double>& data);
+    static double epsilonFor(const ContinuousDataMatrix& data);
+
+    // Recalculates each row's statistics, in parallel
+    static void updateDataRows(ContinuousDataVectors& dataRows);
 
     static EdgeList pearsonCorrelation(
         const ContinuousDataVectors& rows,
@@ -134,6 +144,7 @@ class CorrelationTabularDataParser : public QObject, public Cancellable
 
     Q_PROPERTY(int progress MEMBER _progress WRITE setProgress NOTIFY progressChanged)
     Q_PROPERTY(bool complete MEMBER _complete NOTIFY completeChanged)
+    Q_PROPERTY(bool partial MEMBER _partial NOTIFY partialChanged)
     Q_PROPERTY(bool failed MEMBER _failed NOTIFY failedChanged)
 
     Q_PROPERTY(double minimumCorrelation MEMBER _minimumCorrelation NOTIFY parameterChanged)
@@ -154,6 +165,10 @@ class CorrelationTabularDataParser : public QObject, public Cancellable
         NOTIFY graphSizeEstimateInProgressChanged)
 
 private:
+    // The number of rows that are parsed initially, such that something can be
+    // shown as soon as possible, while the remainder of the file is parsed
+    static constexpr size_t PreviewRowLimit = 2000;
+
     QFutureWatcher<void> _dataRectangleFutureWatcher;
     QFutureWatcher<void> _dataParserWatcher;
     QRect _dataRect;
@@ -163,12 +178,15 @@ private:
     std::pair<double, double> _numericalMinMax;
     bool _dataHasNumericalRect = false;
     std::shared_ptr<TabularData> _dataPtr = nullptr;
+    std::shared_ptr<TabularData> _previewDataPtr = nullptr;
+    std::shared_ptr<TabularData> _parsedDataPtr = nullptr;
     TabularDataModel _model;
     bool _transposed = false;
 
     int _progress = -1;
     std::atomic<Cancellable*> _cancellableParser = nullptr;
     bool _complete = false;
+    bool _partial = false;
     bool _failed = false;
 
     double _minimumCorrelation = 0.0;
@@ -188,8 +206,11 @@ private:
 
     bool _graphSizeEstimateQueued = false;
 
+    // Estimates are refined progressively, on increasingly large samples,
+    // each of which is reported as it completes
     Cancellable _graphSizeEstimateCancellable;
-    QFutureWatcher<QVariantMap> _graphSizeEstimateFutureWatcher;
+    QFutureWatcher<void> _graphSizeEstimateFutureWatcher;
+    int _graphSizeEstimateGeneration = 0;
     QVariantMap _graphSizeEstimate;
 
     QVariantMap dataRect() const;
@@ -199,6 +220,9 @@ private:
 
     void waitForDataRectangleFuture();
 
+    void detectDataRectangle();
+    void revalidateDataRectangle(size_t previewNumColumns, size_t previewNumRows);
+
 public:
     CorrelationTabularDataParser();
     ~CorrelationTabularDataParser() override;
@@ -214,7 +238,7 @@ public:
     bool graphSizeEstimateInProgress() const { return _graphSizeEstimateFutureWatcher.isRunning(); }
 
     QAbstractTableModel* tableModel();
-    bool busy() const { return _dataRectangleFutureWatcher.isRunning() || _dataParserWatcher.isRunning(); }
+    bool busy() const { return _dataRectangleFutureWatcher.isRunning(); }
 
     bool transposed() const;
     void setTransposed(bool transposed);
@@ -225,9 +249,11 @@ signals:
     void dataHasNumericalRectChanged();
     void busyChanged();
     void dataLoaded();
+    void previewParsed();
     void transposedChanged();
     void progressChanged();
     void completeChanged();
+    void partialChanged();
     void failedChanged();
 
     void parameterChanged();
@@ -235,6 +261,7 @@ signals:
     void graphSizeEstimateInProgressChanged();
 
 private slots:
+    void onPreviewParsed();
     void onDataLoaded();
 };
 
@@ -0,0 +1,61 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "minimumcorrelationcommand.h"
+
+#include "correlationplugin.h"
+
+MinimumCorrelationCommand::MinimumCorrelationCommand(
+    CorrelationPluginInstance& correlationPluginInstance, double minimumCorrelation) :
+    _correlationPluginInstance(&correlationPluginInstance),
+    _minimumCorrelation(minimumCorrelation)
+{}
+
+bool MinimumCorrelationCommand::execute()
+{
+    _previousMinimumCorrelation = _correlationPluginInstance->minimumCorrelation();
+
+    if(_minimumCorrelation == _previousMinimumCorrelation)
+        return false;
+
+    _addedEdgeIds.clear();
+    _removedEdges.clear();
+
+    if(_minimumCorrelation < _previousMinimumCorrelation)
+    {
+        _addedEdgeIds = _correlationPluginInstance->addRetainedEdges(
+            _minimumCorrelation, _previousMinimumCorrelation, *this);
+    }
+    else
+        _removedEdges = _correlationPluginInstance->removeEdgesBelow(_minimumCorrelation, *this);
+
+    _correlationPluginInstance->setMinimumCorrelation(_minimumCorrelation);
+
+    return true;
+}
+
+void MinimumCorrelationCommand::undo()
+{
+    if(!_addedEdgeIds.empty())
+        _correlationPluginInstance->removeEdges(_addedEdgeIds);
+
+    if(!_removedEdges.empty())
+        _correlationPluginInstance->restoreEdges(_removedEdges);
+
+    _correlationPluginInstance->setMinimumCorrelation(_previousMinimumCorrelation);
+}
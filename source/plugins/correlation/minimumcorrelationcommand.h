@@ -0,0 +1,64 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MINIMUMCORRELATIONCOMMAND_H
+#define MINIMUMCORRELATIONCOMMAND_H
+
+#include "shared/commands/icommand.h"
+#include "shared/graph/elementid.h"
+
+#include <vector>
+
+#include <QObject>
+
+class CorrelationPluginInstance;
+
+struct CorrelationEdge
+{
+    EdgeId _id;
+    NodeId _source;
+    NodeId _target;
+    double _r = 0.0;
+};
+
+// Changes the minimum correlation value to somewhere within the range of the
+// retained correlations, adding or removing edges from the graph to suit
+class MinimumCorrelationCommand : public ICommand
+{
+private:
+    CorrelationPluginInstance* _correlationPluginInstance = nullptr;
+
+    double _minimumCorrelation = 0.0;
+    double _previousMinimumCorrelation = 0.0;
+
+    std::vector<EdgeId> _addedEdgeIds;
+    std::vector<CorrelationEdge> _removedEdges;
+
+public:
+    MinimumCorrelationCommand(CorrelationPluginInstance& correlationPluginInstance,
+        double minimumCorrelation);
+
+    QString description() const override { return QObject::tr("Change Minimum Correlation"); }
+    QString verb() const override { return QObject::tr("Changing Minimum Correlation"); }
+    QString pastParticiple() const override { return QObject::tr("Minimum Correlation Changed"); }
+
+    bool execute() override;
+    void undo() override;
+};
+
+#endif // MINIMUMCORRELATIONCOMMAND_H
@@ -0,0 +1,107 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "nearestneighbours.h"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+NearestNeighbours::NearestNeighbours(size_t numVectors, size_t k, CorrelationPolarity polarity) :
+    _k(k), _polarity(polarity),
+    _neighbours(numVectors * k), _numNeighbours(numVectors, 0),
+    _minimumSignificances(numVectors), _mutexes(numVectors)
+{
+    for(auto& minimumSignificance : _minimumSignificances)
+        minimumSignificance.store(std::numeric_limits<double>::lowest(), std::memory_order_relaxed);
+}
+
+double NearestNeighbours::significanceOf(double r) const
+{
+    switch(_polarity)
+    {
+    default:
+    case CorrelationPolarity::Positive: return r;
+    case CorrelationPolarity::Negative: return -r;
+    case CorrelationPolarity::Both:     return std::abs(r);
+    }
+}
+
+void NearestNeighbours::addNeighbour(size_t index, size_t neighbourIndex, double r, double significance)
+{
+    if(significance <= _minimumSignificances[index].load(std::memory_order_relaxed))
+        return;
+
+    auto greater = [](const Neighbour& a, const Neighbour& b) { return a._significance > b._significance; };
+
+    std::unique_lock<std::mutex> lock(_mutexes[index]);
+
+    auto begin = _neighbours.begin() + static_cast<std::ptrdiff_t>(index * _k);
+    auto& numNeighbours = _numNeighbours[index];
+
+    if(numNeighbours < _k)
+    {
+        *(begin + static_cast<std::ptrdiff_t>(numNeighbours)) = {neighbourIndex, r, significance};
+        numNeighbours++;
+        std::push_heap(begin, begin + static_cast<std::ptrdiff_t>(numNeighbours), greater);
+    }
+    else if(significance > begin->_significance)
+    {
+        // Replace the least significant neighbour
+        auto end = begin + static_cast<std::ptrdiff_t>(_k);
+        std::pop_heap(begin, end, greater);
+        *(end - 1) = {neighbourIndex, r, significance};
+        std::push_heap(begin, end, greater);
+    }
+    else
+        return;
+
+    if(numNeighbours == _k)
+        _minimumSignificances[index].store(begin->_significance, std::memory_order_relaxed);
+}
+
+void NearestNeighbours::add(size_t a, size_t b, double r)
+{
+    auto significance = significanceOf(r);
+
+    addNeighbour(a, b, r, significance);
+    addNeighbour(b, a, r, significance);
+}
+
+std::vector<NearestNeighbours::Relation> NearestNeighbours::relations() const
+{
+    std::vector<Relation> relations;
+    relations.reserve(_neighbours.size());
+
+    for(size_t index = 0; index < _numNeighbours.size(); index++)
+    {
+        auto begin = _neighbours.begin() + static_cast<std::ptrdiff_t>(index * _k);
+        auto end = begin + static_cast<std::ptrdiff_t>(_numNeighbours.at(index));
+
+        for(auto it = begin; it != end; ++it)
+            relations.push_back({std::min(index, it->_index), std::max(index, it->_index), it->_r});
+    }
+
+    // A pair that are mutual neighbours will appear twice
+    std::sort(relations.begin(), relations.end(), [](const auto& a, const auto& b)
+        { return a._a < b._a || (a._a == b._a && a._b < b._b); });
+    relations.erase(std::unique(relations.begin(), relations.end(), [](const auto& a, const auto& b)
+        { return a._a == b._a && a._b == b._b; }), relations.end());
+
+    return relations;
+}
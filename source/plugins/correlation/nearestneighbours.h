@@ -0,0 +1,77 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NEARESTNEIGHBOURS_H
+#define NEARESTNEIGHBOURS_H
+
+#include "correlationtype.h"
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+// Concurrently accumulates the k most significant correlations of each of a set of
+// vectors, such that the k-NN graph can be built without the complete set of
+// correlations ever needing to exist at the same time
+class NearestNeighbours
+{
+public:
+    struct Relation
+    {
+        size_t _a = 0;
+        size_t _b = 0;
+        double _r = 0.0;
+    };
+
+private:
+    struct Neighbour
+    {
+        size_t _index = 0;
+        double _r = 0.0;
+        double _significance = 0.0;
+    };
+
+    size_t _k = 0;
+    CorrelationPolarity _polarity = CorrelationPolarity::Positive;
+
+    // Each vector's neighbours are a min-heap of (at most) k elements, ordered by significance
+    std::vector<Neighbour> _neighbours;
+    std::vector<size_t> _numNeighbours;
+
+    // The least significant of each vector's neighbours, once it has k of them; this
+    // is read without locking, so that most candidates can be rejected cheaply
+    std::vector<std::atomic<double>> _minimumSignificances;
+    std::vector<std::mutex> _mutexes;
+
+    double significanceOf(double r) const;
+    void addNeighbour(size_t index, size_t neighbourIndex, double r, double significance);
+
+public:
+    NearestNeighbours(size_t numVectors, size_t k, CorrelationPolarity polarity);
+
+    size_t k() const { return _k; }
+
+    // Called for each pair of vectors, a and b, that have a correlation of r
+    void add(size_t a, size_t b, double r);
+
+    // Every pair of vectors where either is one of the other's k nearest neighbours
+    std::vector<Relation> relations() const;
+};
+
+#endif // NEARESTNEIGHBOURS_H
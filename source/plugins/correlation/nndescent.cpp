@@ -0,0 +1,401 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "nndescent.h"
+#include "distancekernels.h"
+
+#include "shared/utils/threadpool.h"
+#include "shared/utils/cancellable.h"
+#include "shared/utils/progressable.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <cmath>
+
+// Iteration stops once fewer than this proportion of all the candidates change
+static constexpr double TerminationThreshold = 0.001;
+static constexpr size_t MaxIterations = 16;
+
+template<typename T>
+NNDescent<T>::NNDescent(const StandardisedRows<T>& rows, size_t k,
+    CorrelationPolarity polarity, double accuracy) :
+    _rows(&rows), _k(k), _polarity(polarity),
+    _minimumSignificances(rows.numRows()), _mutexes(rows.numRows())
+{
+    accuracy = std::clamp(accuracy, 0.0, 1.0);
+
+    auto numRows = rows.numRows();
+    auto listSize = k + static_cast<size_t>(std::round(static_cast<double>(3 * k) * accuracy));
+
+    _listSize = numRows > 0 ? std::min(listSize, numRows - 1) : 0;
+
+    // Joining fewer than about a third of the candidates per iteration badly hurts recall
+    auto sampleRate = 0.3 + (0.7 * accuracy);
+    _sampleSize = std::max(static_cast<size_t>(std::round(static_cast<double>(_listSize) * sampleRate)), size_t{1});
+    _neighbours.resize(numRows * _listSize);
+
+    for(auto& minimumSignificance : _minimumSignificances)
+        minimumSignificance.store(std::numeric_limits<double>::lowest(), std::memory_order_relaxed);
+}
+
+template<typename T>
+double NNDescent<T>::significanceOf(double r) const
+{
+    // Rows with no variance correlate as NaN; treating these as the least significant
+    // possible value keeps them from ever displacing, or outranking, a real neighbour
+    if(!std::isfinite(r))
+        return std::numeric_limits<double>::lowest();
+
+    switch(_polarity)
+    {
+    default:
+    case CorrelationPolarity::Positive: return r;
+    case CorrelationPolarity::Negative: return -r;
+    case CorrelationPolarity::Both:     return std::abs(r);
+    }
+}
+
+template<typename T>
+double NNDescent<T>::significanceOf(const Neighbour& neighbour) const
+{
+    if(neighbour._index == NoIndex)
+        return std::numeric_limits<double>::lowest();
+
+    return significanceOf(neighbour._r);
+}
+
+template<typename T>
+double NNDescent<T>::correlate(size_t a, size_t b) const
+{
+    return static_cast<double>(dotProduct(_rows->row(a), _rows->row(b), _rows->numColumns()));
+}
+
+template<typename T>
+void NNDescent<T>::updateMinimumSignificance(size_t index)
+{
+    auto begin = _neighbours.begin() + static_cast<std::ptrdiff_t>(index * _listSize);
+    auto end = begin + static_cast<std::ptrdiff_t>(_listSize);
+
+    auto minimum = std::numeric_limits<double>::max();
+    for(auto it = begin; it != end; ++it)
+        minimum = std::min(minimum, significanceOf(*it));
+
+    _minimumSignificances[index].store(minimum, std::memory_order_relaxed);
+}
+
+template<typename T>
+bool NNDescent<T>::addNeighbour(size_t index, size_t neighbourIndex, double r)
+{
+    auto significance = significanceOf(r);
+
+    if(significance <= _minimumSignificances[index].load(std::memory_order_relaxed))
+        return false;
+
+    std::unique_lock<std::mutex> lock(_mutexes[index]);
+
+    auto begin = _neighbours.begin() + static_cast<std::ptrdiff_t>(index * _listSize);
+    auto end = begin + static_cast<std::ptrdiff_t>(_listSize);
+    auto leastSignificant = begin;
+
+    for(auto it = begin; it != end; ++it)
+    {
+        if(it->_index == neighbourIndex)
+            return false;
+
+        if(significanceOf(*it) < significanceOf(*leastSignificant))
+            leastSignificant = it;
+    }
+
+    if(significance <= significanceOf(*leastSignificant))
+        return false;
+
+    *leastSignificant = {static_cast<uint32_t>(neighbourIndex), true, r};
+    updateMinimumSignificance(index);
+
+    return true;
+}
+
+template<typename T>
+void NNDescent<T>::initialise(ThreadPool& threadPool)
+{
+    auto numRows = _rows->numRows();
+
+    std::vector<size_t> indices(numRows);
+    std::iota(indices.begin(), indices.end(), 0);
+
+    threadPool.parallel_for(indices.begin(), indices.end(), [&](size_t index)
+    {
+        auto begin = _neighbours.begin() + static_cast<std::ptrdiff_t>(index * _listSize);
+        auto end = begin + static_cast<std::ptrdiff_t>(_listSize);
+
+        // Seeded by index, so that the result is reproducible
+        std::mt19937 randomEngine(static_cast<std::mt19937::result_type>(index));
+        std::uniform_int_distribution<size_t> distribution(0, numRows - 1);
+
+        size_t numNeighbours = 0;
+        for(auto it = begin; it != end; ++it)
+        {
+            size_t neighbourIndex = index;
+
+            if(_listSize == numRows - 1)
+            {
+                // Every other row is a neighbour
+                neighbourIndex = numNeighbours < index ? numNeighbours : numNeighbours + 1;
+            }
+            else
+            {
+                auto alreadyNeighbour = [&](size_t candidate)
+                {
+                    return std::any_of(begin, it, [candidate](const auto& neighbour)
+                        { return neighbour._index == candidate; });
+                };
+
+                while(neighbourIndex == index || alreadyNeighbour(neighbourIndex))
+                    neighbourIndex = distribution(randomEngine);
+            }
+
+            *it = {static_cast<uint32_t>(neighbourIndex), true, correlate(index, neighbourIndex)};
+            numNeighbours++;
+        }
+
+        updateMinimumSignificance(index);
+    });
+}
+
+template<typename T>
+size_t NNDescent<T>::iterate(size_t iteration, ThreadPool& threadPool, Cancellable* cancellable)
+{
+    auto numRows = _rows->numRows();
+
+    // Fixed capacity candidate lists, to avoid per row allocations
+    struct Candidates
+    {
+        size_t _capacity = 0;
+        std::vector<uint32_t> _indices;
+        std::vector<size_t> _sizes;
+
+        Candidates(size_t numRows, size_t capacity) :
+            _capacity(capacity), _indices(numRows * capacity), _sizes(numRows, 0)
+        {}
+
+        uint32_t* begin(size_t row) { return &_indices[row * _capacity]; }
+        uint32_t* end(size_t row) { return begin(row) + _sizes[row]; }
+
+        void add(size_t row, uint32_t index) { begin(row)[_sizes[row]++] = index; }
+
+        void addUnique(size_t row, uint32_t index)
+        {
+            if(std::find(begin(row), end(row), index) == end(row) && _sizes[row] < _capacity)
+                add(row, index);
+        }
+    };
+
+    // The new and old candidates of each row, plus the same again of its reverse neighbours
+    Candidates newCandidates(numRows, _sampleSize * 2);
+    Candidates oldCandidates(numRows, _listSize + _sampleSize);
+
+    std::vector<size_t> indices(numRows);
+    std::iota(indices.begin(), indices.end(), 0);
+
+    // Sample up to _sampleSize of each row's new neighbours, which are then no longer new
+    threadPool.parallel_for(indices.begin(), indices.end(), [&](size_t index)
+    {
+        auto begin = _neighbours.begin() + static_cast<std::ptrdiff_t>(index * _listSize);
+        auto end = begin + static_cast<std::ptrdiff_t>(_listSize);
+
+        thread_local std::vector<Neighbour*> newNeighbours;
+        newNeighbours.clear();
+
+        for(auto it = begin; it != end; ++it)
+        {
+            if(it->_index == NoIndex)
+                continue;
+
+            if(it->_isNew)
+                newNeighbours.push_back(&(*it));
+            else
+                oldCandidates.add(index, it->_index);
+        }
+
+        if(newNeighbours.size() > _sampleSize)
+        {
+            std::mt19937 randomEngine(static_cast<std::mt19937::result_type>((index * MaxIterations) + iteration));
+            std::shuffle(newNeighbours.begin(), newNeighbours.end(), randomEngine);
+            newNeighbours.resize(_sampleSize);
+        }
+
+        for(auto* neighbour : newNeighbours)
+        {
+            newCandidates.add(index, neighbour->_index);
+            neighbour->_isNew = false;
+        }
+    });
+
+    // Reverse neighbours are reservoir sampled, so that rows which are the neighbours
+    // of a great many others don't come to dominate the cost of the join
+    Candidates reverseNewCandidates(numRows, _sampleSize);
+    Candidates reverseOldCandidates(numRows, _sampleSize);
+    std::vector<size_t> numReverseNew(numRows, 0);
+    std::vector<size_t> numReverseOld(numRows, 0);
+
+    std::mt19937 randomEngine(static_cast<std::mt19937::result_type>(iteration));
+
+    auto sampleReverse = [&](Candidates& candidates, std::vector<size_t>& numSeen, size_t row, uint32_t index)
+    {
+        auto seen = numSeen[row]++;
+
+        if(candidates._sizes[row] < candidates._capacity)
+            candidates.add(row, index);
+        else
+        {
+            auto replace = std::uniform_int_distribution<size_t>(0, seen)(randomEngine);
+            if(replace < candidates._capacity)
+                candidates.begin(row)[replace] = index;
+        }
+    };
+
+    for(size_t index = 0; index < numRows; index++)
+    {
+        for(auto* it = newCandidates.begin(index); it != newCandidates.end(index); ++it)
+            sampleReverse(reverseNewCandidates, numReverseNew, *it, static_cast<uint32_t>(index));
+
+        for(auto* it = oldCandidates.begin(index); it != oldCandidates.end(index); ++it)
+            sampleReverse(reverseOldCandidates, numReverseOld, *it, static_cast<uint32_t>(index));
+    }
+
+    std::atomic<size_t> numUpdates(0);
+
+    threadPool.parallel_for(indices.begin(), indices.end(), [&](size_t index)
+    {
+        if(cancellable != nullptr && cancellable->cancelled())
+            return;
+
+        for(auto* it = reverseNewCandidates.begin(index); it != reverseNewCandidates.end(index); ++it)
+            newCandidates.addUnique(index, *it);
+
+        for(auto* it = reverseOldCandidates.begin(index); it != reverseOldCandidates.end(index); ++it)
+            oldCandidates.addUnique(index, *it);
+    });
+
+    // The local join: each row's new candidates are correlated with each other,
+    // and with its old candidates; pairs of old candidates have been joined already
+    threadPool.parallel_for(indices.begin(), indices.end(), [&](size_t index)
+    {
+        if(cancellable != nullptr && cancellable->cancelled())
+            return;
+
+        size_t numRowUpdates = 0;
+
+        auto join = [&](size_t a, size_t b)
+        {
+            if(a == b)
+                return;
+
+            auto r = correlate(a, b);
+            if(!std::isfinite(r))
+                return;
+
+            numRowUpdates += addNeighbour(a, b, r) ? 1 : 0;
+            numRowUpdates += addNeighbour(b, a, r) ? 1 : 0;
+        };
+
+        for(auto* a = newCandidates.begin(index); a != newCandidates.end(index); ++a)
+        {
+            for(auto* b = a + 1; b != newCandidates.end(index); ++b)
+                join(*a, *b);
+
+            for(auto* b = oldCandidates.begin(index); b != oldCandidates.end(index); ++b)
+                join(*a, *b);
+        }
+
+        numUpdates += numRowUpdates;
+    });
+
+    return numUpdates;
+}
+
+template<typename T>
+std::vector<NearestNeighbours::Relation> NNDescent<T>::relations(ThreadPool& threadPool,
+    Cancellable* cancellable, Progressable* progressable)
+{
+    std::vector<NearestNeighbours::Relation> relations;
+
+    auto numRows = _rows->numRows();
+    if(numRows < 2 || _k == 0)
+        return relations;
+
+    if(progressable != nullptr)
+        progressable->setProgress(-1);
+
+    initialise(threadPool);
+
+    auto terminationThreshold = static_cast<size_t>(TerminationThreshold *
+        static_cast<double>(numRows * _listSize));
+
+    for(size_t iteration = 0; iteration < MaxIterations; iteration++)
+    {
+        auto numUpdates = iterate(iteration, threadPool, cancellable);
+
+        if(cancellable != nullptr && cancellable->cancelled())
+            return {};
+
+        if(progressable != nullptr)
+            progressable->setProgress(static_cast<int>(((iteration + 1) * 100) / MaxIterations));
+
+        if(numUpdates <= terminationThreshold)
+            break;
+    }
+
+    if(progressable != nullptr)
+        progressable->setProgress(-1);
+
+    relations.reserve(numRows * _k);
+
+    for(size_t index = 0; index < numRows; index++)
+    {
+        auto begin = _neighbours.begin() + static_cast<std::ptrdiff_t>(index * _listSize);
+        auto end = begin + static_cast<std::ptrdiff_t>(_listSize);
+
+        // Of the candidates, only the k most significant are actually neighbours
+        auto numNeighbours = std::min(_k, _listSize);
+        auto last = begin + static_cast<std::ptrdiff_t>(numNeighbours);
+        std::partial_sort(begin, last, end, [this](const auto& a, const auto& b)
+            { return significanceOf(a) > significanceOf(b); });
+
+        for(auto it = begin; it != last; ++it)
+        {
+            if(it->_index == NoIndex || !std::isfinite(it->_r))
+                continue;
+
+            size_t neighbourIndex = it->_index;
+            relations.push_back({std::min(index, neighbourIndex), std::max(index, neighbourIndex), it->_r});
+        }
+    }
+
+    // A pair that are mutual neighbours will appear twice
+    std::sort(relations.begin(), relations.end(), [](const auto& a, const auto& b)
+        { return a._a < b._a || (a._a == b._a && a._b < b._b); });
+    relations.erase(std::unique(relations.begin(), relations.end(), [](const auto& a, const auto& b)
+        { return a._a == b._a && a._b == b._b; }), relations.end());
+
+    return relations;
+}
+
+template class NNDescent<float>;
+template class NNDescent<double>;
@@ -0,0 +1,102 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NNDESCENT_H
+#define NNDESCENT_H
+
+#include "correlationtype.h"
+#include "standardisedrows.h"
+#include "nearestneighbours.h"
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+class ThreadPool;
+class Cancellable;
+class Progressable;
+
+// Approximates the k-NN graph of a set of standardised rows using NN-descent (Dong, Charikar
+// and Li, 2011), which relies on a neighbour of a neighbour also likely being a neighbour.
+// Starting from random neighbours, each iteration correlates each row's neighbours with one
+// another, keeping any that improve upon their existing neighbours, until few do. In practice
+// this scales roughly as n^1.14, rather than the n^2 of correlating every pair of rows, at
+// the expense of missing some of the true nearest neighbours.
+template<typename T>
+class NNDescent
+{
+private:
+    static constexpr uint32_t NoIndex = std::numeric_limits<uint32_t>::max();
+
+    struct Neighbour
+    {
+        uint32_t _index = NoIndex;
+
+        // Neighbours that haven't yet been joined with the others
+        bool _isNew = true;
+
+        double _r = 0.0;
+    };
+
+    const StandardisedRows<T>* _rows = nullptr;
+    size_t _k = 0;
+    CorrelationPolarity _polarity = CorrelationPolarity::Positive;
+
+    // More candidates than k are kept per row, as this greatly improves recall
+    size_t _listSize = 0;
+
+    // The number of new candidates that are joined per row, per iteration
+    size_t _sampleSize = 0;
+
+    std::vector<Neighbour> _neighbours;
+
+    // The least significant of each row's candidates, once it has a full list of them;
+    // this is read without locking, so that most candidates can be rejected cheaply
+    std::vector<std::atomic<double>> _minimumSignificances;
+    std::vector<std::mutex> _mutexes;
+
+    double significanceOf(double r) const;
+    double significanceOf(const Neighbour& neighbour) const;
+    double correlate(size_t a, size_t b) const;
+
+    bool addNeighbour(size_t index, size_t neighbourIndex, double r);
+    void updateMinimumSignificance(size_t index);
+
+    void initialise(ThreadPool& threadPool);
+
+    // Returns the number of times a neighbour was improved upon
+    size_t iterate(size_t iteration, ThreadPool& threadPool, Cancellable* cancellable);
+
+public:
+    // accuracy, in [0, 1], trades speed for recall; it scales both the number of
+    // candidates that are kept per row, from k to 4k, and the proportion of them
+    // that are joined in each iteration
+    NNDescent(const StandardisedRows<T>& rows, size_t k, CorrelationPolarity polarity, double accuracy);
+
+    // Every pair of rows where either is one of the other's (approximate) k nearest neighbours
+    std::vector<NearestNeighbours::Relation> relations(ThreadPool& threadPool,
+        Cancellable* cancellable = nullptr, Progressable* progressable = nullptr);
+};
+
+extern template class NNDescent<float>;
+extern template class NNDescent<double>;
+
+#endif // NNDESCENT_H
@@ -20,9 +20,13 @@
 
 #include "shared/loading/iparser.h"
 #include "shared/utils/cancellable.h"
+#include "shared/utils/threadpool.h"
 
-#include <set>
 #include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
 
 #include <QtGlobal>
 
@@ -31,92 +35,91 @@ bool QuantileNormaliser::process(ContinuousDataVectors& dataRows, IParser* parse
     if(dataRows.empty())
         return true;
 
+    auto numRows = dataRows.size();
     auto numColumns = dataRows.at(0).size();
 
-    std::vector<std::vector<double>> sortedColumnValues(numColumns);
-    std::vector<size_t> ranking(dataRows.size() * numColumns);
+    std::vector<size_t> columns(numColumns);
+    std::iota(columns.begin(), columns.end(), 0);
 
-    size_t row = 0;
+    // For each column, the rows in ascending order of their value in that column
+    std::vector<std::vector<uint32_t>> columnOrders(numColumns);
+    std::atomic<size_t> numColumnsProcessed(0);
 
-    for(size_t column = 0; column < numColumns; column++)
+    auto cancelled = [parser] { return parser != nullptr && parser->cancelled(); };
+
+    auto reportProgress = [&]
+    {
+        if(parser != nullptr)
+            parser->setProgress(static_cast<int>((++numColumnsProcessed * 50) / numColumns));
+    };
+
+    parallel_for(columns.begin(), columns.end(), [&](size_t column)
     {
-        if(parser != nullptr && parser->cancelled())
-            return false;
+        if(cancelled())
+            return;
 
-        std::vector<double> columnValues;
-        columnValues.reserve(dataRows.size());
+        auto& order = columnOrders[column];
+        order.resize(numRows);
+        std::iota(order.begin(), order.end(), 0);
 
-        // Get column values
-        std::transform(dataRows.begin(), dataRows.end(), std::back_inserter(columnValues),
-        [column](const auto& dataRow)
+        std::sort(order.begin(), order.end(), [&](auto a, auto b)
         {
-            return dataRow.valueAt(column);
+            return dataRows[a].valueAt(column) < dataRows[b].valueAt(column);
         });
 
-        // Sort
-        auto sortedValues = columnValues;
-        std::sort(sortedValues.begin(), sortedValues.end());
-        auto uniqueSortedValues = sortedValues;
-        uniqueSortedValues.erase(std::unique(uniqueSortedValues.begin(), uniqueSortedValues.end()),
-            uniqueSortedValues.end());
+        reportProgress();
+    });
 
-        row = 0;
-        for(const auto& dataRow : dataRows)
-        {
-            auto index = (row * numColumns) + column;
+    if(cancelled())
+        return false;
 
-            // Set the ranking
-            size_t i = 0;
-            for(auto uniqueValue : uniqueSortedValues)
-            {
-                if(uniqueValue == dataRow.valueAt(column))
-                    ranking[index] = i;
+    // The mean of the nth smallest values of each column
+    std::vector<size_t> ranks(numRows);
+    std::iota(ranks.begin(), ranks.end(), 0);
+    std::vector<double> rankMeans(numRows);
 
-                i++;
-            }
+    parallel_for(ranks.begin(), ranks.end(), [&](size_t rank)
+    {
+        double sum = 0.0;
+        for(size_t column = 0; column < numColumns; column++)
+            sum += dataRows[columnOrders[column][rank]].valueAt(column);
 
-            row++;
-        }
+        rankMeans[rank] = sum / static_cast<double>(numColumns);
+    });
 
-        if(parser != nullptr)
-            parser->setProgress(static_cast<int>((column * 100) / numColumns));
+    parallel_for(columns.begin(), columns.end(), [&](size_t column)
+    {
+        if(cancelled())
+            return;
 
-        // Copy Result to sortedColumns
-        sortedColumnValues[column] = sortedValues;
-    }
+        auto& order = columnOrders[column];
 
-    if(parser != nullptr)
-        parser->setProgress(-1);
+        // Values that are tied share the average of the means of the ranks they span
+        for(size_t first = 0; first < numRows; )
+        {
+            auto value = dataRows[order[first]].valueAt(column);
 
-    std::vector<double> rowMeans(dataRows.size());
+            auto last = first + 1;
+            while(last < numRows && dataRows[order[last]].valueAt(column) == value)
+                last++;
 
-    // Populate row means
-    for(row = 0; row < rowMeans.size(); row++)
-    {
-        double meanValue = 0.0;
-        for(size_t column = 0; column < numColumns; column++)
-            meanValue += sortedColumnValues[column][row];
+            auto mean = std::accumulate(rankMeans.begin() + static_cast<std::ptrdiff_t>(first),
+                rankMeans.begin() + static_cast<std::ptrdiff_t>(last), 0.0) / static_cast<double>(last - first);
 
-        rowMeans[row] = meanValue / static_cast<double>(numColumns);
-    }
+            for(auto rank = first; rank < last; rank++)
+                dataRows[order[rank]].setValueAt(column, mean);
 
-    row = 0;
-    for(auto& dataRow : dataRows)
-    {
-        if(parser != nullptr && parser->cancelled())
-            return false;
+            first = last;
+        }
 
-        for(size_t column = 0; column < numColumns; column++)
-        {
-            auto index = (row * numColumns) + column;
-            auto rank = ranking[index];
-            Q_ASSERT(rank < rowMeans.size());
+        // Release the ordering as soon as it's no longer needed
+        order = {};
 
-            dataRow.setValueAt(column, rowMeans[rank]);
-        }
+        reportProgress();
+    });
 
-        row++;
-    }
+    if(parser != nullptr)
+        parser->setProgress(-1);
 
-    return true;
+    return !cancelled();
 }
@@ -0,0 +1,114 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "retainedcorrelations.h"
+
+#include "shared/utils/container.h"
+#include "shared/utils/qmlenum.h"
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QIODevice>
+
+#include <algorithm>
+
+RetainedCorrelations::RetainedCorrelations(CorrelationEdges&& edges,
+    double floor, CorrelationPolarity polarity) :
+    _floor(floor), _polarity(polarity)
+{
+    // Get the source edges out of memory before reserving space for their copy, and then
+    // release them chunk by chunk, so that they're never held in memory twice over
+    edges.spillFullChunks();
+    _edges.reserve(edges.size());
+
+    edges.consumeChunks([this](const CorrelationEdges::Chunk& chunk)
+    {
+        _edges.insert(_edges.end(), chunk.begin(), chunk.end());
+        return true;
+    });
+
+    std::sort(_edges.begin(), _edges.end(), [polarity](const auto& a, const auto& b)
+    {
+        return significanceOf(a._r, polarity) > significanceOf(b._r, polarity);
+    });
+}
+
+size_t RetainedCorrelations::countAbove(double threshold) const
+{
+    auto floatThreshold = static_cast<float>(threshold);
+
+    auto it = std::partition_point(_edges.begin(), _edges.end(), [&](const auto& edge)
+    {
+        return significanceOf(edge._r, _polarity) >= floatThreshold;
+    });
+
+    return static_cast<size_t>(std::distance(_edges.begin(), it));
+}
+
+json RetainedCorrelations::save() const
+{
+    QByteArray byteArray;
+
+    // The edges are encoded in a fixed byte order, so that the save file is portable
+    QDataStream stream(&byteArray, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    for(const auto& edge : _edges)
+        stream << edge._source << edge._target << edge._r;
+
+    json jsonObject;
+
+    jsonObject["floor"] = _floor;
+    jsonObject["polarity"] = static_cast<int>(_polarity);
+    jsonObject["edges"] = byteArray.toBase64().toStdString();
+
+    return jsonObject;
+}
+
+bool RetainedCorrelations::load(const json& jsonObject)
+{
+    if(!jsonObject.is_object() || !u::containsAllOf(jsonObject, {"floor", "polarity", "edges"}))
+        return false;
+
+    _floor = jsonObject["floor"];
+    _polarity = NORMALISE_QML_ENUM(CorrelationPolarity, jsonObject["polarity"]);
+
+    auto byteArray = QByteArray::fromBase64(
+        QByteArray::fromStdString(jsonObject["edges"].get<std::string>()));
+
+    const int encodedEdgeSize = sizeof(uint32_t) + sizeof(uint32_t) + sizeof(float);
+    if(byteArray.size() % encodedEdgeSize != 0)
+        return false;
+
+    QDataStream stream(byteArray);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    _edges.resize(static_cast<size_t>(byteArray.size() / encodedEdgeSize));
+    for(auto& edge : _edges)
+        stream >> edge._source >> edge._target >> edge._r;
+
+    if(stream.status() != QDataStream::Ok)
+    {
+        _edges.clear();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,95 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RETAINEDCORRELATIONS_H
+#define RETAINEDCORRELATIONS_H
+
+#include "correlationedges.h"
+#include "correlationtype.h"
+
+#include <json_helper.h>
+
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+
+// All of the correlations above some floor value, kept in descending order of significance,
+// so that the edges above any threshold no lower than the floor form a prefix of the store;
+// this allows the minimum correlation value to be changed without recomputing anything
+class RetainedCorrelations
+{
+private:
+    std::vector<CorrelationEdges::Edge> _edges;
+    double _floor = 0.0;
+    CorrelationPolarity _polarity = CorrelationPolarity::Positive;
+
+    // Comparisons are made at the same precision as the edges are stored at, so that
+    // an edge that met a threshold during correlation continues to meet it here
+    static float significanceOf(float r, CorrelationPolarity polarity)
+    {
+        switch(polarity)
+        {
+        default:
+        case CorrelationPolarity::Positive: return r;
+        case CorrelationPolarity::Negative: return -r;
+        case CorrelationPolarity::Both:     return std::abs(r);
+        }
+    }
+
+public:
+    RetainedCorrelations() = default;
+    RetainedCorrelations(CorrelationEdges&& edges, double floor, CorrelationPolarity polarity);
+
+    bool empty() const { return _edges.empty(); }
+    size_t size() const { return _edges.size(); }
+    double floor() const { return _floor; }
+
+    bool meetsThreshold(double r, double threshold) const
+    {
+        return significanceOf(static_cast<float>(r), _polarity) >= static_cast<float>(threshold);
+    }
+
+    // The number of edges whose significance is at least threshold
+    size_t countAbove(double threshold) const;
+
+    size_t countBetween(double lowerThreshold, double upperThreshold) const
+    {
+        auto numAboveUpper = upperThreshold < std::numeric_limits<double>::max() ?
+            countAbove(upperThreshold) : 0;
+
+        return countAbove(lowerThreshold) - numAboveUpper;
+    }
+
+    // Calls fn for each edge whose significance lies in [lowerThreshold, upperThreshold)
+    template<typename Fn>
+    void forEachBetween(double lowerThreshold, double upperThreshold, Fn&& fn) const
+    {
+        auto first = upperThreshold < std::numeric_limits<double>::max() ?
+            countAbove(upperThreshold) : 0;
+        auto last = countAbove(lowerThreshold);
+
+        for(auto i = first; i < last; i++)
+            fn(_edges[i]);
+    }
+
+    json save() const;
+    bool load(const json& jsonObject);
+};
+
+#endif // RETAINEDCORRELATIONS_H
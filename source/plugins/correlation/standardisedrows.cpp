@@ -0,0 +1,99 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "standardisedrows.h"
+
+#include <blaze/Blaze.h>
+
+#include <algorithm>
+
+// Roughly the size of a per core L2 cache
+static constexpr size_t TargetTileBytes = 512 * 1024;
+
+template<typename T>
+StandardisedRows<T>::StandardisedRows(size_t numRows, size_t numColumns) :
+    _numRows(numRows), _numColumns(numColumns),
+    _stride(((numColumns + ValuesPerCacheLine - 1) / ValuesPerCacheLine) * ValuesPerCacheLine),
+    _data(numRows * _stride, T{0})
+{}
+
+template<typename T>
+size_t StandardisedRows<T>::tileSize() const
+{
+    auto rowBytes = std::max(_stride, size_t{1}) * sizeof(T);
+    return std::clamp(TargetTileBytes / (2 * rowBytes), size_t{16}, size_t{512});
+}
+
+template<typename T>
+void StandardisedRows<T>::reorder(const std::vector<size_t>& order)
+{
+    std::vector<bool> placed(_numRows, false);
+    std::vector<T> displaced(_stride);
+
+    // Follow each cycle of the permutation, so that only a single row need be held aside
+    for(size_t start = 0; start < _numRows; start++)
+    {
+        if(placed[start])
+            continue;
+
+        std::copy_n(row(start), _stride, displaced.begin());
+
+        for(size_t index = start;;)
+        {
+            auto source = order[index];
+            placed[index] = true;
+
+            if(source == start)
+            {
+                std::copy(displaced.begin(), displaced.end(), row(index));
+                break;
+            }
+
+            std::copy_n(row(source), _stride, row(index));
+            index = source;
+        }
+    }
+}
+
+template<typename T>
+void StandardisedRows<T>::multiplyTile(size_t rowA, size_t numRowsA, size_t rowB, size_t numRowsB,
+    std::vector<T>& result) const
+{
+    multiplyTile(rowA, numRowsA, *this, rowB, numRowsB, result);
+}
+
+template<typename T>
+void StandardisedRows<T>::multiplyTile(size_t rowA, size_t numRowsA, const StandardisedRows& other,
+    size_t rowB, size_t numRowsB, std::vector<T>& result) const
+{
+    using Matrix = blaze::CustomMatrix<T, blaze::unaligned, blaze::unpadded, blaze::rowMajor>;
+
+    result.resize(numRowsA * numRowsB);
+
+    // blaze can't wrap const data when a spacing is specified, but being
+    // unpadded, the matrices are only ever read from, so this is safe
+    const Matrix a(const_cast<T*>(row(rowA)), numRowsA, _numColumns, _stride); // NOLINT cppcoreguidelines-pro-type-const-cast
+    const Matrix b(const_cast<T*>(other.row(rowB)), numRowsB, _numColumns, other._stride); // NOLINT cppcoreguidelines-pro-type-const-cast
+    Matrix c(result.data(), numRowsA, numRowsB);
+
+    // Tiles are already processed concurrently, so avoid blaze spawning its own threads
+    c = blaze::serial(a * blaze::trans(b));
+}
+
+template class StandardisedRows<float>;
+template class StandardisedRows<double>;
@@ -0,0 +1,70 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STANDARDISEDROWS_H
+#define STANDARDISEDROWS_H
+
+#include <vector>
+#include <cstddef>
+
+// A contiguous row-major matrix of data vectors, each of which has been transformed
+// such that the correlation of any two rows is simply their dot product; T may be float
+// in order to double the throughput, at some cost to accuracy
+template<typename T>
+class StandardisedRows
+{
+private:
+    size_t _numRows = 0;
+    size_t _numColumns = 0;
+
+    static constexpr size_t ValuesPerCacheLine = 64 / sizeof(T);
+
+    // Rows are padded out to a whole number of cache lines
+    size_t _stride = 0;
+
+    std::vector<T> _data;
+
+public:
+    StandardisedRows(size_t numRows, size_t numColumns);
+
+    size_t numRows() const { return _numRows; }
+    size_t numColumns() const { return _numColumns; }
+
+    T* row(size_t index) { return &_data[index * _stride]; }
+    const T* row(size_t index) const { return &_data[index * _stride]; }
+
+    // The number of rows per tile, such that a pair of tiles fits in cache
+    size_t tileSize() const;
+
+    // Rearranges the rows such that row i becomes what was previously row order[i]
+    void reorder(const std::vector<size_t>& order);
+
+    // Computes the dot products of each row in [rowA, rowA + numRowsA) with
+    // each row in [rowB, rowB + numRowsB), as a numRowsA x numRowsB row-major matrix
+    void multiplyTile(size_t rowA, size_t numRowsA, size_t rowB, size_t numRowsB,
+        std::vector<T>& result) const;
+
+    // As above, except that the B rows are taken from other, which must have the same number of columns
+    void multiplyTile(size_t rowA, size_t numRowsA, const StandardisedRows& other,
+        size_t rowB, size_t numRowsB, std::vector<T>& result) const;
+};
+
+extern template class StandardisedRows<float>;
+extern template class StandardisedRows<double>;
+
+#endif // STANDARDISEDROWS_H
@@ -92,6 +92,10 @@ BaseParameterDialog
         onDataLoaded:
         {
             tabularDataParser.autoDetectDataRectangle();
+        }
+
+        onDataChanged:
+        {
             parameters.data = tabularDataParser.data;
         }
 
@@ -239,6 +243,17 @@ BaseParameterDialog
                         "Note that the dataframe always extends to the bottom rightmost cell of the dataset.")
                 }
 
+                Text
+                {
+                    Layout.fillWidth: true
+                    wrapMode: Text.WordWrap
+                    visible: tabularDataParser.partial
+                    text: Utils.format(qsTr("<i>The first rows of the dataset are shown while the remainder " +
+                        "is loaded{0}; the dataframe will be extended accordingly.</i>"),
+                        tabularDataParser.progress >= 0 ? Utils.format(qsTr(" ({0}%)"), tabularDataParser.progress) : "")
+                    textFormat: Text.StyledText
+                }
+
                 RowLayout
                 {
                     CheckBox
@@ -654,6 +669,93 @@ BaseParameterDialog
                                 }
                             }
 
+                            Text
+                            {
+                                visible: dataTypeComboBox.value === CorrelationDataType.Continuous
+                                text: qsTr("Precision:")
+                                Layout.alignment: Qt.AlignRight
+                            }
+
+                            ComboBox
+                            {
+                                visible: dataTypeComboBox.value === CorrelationDataType.Continuous
+                                id: precisionComboBox
+
+                                model: ListModel
+                                {
+                                    ListElement { text: qsTr("Double");   value: false }
+                                    ListElement { text: qsTr("Single");   value: true }
+                                }
+                                textRole: "text"
+
+                                onCurrentIndexChanged:
+                                {
+                                    parameters.singlePrecision = model.get(currentIndex).value;
+                                }
+
+                                property bool value: { return model.get(currentIndex).value; }
+                            }
+
+                            HelpTooltip
+                            {
+                                visible: dataTypeComboBox.value === CorrelationDataType.Continuous
+                                title: qsTr("Precision")
+                                Text
+                                {
+                                    wrapMode: Text.WordWrap
+                                    text: qsTr("The numerical precision with which correlations are calculated. " +
+                                        "<i>Single</i> precision is faster, at the expense of some " +
+                                        "accuracy. Typically the difference is " +
+                                        "insignificant in comparison to the correlation threshold.")
+                                }
+                            }
+
+                            Text
+                            {
+                                visible: dataTypeComboBox.value === CorrelationDataType.Continuous
+                                text: qsTr("Pruning:")
+                                Layout.alignment: Qt.AlignRight
+                            }
+
+                            ComboBox
+                            {
+                                visible: dataTypeComboBox.value === CorrelationDataType.Continuous
+                                id: pruningComboBox
+
+                                model: ListModel
+                                {
+                                    ListElement { text: qsTr("None");           value: CorrelationPruning.None }
+                                    ListElement { text: qsTr("Exact");          value: CorrelationPruning.Exact }
+                                    ListElement { text: qsTr("Approximate");    value: CorrelationPruning.Approximate }
+                                }
+                                textRole: "text"
+
+                                onCurrentIndexChanged:
+                                {
+                                    parameters.correlationPruning = model.get(currentIndex).value;
+                                }
+
+                                property int value: { return model.get(currentIndex).value; }
+                            }
+
+                            HelpTooltip
+                            {
+                                visible: dataTypeComboBox.value === CorrelationDataType.Continuous
+                                title: qsTr("Pruning")
+                                Text
+                                {
+                                    wrapMode: Text.WordWrap
+                                    text: qsTr("Avoids calculating correlations that cannot exceed the minimum " +
+                                        "threshold. <i>Exact</i> pruning skips groups of rows that are provably " +
+                                        "too dissimilar, and gives identical results; it is most effective when " +
+                                        "the data contains large clusters. <i>Approximate</i> pruning also skips " +
+                                        "individual pairs of rows estimated to be too dissimilar, which is much " +
+                                        "faster for large datasets and high thresholds, but may miss a very " +
+                                        "small number of correlations close to the threshold. Pruning applies " +
+                                        "to the Pearson, Spearman Rank, Cosine Similarity and Bicor algorithms.")
+                                }
+                            }
+
                             Text
                             {
                                 visible: dataTypeComboBox.value === CorrelationDataType.Continuous &&
@@ -1201,6 +1303,61 @@ BaseParameterDialog
                         }
                     }
 
+                    RowLayout
+                    {
+                        Layout.fillWidth: true
+
+                        CheckBox
+                        {
+                            id: retainCorrelationsCheckBox
+
+                            text: qsTr("Retain Correlations Above:")
+
+                            onCheckedChanged:
+                            {
+                                parameters.retainCorrelations = checked;
+                            }
+                        }
+
+                        DoubleSpinBox
+                        {
+                            id: retainedCorrelationFloorSpinBox
+
+                            implicitWidth: 70
+                            enabled: retainCorrelationsCheckBox.checked
+
+                            from: 0.0
+                            to: minimumCorrelationSpinBox.value
+
+                            decimals: 3
+                            stepSize: Utils.incrementForRange(from, to);
+                            editable: true
+
+                            onValueChanged:
+                            {
+                                parameters.retainedCorrelationFloor = value;
+                            }
+                        }
+
+                        HelpTooltip
+                        {
+                            title: qsTr("Retain Correlations")
+                            Text
+                            {
+                                wrapMode: Text.WordWrap
+                                text: qsTr("If this is enabled, all the correlations above the given value are " +
+                                           "retained and saved alongside the graph, so that the minimum " +
+                                           "correlation value may later be changed to anything within that " +
+                                           "range, without having to recompute the correlation. Retaining " +
+                                           "correlations far below the minimum value will increase the compute " +
+                                           "and memory requirements, as well as the size of the saved file. " +
+                                           "While they're being retained, the correlations are first moved " +
+                                           "to a temporary file, then read back a piece at a time, so " +
+                                           "that they're never held in memory twice over.")
+                            }
+                        }
+                    }
+
                     GraphSizeEstimatePlot
                     {
                         id: graphSizeEstimatePlot
@@ -1355,6 +1512,8 @@ BaseParameterDialog
                             ListElement { text: qsTr("None");   value: EdgeReductionType.None }
                             ListElement { text: qsTr("k-NN");   value: EdgeReductionType.KNN }
                             ListElement { text: qsTr("%-NN");   value: EdgeReductionType.PercentNN }
+                            ListElement { text: qsTr("k-NN (Direct)");   value: EdgeReductionType.DirectKNN }
+                            ListElement { text: qsTr("k-NN (Approximate)");   value: EdgeReductionType.ApproximateKNN }
                         }
                         textRole: "text"
 
@@ -1411,9 +1570,127 @@ BaseParameterDialog
                                     wrapMode: Text.WordWrap
                                     Layout.fillWidth: true
                                 }
+
+                                Text
+                                {
+                                    text: qsTr("<b>k-NN (Direct):</b>")
+                                    textFormat: Text.StyledText
+                                    Layout.alignment: Qt.AlignTop | Qt.AlignLeft
+                                }
+
+                                Text
+                                {
+                                    text: qsTr("As k-nearest neighbours, but only the edges it retains " +
+                                        "are created in the first place. This requires far less memory " +
+                                        "for large datasets, but <i>k</i> cannot subsequently be " +
+                                        "increased beyond the value chosen here.");
+                                    wrapMode: Text.WordWrap
+                                    Layout.fillWidth: true
+                                }
+
+                                Text
+                                {
+                                    text: qsTr("<b>k-NN (Approximate):</b>")
+                                    textFormat: Text.StyledText
+                                    Layout.alignment: Qt.AlignTop | Qt.AlignLeft
+                                }
+
+                                Text
+                                {
+                                    text: qsTr("As k-NN (Direct), but rather than evaluating every pair " +
+                                        "of rows, the nearest neighbours are found approximately, by " +
+                                        "repeatedly comparing the neighbours of neighbours. This makes " +
+                                        "very large datasets tractable, at the cost of missing some " +
+                                        "edges. Euclidean similarity is not supported and is instead " +
+                                        "computed as k-NN (Direct).");
+                                    wrapMode: Text.WordWrap
+                                    Layout.fillWidth: true
+                                }
                             }
                         }
                     }
+
+                    Text
+                    {
+                        visible: numNearestNeighboursSpinBox.visible
+                        text: qsTr("k:")
+                        Layout.alignment: Qt.AlignLeft
+                    }
+
+                    SpinBox
+                    {
+                        id: numNearestNeighboursSpinBox
+                        visible: edgeReductionComboBox.value === EdgeReductionType.KNN ||
+                            edgeReductionComboBox.value === EdgeReductionType.DirectKNN ||
+                            edgeReductionComboBox.value === EdgeReductionType.ApproximateKNN
+
+                        implicitWidth: 70
+
+                        from: 1
+                        to: 100
+                        value: 5
+
+                        editable: true
+                        Component.onCompleted: { contentItem.selectByMouse = true; }
+
+                        onValueChanged:
+                        {
+                            parameters.numNearestNeighbours = value;
+                        }
+                    }
+
+                    HelpTooltip
+                    {
+                        visible: numNearestNeighboursSpinBox.visible
+                        title: qsTr("k")
+                        Text
+                        {
+                            wrapMode: Text.WordWrap
+                            text: qsTr("The number of edges to retain per node. For the <i>Direct</i> " +
+                                       "and <i>Approximate</i> methods, this is also the largest " +
+                                       "<i>k</i> that the k-NN transform can subsequently use.")
+                        }
+                    }
+
+                    Text
+                    {
+                        visible: edgeReductionComboBox.value === EdgeReductionType.ApproximateKNN
+                        text: qsTr("Accuracy:")
+                        Layout.alignment: Qt.AlignLeft
+                    }
+
+                    DoubleSpinBox
+                    {
+                        id: approximateKNNAccuracySpinBox
+                        visible: edgeReductionComboBox.value === EdgeReductionType.ApproximateKNN
+
+                        implicitWidth: 70
+
+                        from: 0.0
+                        to: 1.0
+                        value: 0.5
+
+                        decimals: 2
+                        stepSize: 0.05
+                        editable: true
+
+                        onValueChanged:
+                        {
+                            parameters.approximateKNNAccuracy = value;
+                        }
+                    }
+
+                    HelpTooltip
+                    {
+                        visible: edgeReductionComboBox.value === EdgeReductionType.ApproximateKNN
+                        title: qsTr("Accuracy")
+                        Text
+                        {
+                            wrapMode: Text.WordWrap
+                            text: qsTr("Higher values find more of the true nearest neighbours, " +
+                                       "but take longer to compute.")
+                        }
+                    }
                 }
             }
         }
@@ -1465,6 +1742,9 @@ BaseParameterDialog
                             summaryString += Utils.format(qsTr("Minimum Correlation Value: {0}<br>"), QmlUtils.formatNumberScientific(minimumCorrelationSpinBox.value));
                             summaryString += Utils.format(qsTr("Initial Correlation Threshold: {0}<br>"), QmlUtils.formatNumberScientific(initialCorrelationSpinBox.value));
 
+                            if(retainCorrelationsCheckBox.checked)
+                                summaryString += Utils.format(qsTr("Retained Correlations Above: {0}<br>"), QmlUtils.formatNumberScientific(retainedCorrelationFloorSpinBox.value));
+
                             if(tabularDataParser.dataRect.hasMissingValues)
                             {
                                 summaryString += Utils.format(qsTr("Imputation: {0}"), missingDataTypeComboBox.currentText);
@@ -1498,6 +1778,9 @@ BaseParameterDialog
                             summaryString += Utils.format(qsTr("Discrete Correlation Metric: {0}<br>"), discreteAlgorithmComboBox.currentText);
                             summaryString += Utils.format(qsTr("Minimum Correlation Value: {0}<br>"), QmlUtils.formatNumberScientific(minimumCorrelationSpinBox.value));
                             summaryString += Utils.format(qsTr("Initial Correlation Threshold: {0}<br>"), QmlUtils.formatNumberScientific(initialCorrelationSpinBox.value));
+
+                            if(retainCorrelationsCheckBox.checked)
+                                summaryString += Utils.format(qsTr("Retained Correlations Above: {0}<br>"), QmlUtils.formatNumberScientific(retainedCorrelationFloorSpinBox.value));
                         }
 
                         let transformString = ""
@@ -1571,7 +1854,8 @@ BaseParameterDialog
             }
         }
 
-        finishEnabled: !tabularDataParser.graphSizeEstimateInProgress && !dataRectPage._busy
+        finishEnabled: !tabularDataParser.graphSizeEstimateInProgress && !dataRectPage._busy &&
+            !tabularDataParser.partial
 
         onAccepted:
         {
@@ -1627,6 +1911,10 @@ BaseParameterDialog
             correlationDataType: CorrelationDataType.Continuous,
             continuousCorrelationType: CorrelationType.Pearson,
             correlationPolarity: CorrelationPolarity.Positive,
+            singlePrecision: false,
+            correlationPruning: CorrelationPruning.None,
+            retainCorrelations: false, retainedCorrelationFloor: 0.5,
+            numNearestNeighbours: 5, approximateKNNAccuracy: 0.5,
             discreteCorrelationType: CorrelationType.Jaccard,
             scaling: ScalingType.None, normalise: NormaliseType.None,
             missingDataType: MissingDataType.Constant,
@@ -1635,6 +1923,10 @@ BaseParameterDialog
         minimumCorrelationSpinBox.value = DEFAULT_MINIMUM_CORRELATION;
         initialCorrelationSpinBox.value = DEFAULT_INITIAL_CORRELATION;
         transposeCheckBox.checked = false;
+        retainCorrelationsCheckBox.checked = false;
+        retainedCorrelationFloorSpinBox.value = 0.5;
+        numNearestNeighboursSpinBox.value = 5;
+        approximateKNNAccuracySpinBox.value = 0.5;
         dataTypeComboBox.currentIndex = 0;
 
         populateCorrelationAlgorithmTooltip(discreteAlgorithmComboBox.model, discreteAlgorithmTooltip);
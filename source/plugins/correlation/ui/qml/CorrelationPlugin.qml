@@ -23,6 +23,7 @@ import QtQuick.Controls
 import Qt.labs.platform as Labs
 
 import app.graphia
+import app.graphia.Controls
 import app.graphia.Shared
 import app.graphia.Shared.Controls
 
@@ -368,6 +369,53 @@ PluginContent
         onTriggered: { yAxisLabelDialog.open(); }
     }
 
+    Action
+    {
+        id: changeMinimumCorrelationAction
+        text: qsTr("Change Minimum Correlation…")
+        enabled: plugin.model.hasRetainedCorrelations
+        onTriggered:
+        {
+            minimumCorrelationSpinBox.value = plugin.model.minimumCorrelation;
+            minimumCorrelationDialog.open();
+        }
+    }
+
+    Dialog
+    {
+        id: minimumCorrelationDialog
+        visible: false
+        modal: true
+        anchors.centerIn: parent
+        title: qsTr("Minimum Correlation")
+
+        standardButtons: Dialog.Ok | Dialog.Cancel
+
+        RowLayout
+        {
+            Text
+            {
+                Layout.bottomMargin: 12
+                text: qsTr("Please enter the minimum correlation value:")
+            }
+            DoubleSpinBox
+            {
+                id: minimumCorrelationSpinBox
+                Layout.bottomMargin: 12
+                implicitWidth: 70
+
+                from: plugin.model.retainedCorrelationFloor
+                to: 1.0
+
+                decimals: 3
+                stepSize: Utils.incrementForRange(from, to);
+                editable: true
+            }
+        }
+
+        onAccepted: plugin.model.changeMinimumCorrelation(minimumCorrelationSpinBox.value);
+    }
+
     Dialog
     {
         id: xAxisLabelDialog
@@ -588,6 +636,7 @@ PluginContent
 
             let sortByMenu = MenuUtils.addSubMenuTo(menu, qsTr("Sort Columns By"));
             let addedSortBySeparator = false;
+            let connectedClusteringComplete = false;
 
             root._availableplotColumnSortOptions.forEach(function(sortOption)
             {
@@ -616,6 +665,12 @@ PluginContent
                         return sortOption.text === columnSortAnnotation;
                     }
 
+                    if(sortOption.type === columnSortType &&
+                        columnSortType === PlotColumnSortType.HierarchicalClustering)
+                    {
+                        return sortOption.linkage === plugin.model.clusteringLinkage;
+                    }
+
                     return sortOption.type === columnSortType;
                 });
 
@@ -632,10 +687,16 @@ PluginContent
                         // in case the clustering is cancelled by the user
                         root.updatePlotMenuState();
 
+                        plugin.model.clusteringLinkage = sortOption.linkage;
                         plugin.model.computeHierarchicalClustering();
                     });
 
-                    plugin.model.hierarchicalClusteringComplete.connect(sortFn);
+                    // There is an option per linkage, but only one of them needs to respond
+                    if(!connectedClusteringComplete)
+                    {
+                        plugin.model.hierarchicalClusteringComplete.connect(sortFn);
+                        connectedClusteringComplete = true;
+                    }
                 }
                 else
                     sortByMenuItem.triggered.connect(sortFn);
@@ -673,6 +734,12 @@ PluginContent
                 });
             }
 
+            if(plugin.model.hasRetainedCorrelations)
+            {
+                MenuUtils.addSeparatorTo(menu);
+                MenuUtils.addActionTo(menu, changeMinimumCorrelationAction);
+            }
+
             MenuUtils.addSeparatorTo(menu);
             MenuUtils.addActionTo(menu, savePlotImageAction);
 
@@ -705,7 +772,14 @@ PluginContent
             {type: PlotColumnSortType.Natural, text: qsTr("Natural Order")},
             {type: PlotColumnSortType.ColumnName, text: qsTr("Column Name")},
             {type: PlotColumnSortType.DataValue, text: qsTr("Data Value")},
-            {type: PlotColumnSortType.HierarchicalClustering, text: qsTr("Hierarchical Clustering")}
+            {type: PlotColumnSortType.HierarchicalClustering, text: qsTr("Hierarchical Clustering (Single Linkage)"),
+                linkage: ClusteringLinkage.Single},
+            {type: PlotColumnSortType.HierarchicalClustering, text: qsTr("Hierarchical Clustering (Average Linkage)"),
+                linkage: ClusteringLinkage.Average},
+            {type: PlotColumnSortType.HierarchicalClustering, text: qsTr("Hierarchical Clustering (Complete Linkage)"),
+                linkage: ClusteringLinkage.Complete},
+            {type: PlotColumnSortType.HierarchicalClustering, text: qsTr("Hierarchical Clustering (Ward Linkage)"),
+                linkage: ClusteringLinkage.Ward}
         ];
 
         root._availableColumnAnnotationNames.forEach(function(columnAnnotationName)
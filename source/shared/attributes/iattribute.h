@@ -53,7 +53,11 @@ DEFINE_QML_ENUM(
     DisableDuringTransform  = 0x10,
 
     // Can be searched by the various find methods
-    Searchable              = 0x20);
+    Searchable              = 0x20,
+
+    // Values are a function of the element alone, rather than the graph's structure,
+    // so are unaffected by the addition or removal of other elements; implied by userDefined
+    StructureIndependent    = 0x40);
 
 class IGraphComponent;
 
@@ -27,13 +27,22 @@
 #include <set>
 #include <cstdlib>
 #include <cmath>
+#include <utility>
 
-QVariantMap graphSizeEstimate(EdgeList edgeList,
-    double nodesScale, double edgesScale,
-    double nodesMax, double edgesMax)
+namespace
 {
-    if(edgeList.empty())
-        return {};
+// The number of nodes and edges that remain at each of a series of thresholds
+struct GraphSizeCounts
+{
+    QVector<double> _keys;
+    QVector<double> _numNodes;
+    QVector<double> _numEdges;
+    QVector<double> _numUniqueEdges;
+};
+
+GraphSizeCounts graphSizeCounts(EdgeList& edgeList)
+{
+    GraphSizeCounts counts;
 
     std::sort(edgeList.begin(), edgeList.end(),
         [](const auto& a, const auto& b) { return std::abs(a._weight) > std::abs(b._weight); });
@@ -44,15 +53,10 @@ QVariantMap graphSizeEstimate(EdgeList edgeList,
     const auto sampleQuantum = (largestWeight - smallestWeight) / (numEstimateSamples - 1);
     auto sampleCutoff = std::abs(largestWeight) - sampleQuantum;
 
-    QVector<double> keys;
-    QVector<double> estimatedNumNodes;
-    QVector<double> estimatedNumEdges;
-    QVector<double> estimatedNumUniqueEdges;
-
-    keys.reserve(static_cast<int>(edgeList.size()));
-    estimatedNumNodes.reserve(static_cast<int>(edgeList.size()));
-    estimatedNumEdges.reserve(static_cast<int>(edgeList.size()));
-    estimatedNumUniqueEdges.reserve(static_cast<int>(edgeList.size()));
+    counts._keys.reserve(numEstimateSamples + 1);
+    counts._numNodes.reserve(numEstimateSamples + 1);
+    counts._numEdges.reserve(numEstimateSamples + 1);
+    counts._numUniqueEdges.reserve(numEstimateSamples + 1);
 
     size_t numEdges = 0;
     size_t numUniqueEdges = 0;
@@ -60,14 +64,19 @@ QVariantMap graphSizeEstimate(EdgeList edgeList,
     std::set<UndirectedEdge> uniqueEdges;
     auto weight = std::abs(edgeList.front()._weight);
 
+    auto appendCounts = [&](double key)
+    {
+        counts._keys.append(key);
+        counts._numNodes.append(static_cast<double>(nonSingletonNodes.size()));
+        counts._numEdges.append(static_cast<double>(numEdges));
+        counts._numUniqueEdges.append(static_cast<double>(numUniqueEdges));
+    };
+
     for(const auto& edge : edgeList)
     {
         if(std::abs(edge._weight) < sampleCutoff)
         {
-            keys.append(weight);
-            estimatedNumNodes.append(std::ceil(std::min(static_cast<double>(nonSingletonNodes.size()) * nodesScale, nodesMax)));
-            estimatedNumEdges.append(std::ceil(std::min(static_cast<double>(numEdges) * edgesScale, edgesMax)));
-            estimatedNumUniqueEdges.append(std::ceil(std::min(static_cast<double>(numUniqueEdges) * edgesScale, edgesMax)));
+            appendCounts(weight);
 
             sampleCutoff -= sampleQuantum;
             weight = std::abs(edge._weight);
@@ -81,25 +90,112 @@ QVariantMap graphSizeEstimate(EdgeList edgeList,
             numUniqueEdges++;
     }
 
-    keys.append(std::min(weight, smallestWeight));
-    estimatedNumNodes.append(std::ceil(std::min(static_cast<double>(nonSingletonNodes.size()) * nodesScale, nodesMax)));
-    estimatedNumEdges.append(std::ceil(std::min(static_cast<double>(numEdges) * edgesScale, edgesMax)));
-    estimatedNumUniqueEdges.append(std::ceil(std::min(static_cast<double>(numUniqueEdges) * edgesScale, edgesMax)));
+    appendCounts(std::min(weight, smallestWeight));
+
+    std::reverse(counts._keys.begin(), counts._keys.end());
+    std::reverse(counts._numNodes.begin(), counts._numNodes.end());
+    std::reverse(counts._numEdges.begin(), counts._numEdges.end());
+    std::reverse(counts._numUniqueEdges.begin(), counts._numUniqueEdges.end());
 
-    std::reverse(keys.begin(), keys.end());
-    std::reverse(estimatedNumNodes.begin(), estimatedNumNodes.end());
-    std::reverse(estimatedNumEdges.begin(), estimatedNumEdges.end());
-    std::reverse(estimatedNumUniqueEdges.begin(), estimatedNumUniqueEdges.end());
+    return counts;
+}
 
-    keys.shrink_to_fit();
-    estimatedNumNodes.shrink_to_fit();
-    estimatedNumEdges.shrink_to_fit();
-    estimatedNumUniqueEdges.shrink_to_fit();
+QVector<double> scaled(const QVector<double>& counts, double scale, double max)
+{
+    QVector<double> values;
+    values.reserve(counts.size());
+
+    for(auto count : counts)
+        values.append(std::ceil(std::min(count * scale, max)));
+
+    return values;
+}
+
+// Approximate 95% confidence bounds on a population total, given counts of the members
+// of a simple random sample of sampleSize, drawn from populationSize, that have some property
+std::pair<QVector<double>, QVector<double>> confidenceBands(const QVector<double>& counts,
+    double sampleSize, double populationSize, double max)
+{
+    const double z = 1.96;
+
+    std::pair<QVector<double>, QVector<double>> bands;
+    auto& [lower, upper] = bands;
+    lower.reserve(counts.size());
+    upper.reserve(counts.size());
+
+    auto scale = populationSize / sampleSize;
+    auto finitePopulationCorrection = populationSize > 1.0 ?
+        std::sqrt(std::max(populationSize - sampleSize, 0.0) / (populationSize - 1.0)) : 0.0;
+
+    for(auto count : counts)
+    {
+        auto p = count / sampleSize;
+        auto standardError = std::sqrt(sampleSize * p * (1.0 - p)) * finitePopulationCorrection;
+
+        lower.append(std::floor(std::max(count - (z * standardError), 0.0) * scale));
+        upper.append(std::ceil(std::min((count + (z * standardError)) * scale, max)));
+    }
+
+    return bands;
+}
+} // namespace
+
+QVariantMap graphSizeEstimate(EdgeList edgeList,
+    double nodesScale, double edgesScale,
+    double nodesMax, double edgesMax)
+{
+    if(edgeList.empty())
+        return {};
+
+    auto counts = graphSizeCounts(edgeList);
+
+    QVariantMap map;
+    map.insert(QStringLiteral("keys"), QVariant::fromValue(counts._keys));
+    map.insert(QStringLiteral("numNodes"), QVariant::fromValue(scaled(counts._numNodes, nodesScale, nodesMax)));
+    map.insert(QStringLiteral("numEdges"), QVariant::fromValue(scaled(counts._numEdges, edgesScale, edgesMax)));
+    map.insert(QStringLiteral("numUniqueEdges"), QVariant::fromValue(
+        scaled(counts._numUniqueEdges, edgesScale, edgesMax)));
+    return map;
+}
+
+QVariantMap sampledGraphSizeEstimate(EdgeList edgeList, size_t numSampleNodes, size_t numNodes)
+{
+    if(edgeList.empty() || numSampleNodes == 0)
+        return {};
+
+    auto counts = graphSizeCounts(edgeList);
+
+    auto sampleNodes = static_cast<double>(numSampleNodes);
+    auto nodes = static_cast<double>(numNodes);
+    auto nodesScale = nodes / sampleNodes;
+
+    // The edges are (potentially) between any pair of nodes
+    auto samplePairs = sampleNodes * sampleNodes;
+    auto pairs = nodes * nodes;
+    auto edgesScale = nodesScale * nodesScale;
 
     QVariantMap map;
-    map.insert(QStringLiteral("keys"), QVariant::fromValue(keys));
-    map.insert(QStringLiteral("numNodes"), QVariant::fromValue(estimatedNumNodes));
-    map.insert(QStringLiteral("numEdges"), QVariant::fromValue(estimatedNumEdges));
-    map.insert(QStringLiteral("numUniqueEdges"), QVariant::fromValue(estimatedNumUniqueEdges));
+    map.insert(QStringLiteral("keys"), QVariant::fromValue(counts._keys));
+    map.insert(QStringLiteral("numNodes"), QVariant::fromValue(scaled(counts._numNodes, nodesScale, nodes)));
+    map.insert(QStringLiteral("numEdges"), QVariant::fromValue(scaled(counts._numEdges, edgesScale, pairs)));
+    map.insert(QStringLiteral("numUniqueEdges"), QVariant::fromValue(
+        scaled(counts._numUniqueEdges, edgesScale, pairs)));
+
+    // Edges between the sampled nodes aren't independent of each other, so
+    // the edge bands are only a rough indication of the uncertainty
+    auto insertBands = [&](const QString& name, const QVector<double>& sampleCounts,
+        double sampleSize, double populationSize)
+    {
+        auto [lower, upper] = confidenceBands(sampleCounts, sampleSize, populationSize, populationSize);
+        map.insert(name + QStringLiteral("Lower"), QVariant::fromValue(lower));
+        map.insert(name + QStringLiteral("Upper"), QVariant::fromValue(upper));
+    };
+
+    insertBands(QStringLiteral("numNodes"), counts._numNodes, sampleNodes, nodes);
+    insertBands(QStringLiteral("numEdges"), counts._numEdges, samplePairs, pairs);
+    insertBands(QStringLiteral("numUniqueEdges"), counts._numUniqueEdges, samplePairs, pairs);
+
+    map.insert(QStringLiteral("numSampleNodes"), static_cast<qulonglong>(numSampleNodes));
+
     return map;
 }
@@ -24,10 +24,16 @@
 #include <QVariantMap>
 
 #include <limits>
+#include <cstddef>
 
 QVariantMap graphSizeEstimate(EdgeList edgeList,
     double nodesScale = 1.0, double edgesScale = 1.0,
     double nodesMax = std::numeric_limits<double>::max(),
     double edgesMax = std::numeric_limits<double>::max());
 
+// As above, but for an edge list that results from a random sample of numSampleNodes of the
+// numNodes nodes in the full graph; the estimates are extrapolated to the full graph, and are
+// accompanied by approximate 95% confidence bands, in the keys suffixed "Lower" and "Upper"
+QVariantMap sampledGraphSizeEstimate(EdgeList edgeList, size_t numSampleNodes, size_t numNodes);
+
 #endif // GRAPHSIZEESTIMATE_H
@@ -23,6 +23,7 @@
 
 #include <set>
 #include <algorithm>
+#include <iterator>
 
 TabularData::TabularData(TabularData&& other) noexcept :
     _data(std::move(other._data)),
@@ -137,6 +138,25 @@ void TabularData::setValueAt(size_t column, size_t row, QString&& value, int pro
     _data.at(index(column, row)) = value.trimmed();
 }
 
+void TabularData::resize(size_t columns, size_t rows)
+{
+    _data.clear();
+    _data.resize(columns * rows);
+    _columns = columns;
+    _rows = rows;
+}
+
+void TabularData::setRow(size_t row, std::vector<QString>::iterator first, std::vector<QString>::iterator last)
+{
+    Q_ASSERT(!_transposed);
+    Q_ASSERT(row < _rows);
+    Q_ASSERT(static_cast<size_t>(std::distance(first, last)) <= _columns);
+
+    auto it = _data.begin() + static_cast<std::ptrdiff_t>(row * _columns);
+    for(; first != last; ++first, ++it)
+        *it = std::move(*first).trimmed();
+}
+
 void TabularData::shrinkToFit()
 {
     auto lastRowIsEmpty = [this]
@@ -23,18 +23,22 @@
 #include "shared/graph/imutablegraph.h"
 #include "shared/loading/iparser.h"
 #include "shared/utils/string.h"
+#include "shared/utils/threadpool.h"
 #include "shared/utils/typeidentity.h"
 
-#include <utf8.h>
-
 #include <QObject>
+#include <QByteArray>
+#include <QFile>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
-#include <iostream>
+#include <numeric>
 #include <string>
+#include <utility>
 #include <vector>
 #include <limits>
 
@@ -70,6 +74,13 @@ public:
     void setTransposed(bool transposed) { _transposed = transposed; }
     void setValueAt(size_t column, size_t row, QString&& value, int progressHint = -1);
 
+    // Discards any existing values, leaving columns * rows empty cells
+    void resize(size_t columns, size_t rows);
+
+    // Sets the values of row, from its first column onwards; unlike setValueAt, the data is
+    // never resized, so distinct rows may be set concurrently, once resize has been called
+    void setRow(size_t row, std::vector<QString>::iterator first, std::vector<QString>::iterator last);
+
     void shrinkToFit();
     void reset();
 
@@ -90,106 +101,301 @@ template<EmptyCellPolicy ECP, const char... Delimiters>
 class TextDelimitedTabularDataParser : public IParser
 {
     static_assert(((Delimiters != '"') && ...), "Delimiter cannot be a quotemark");
+    static_assert(((Delimiters != '\n' && Delimiters != '\r') && ...), "Delimiter cannot be a line ending");
 
 private:
     size_t _rowLimit = 0;
     TabularData _tabularData;
 
-public:
-    explicit TextDelimitedTabularDataParser(IParser* parent = nullptr)
-    {
-        if(parent != nullptr)
-            setProgressFn([parent](int percent) { parent->setProgress(percent); });
-    }
+    // The size of the pieces that the input is split into, for tokenising concurrently
+    static constexpr size_t ChunkSize = 16 * 1024 * 1024;
 
-    bool parse(const QUrl& url, IGraphModel* graphModel = nullptr) override
+    struct Chunk
     {
-        if(graphModel != nullptr)
-            graphModel->mutableGraph().setPhase(QObject::tr("Parsing"));
+        std::vector<QString> _values;
 
-        size_t columnIndex = 0;
-        size_t rowIndex = 0;
+        // The index into _values of each line's first value, plus one past the end
+        std::vector<size_t> _lineOffsets{0};
 
-        std::ifstream file(url.toLocalFile().toStdString());
+        size_t _numColumns = 0;
 
-        if(!file)
-            return false;
+        size_t numLines() const { return _lineOffsets.size() - 1; }
+    };
 
-        auto fileSize = file.tellg();
-        file.seekg(0, std::ios::end);
-        fileSize = file.tellg() - fileSize;
-        file.seekg(0, std::ios::beg);
+    static bool isDelimiter(char c) { return ((Delimiters == c) || ...); }
+    static bool isLineEnding(char c) { return c == '\n' || c == '\r'; }
 
-        if(fileSize == 0)
-        {
-            setFailureReason(QObject::tr("File is empty."));
-            return false;
-        }
+    // Returns the position immediately after the line ending at it
+    static const char* skipLineEnding(const char* it, const char* end)
+    {
+        if(*it == '\r' && (it + 1) < end && *(it + 1) == '\n')
+            return it + 2;
 
-        int progress = 0;
-        std::string line;
+        return it + 1;
+    }
+
+    // Tokenises the lines in [begin, end), or at most maxLines of them, if non-zero, returning
+    // the position tokenising stopped at; note that quotes never span more than one line
+    const char* tokenise(const char* begin, const char* end, Chunk& chunk, size_t maxLines = 0)
+    {
         std::string token;
+        const char* spanBegin = nullptr;
+        const char* spanEnd = nullptr;
 
-        auto setCurrentCellToToken = [&]
+        // The characters of a cell are, for the most part, contiguous in the input, in which
+        // case there is no need to copy them; only when interrupted by quotes are they copied
+        auto appendToToken = [&](const char* first, const char* last)
         {
-            _tabularData.setValueAt(columnIndex, rowIndex,
-                QString::fromStdString(token), progress);
+            if(spanBegin == nullptr && token.empty())
+            {
+                spanBegin = first;
+                spanEnd = last;
+                return;
+            }
+
+            if(spanBegin != nullptr)
+            {
+                token.assign(spanBegin, spanEnd);
+                spanBegin = spanEnd = nullptr;
+            }
+
+            token.append(first, last);
+        };
 
-            token.clear();
-            columnIndex++;
+        auto tokenIsEmpty = [&] { return spanBegin == nullptr && token.empty(); };
+
+        auto setCurrentCellToToken = [&]
+        {
+            if(spanBegin != nullptr)
+            {
+                chunk._values.emplace_back(QString::fromUtf8(spanBegin, spanEnd - spanBegin));
+                spanBegin = spanEnd = nullptr;
+            }
+            else
+            {
+                chunk._values.emplace_back(QString::fromUtf8(token.data(),
+                    static_cast<qsizetype>(token.size())));
+                token.clear();
+            }
         };
 
-        file.seekg(0, std::ios::beg);
-        while(!u::getline(file, line).eof())
+        auto it = begin;
+        while(it < end && (maxLines == 0 || chunk.numLines() < maxLines))
         {
             bool inQuotes = false;
             bool delimiter = false;
+            size_t columnIndex = 0;
 
-            std::string validatedLine;
-            utf8::replace_invalid(line.begin(), line.end(), std::back_inserter(validatedLine));
-            auto it = validatedLine.begin();
-            auto end = validatedLine.end();
-            while(it < end)
+            while(it < end && !isLineEnding(*it))
             {
-                uint32_t codePoint = utf8::next(it, end);
+                auto c = *it;
 
-                if(codePoint == '"')
+                if(c == '"')
                 {
                     if(inQuotes)
+                    {
                         setCurrentCellToToken();
+                        columnIndex++;
+                    }
 
                     inQuotes = !inQuotes;
                     delimiter = false;
+                    ++it;
                 }
-                else
+                else if(!inQuotes && isDelimiter(c))
                 {
                     auto previousTokenWasDelimiter = delimiter || columnIndex == 0;
-                    delimiter = ((Delimiters == codePoint) || ...);
+                    delimiter = true;
 
-                    if(!delimiter || inQuotes)
-                        utf8::unchecked::append(codePoint, std::back_inserter(token));
-                    else if(!token.empty() || (previousTokenWasDelimiter && ECP == EmptyCellPolicy::Keep))
+                    if(!tokenIsEmpty() || (previousTokenWasDelimiter && ECP == EmptyCellPolicy::Keep))
+                    {
                         setCurrentCellToToken();
+                        columnIndex++;
+                    }
+
+                    ++it;
+                }
+                else
+                {
+                    // Consume the whole run of characters that form part of the token
+                    auto runEnd = it + 1;
+                    while(runEnd < end && *runEnd != '"' && !isLineEnding(*runEnd) &&
+                        (inQuotes || !isDelimiter(*runEnd)))
+                    {
+                        ++runEnd;
+                    }
+
+                    delimiter = isDelimiter(*(runEnd - 1));
+                    appendToToken(it, runEnd);
+                    it = runEnd;
                 }
             }
 
-            if(!token.empty())
+            if(!tokenIsEmpty())
+            {
                 setCurrentCellToToken();
+                columnIndex++;
+            }
 
-            progress = file.eof() ? 100 :
-                static_cast<int>(file.tellg() * 100 / fileSize);
-            setProgress(progress);
+            if(it < end)
+                it = skipLineEnding(it, end);
 
-            rowIndex++;
-            columnIndex = 0;
+            chunk._numColumns = std::max(chunk._numColumns, columnIndex);
+            chunk._lineOffsets.push_back(chunk._values.size());
 
-            if(_rowLimit > 0 && rowIndex > _rowLimit)
+            if(cancelled())
                 break;
+        }
 
-            if(cancelled())
-                return false;
+        return it;
+    }
+
+    // Splits [begin, end) into pieces of roughly ChunkSize, at line boundaries
+    static std::vector<std::pair<const char*, const char*>> chunkBoundaries(const char* begin, const char* end)
+    {
+        std::vector<std::pair<const char*, const char*>> chunks;
+
+        auto chunkBegin = begin;
+        while(chunkBegin < end)
+        {
+            auto chunkEnd = chunkBegin + std::min(ChunkSize, static_cast<size_t>(end - chunkBegin));
+            chunkEnd = std::find_if(chunkEnd, end, &isLineEnding);
+
+            if(chunkEnd < end)
+                chunkEnd = skipLineEnding(chunkEnd, end);
+
+            chunks.emplace_back(chunkBegin, chunkEnd);
+            chunkBegin = chunkEnd;
         }
 
+        return chunks;
+    }
+
+    // Moves the values of each chunk into _tabularData, in order
+    void stitch(std::vector<Chunk>& chunks)
+    {
+        std::vector<size_t> firstRows;
+        firstRows.reserve(chunks.size());
+
+        size_t numColumns = 0;
+        size_t numRows = 0;
+        size_t row = 0;
+
+        for(const auto& chunk : chunks)
+        {
+            firstRows.push_back(row);
+            numColumns = std::max(numColumns, chunk._numColumns);
+
+            // Trailing lines that have no values don't add rows
+            for(size_t line = chunk.numLines(); line > 0; line--)
+            {
+                if(chunk._lineOffsets.at(line - 1) != chunk._lineOffsets.at(line))
+                {
+                    numRows = row + line;
+                    break;
+                }
+            }
+
+            row += chunk.numLines();
+        }
+
+        _tabularData.resize(numColumns, numRows);
+
+        std::vector<size_t> chunkIndices(chunks.size());
+        std::iota(chunkIndices.begin(), chunkIndices.end(), 0);
+
+        parallel_for(chunkIndices.begin(), chunkIndices.end(), [&](size_t chunkIndex)
+        {
+            auto& chunk = chunks.at(chunkIndex);
+            auto firstValue = chunk._values.begin();
+
+            for(size_t line = 0; line < chunk.numLines(); line++)
+            {
+                auto first = firstValue + static_cast<std::ptrdiff_t>(chunk._lineOffsets.at(line));
+                auto last = firstValue + static_cast<std::ptrdiff_t>(chunk._lineOffsets.at(line + 1));
+
+                if(first != last)
+                    _tabularData.setRow(firstRows.at(chunkIndex) + line, first, last);
+            }
+
+            chunk = {};
+        });
+    }
+
+public:
+    explicit TextDelimitedTabularDataParser(IParser* parent = nullptr)
+    {
+        if(parent != nullptr)
+            setProgressFn([parent](int percent) { parent->setProgress(percent); });
+    }
+
+    bool parse(const QUrl& url, IGraphModel* graphModel = nullptr) override
+    {
+        if(graphModel != nullptr)
+            graphModel->mutableGraph().setPhase(QObject::tr("Parsing"));
+
+        QFile file(url.toLocalFile());
+
+        if(!file.open(QIODevice::ReadOnly))
+            return false;
+
+        auto fileSize = file.size();
+
+        if(fileSize == 0)
+        {
+            setFailureReason(QObject::tr("File is empty."));
+            return false;
+        }
+
+        // Map the file, to avoid copying it; failing that, read it in its entirety
+        QByteArray fileContents;
+        const auto* begin = reinterpret_cast<const char*>(file.map(0, fileSize));
+
+        if(begin == nullptr)
+        {
+            fileContents = file.readAll();
+            begin = fileContents.constData();
+            fileSize = fileContents.size();
+        }
+
+        const auto* end = begin + fileSize;
+        std::vector<Chunk> chunks;
+
+        if(_rowLimit > 0)
+        {
+            // Only the first few lines are required, so there is nothing to gain by parallelising
+            tokenise(begin, end, chunks.emplace_back(), _rowLimit + 1);
+        }
+        else
+        {
+            auto boundaries = chunkBoundaries(begin, end);
+            std::atomic<uint64_t> bytesTokenised(0);
+
+            setProgress(0);
+
+            auto results = parallel_for(boundaries.begin(), boundaries.end(),
+            [&](const std::pair<const char*, const char*>& boundary)
+            {
+                Chunk chunk;
+                tokenise(boundary.first, boundary.second, chunk);
+
+                bytesTokenised += static_cast<uint64_t>(boundary.second - boundary.first);
+                setProgress(static_cast<int>((bytesTokenised * 100) / static_cast<uint64_t>(fileSize)));
+
+                return chunk;
+            });
+
+            chunks.reserve(boundaries.size());
+            for(auto& chunk : results)
+                chunks.emplace_back(std::move(chunk));
+        }
+
+        if(cancelled())
+            return false;
+
+        setProgress(-1);
+        stitch(chunks);
+
         // Free up any over-allocation
         _tabularData.shrinkToFit();
 
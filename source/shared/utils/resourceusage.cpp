@@ -0,0 +1,149 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resourceusage.h"
+
+#if defined(__APPLE__)
+
+#include <mach/mach.h>
+#include <sys/resource.h>
+
+uint64_t u::currentMemoryUsage()
+{
+    mach_task_basic_info info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+    if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+        reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) // NOLINT
+    {
+        return 0;
+    }
+
+    return info.resident_size;
+}
+
+uint64_t u::peakMemoryUsage()
+{
+    rusage usage{};
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+    // macOS reports ru_maxrss in bytes
+    return static_cast<uint64_t>(usage.ru_maxrss);
+}
+
+#elif defined(__linux__)
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+uint64_t u::currentMemoryUsage()
+{
+    auto* file = std::fopen("/proc/self/statm", "r");
+    if(file == nullptr)
+        return 0;
+
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    auto numRead = std::fscanf(file, "%lu %lu", &size, &resident); // NOLINT
+    std::fclose(file);
+
+    if(numRead != 2)
+        return 0;
+
+    return static_cast<uint64_t>(resident) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+uint64_t u::peakMemoryUsage()
+{
+    rusage usage{};
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+    // Linux reports ru_maxrss in kilobytes
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024u;
+}
+
+#elif defined(_WIN32)
+
+#include <windows.h>
+#include <Psapi.h>
+
+uint64_t u::currentMemoryUsage()
+{
+    PROCESS_MEMORY_COUNTERS counters{};
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+
+    return counters.WorkingSetSize;
+}
+
+uint64_t u::peakMemoryUsage()
+{
+    PROCESS_MEMORY_COUNTERS counters{};
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+
+    return counters.PeakWorkingSetSize;
+}
+
+int64_t u::processCpuTime()
+{
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if(!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+        return 0;
+
+    auto toInt64 = [](const FILETIME& fileTime)
+    {
+        return (static_cast<int64_t>(fileTime.dwHighDateTime) << 32) |
+            static_cast<int64_t>(fileTime.dwLowDateTime);
+    };
+
+    // FILETIMEs are in units of 100ns
+    return (toInt64(kernelTime) + toInt64(userTime)) * 100;
+}
+
+#else
+
+uint64_t u::currentMemoryUsage() { return 0; }
+uint64_t u::peakMemoryUsage() { return 0; }
+
+#endif
+
+#if !defined(_WIN32)
+
+#include <sys/resource.h>
+
+int64_t u::processCpuTime()
+{
+    rusage usage{};
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+    auto toNs = [](const timeval& time)
+    {
+        return (static_cast<int64_t>(time.tv_sec) * 1000000000) +
+            (static_cast<int64_t>(time.tv_usec) * 1000);
+    };
+
+    return toNs(usage.ru_utime) + toNs(usage.ru_stime);
+}
+
+#endif
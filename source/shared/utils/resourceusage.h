@@ -0,0 +1,36 @@
+/* Copyright © 2013-2022 Graphia Technologies Ltd.
+ *
+ * This file is part of Graphia.
+ *
+ * Graphia is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Graphia is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Graphia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESOURCEUSAGE_H
+#define RESOURCEUSAGE_H
+
+#include <cstdint>
+
+namespace u
+{
+// Resident memory currently in use by the process, in bytes
+uint64_t currentMemoryUsage();
+
+// The high water mark of resident memory used by the process, in bytes
+uint64_t peakMemoryUsage();
+
+// Total CPU time consumed by all threads of the process, in nanoseconds
+int64_t processCpuTime();
+} // namespace u
+
+#endif // RESOURCEUSAGE_H
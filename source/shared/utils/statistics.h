@@ -116,14 +116,12 @@ Statistics findStatisticsFor(const C& container, bool storeValues = false)
     return findStatisticsFor(container, [](typename C::const_reference& t) { return t; }, storeValues);
 }
 
-template<typename C>
-double medianOf(const C& container)
+// Finds the median by selection, reordering the values in the process
+inline double medianOfInPlace(std::vector<double>& v)
 {
-    if(container.empty())
+    if(v.empty())
         return 0.0;
 
-    std::vector<double> v{container.begin(), container.end()};
-
     auto mid = v.size() / 2;
     std::nth_element(v.begin(), v.begin() +
         static_cast<std::vector<double>::difference_type>(mid), v.end());
@@ -139,5 +137,12 @@ double medianOf(const C& container)
     return median;
 }
 
+template<typename C>
+double medianOf(const C& container)
+{
+    std::vector<double> v{container.begin(), container.end()};
+    return medianOfInPlace(v);
+}
+
 } // namespace u
 #endif // STATISTICS_H
@@ -476,7 +476,7 @@ public:
 
         Coster<It> coster(first, last);
 
-        const auto totalCost = coster.total(); Q_ASSERT(totalCost > 0);
+        const auto totalCost = coster.total(); Q_ASSERT(totalCost > 0 || first == last);
         const auto numThreads = static_cast<int>(_threads.size());
         const auto costPerThread = totalCost / numThreads +
                 ((totalCost % numThreads) ? 1 : 0);